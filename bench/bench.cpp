@@ -0,0 +1,310 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "ins_65xx.h"
+#include "machine.h"
+
+constexpr Word BENCH_ORIGIN             = 0x8000;
+constexpr uint32_t BENCH_UNROLL         = 64;         // Copies of the instruction per loop iteration
+constexpr uint64_t BENCH_DEFAULT_CYCLES = 0x400000;   // Emulated cycles per benchmark
+constexpr uint32_t BENCH_MAX_STEPS      = 10000;      // Calibration gives up after this many instructions
+
+// Operands used by the opcode benchmarks: zero page $10 and absolute $0300
+// both hold a pointer to $0400, so every mode touches ordinary RAM
+constexpr Byte BENCH_ZP   = 0x10;
+constexpr Word BENCH_AB   = 0x0300;
+constexpr Word BENCH_DATA = 0x0400;
+
+static bool FastEngine = false;
+static int Variant      = CPU_NMOS;
+static bool BusExact    = false;
+
+struct Result {
+ std::string Name;
+ uint64_t Cycles;
+ uint64_t Instructions;
+ double Seconds;
+};
+
+static void Put(Memory& mem, Word Address, std::initializer_list<Byte> Bytes) {
+ for (Byte Value : Bytes) mem[Address++] = Value;
+}
+
+static Word SetupOpcode(Memory& mem, Byte Opcode) {
+ const InstructionInfo& Info = GetInstruction(Opcode, Variant);
+ Byte Length                 = InstructionLength(Info.Mode);
+
+ mem[BENCH_ZP]     = BENCH_DATA & 0xFF;
+ mem[BENCH_ZP + 1] = BENCH_DATA >> 8;
+ mem[BENCH_AB]     = BENCH_DATA & 0xFF;
+ mem[BENCH_AB + 1] = BENCH_DATA >> 8;
+
+ // Control flow that cannot be unrolled loops on itself. X is 0, so
+ // JMP (abs,X) goes through the same pointer as JMP (abs)
+ if (Info.Mode == MODE_INAX) {
+  mem[BENCH_AB]     = BENCH_ORIGIN & 0xFF;
+  mem[BENCH_AB + 1] = BENCH_ORIGIN >> 8;
+  Put(mem, BENCH_ORIGIN, {Opcode, BENCH_AB & 0xFF, BENCH_AB >> 8});
+  return BENCH_ORIGIN;
+ }
+ switch (Opcode) {
+ case INS_JMP_AB:
+  Put(mem, BENCH_ORIGIN, {INS_JMP_AB, BENCH_ORIGIN & 0xFF, BENCH_ORIGIN >> 8});
+  return BENCH_ORIGIN;
+ case INS_JMP_IN:
+  mem[BENCH_AB]     = BENCH_ORIGIN & 0xFF;
+  mem[BENCH_AB + 1] = BENCH_ORIGIN >> 8;
+  Put(mem, BENCH_ORIGIN, {INS_JMP_IN, BENCH_AB & 0xFF, BENCH_AB >> 8});
+  return BENCH_ORIGIN;
+ case INS_BRK_IMPL:
+  mem[IRQ_VECTOR]     = BENCH_ORIGIN & 0xFF;
+  mem[IRQ_VECTOR + 1] = BENCH_ORIGIN >> 8;
+  mem[BENCH_ORIGIN]   = INS_BRK_IMPL;
+  return BENCH_ORIGIN;
+ // A stack page full of $80 returns to $8081 (RTS) or $8080 (RTI) forever
+ case INS_RTS_IMPL:
+  memset(&mem.Data[0x100], 0x80, PAGE_SIZE);
+  mem[0x8081] = INS_RTS_IMPL;
+  return 0x8081;
+ case INS_RTI_IMPL:
+  memset(&mem.Data[0x100], 0x80, PAGE_SIZE);
+  mem[0x8080] = INS_RTI_IMPL;
+  return 0x8080;
+ }
+
+ Word Address = BENCH_ORIGIN;
+ for (uint32_t i = 0; i < BENCH_UNROLL; i++) {
+  Word Operand;
+  switch (Info.Mode) {
+  case MODE_IM:
+   Operand = 0x01;
+   break;
+  case MODE_REL:
+   Operand = 0x00;  // Taken or not, the next instruction is the next copy
+   break;
+  case MODE_AB:
+  case MODE_ABX:
+  case MODE_ABY:
+   Operand = Opcode == INS_JSR_AB ? Address + 3 : BENCH_AB;
+   break;
+  default:
+   Operand = BENCH_ZP;
+  }
+
+  mem[Address] = Opcode;
+  if (Length > 1) mem[(Word)(Address + 1)] = Operand & 0xFF;
+  if (Length > 2) mem[(Word)(Address + 2)] = Operand >> 8;
+  Address += Length;
+ }
+ Put(mem, Address, {INS_JMP_AB, BENCH_ORIGIN & 0xFF, BENCH_ORIGIN >> 8});
+ return BENCH_ORIGIN;
+}
+
+// Marks multiples of every number below 256 in a table at $0300
+static Word SetupSieve(Memory& mem) {
+ Put(mem, 0x8000, {
+  0xA2, 0x00,        // 8000 LDX #$00
+  0xA9, 0x01,        // 8002 LDA #$01
+  0x9D, 0x00, 0x03,  // 8004 STA $0300,X
+  0xE8,              // 8007 INX
+  0xD0, 0xFA,        // 8008 BNE $8004
+  0xA2, 0x02,        // 800A LDX #$02
+  0xBD, 0x00, 0x03,  // 800C LDA $0300,X
+  0xF0, 0x12,        // 800F BEQ $8023
+  0x86, 0x10,        // 8011 STX $10
+  0x8A,              // 8013 TXA
+  0x18,              // 8014 CLC
+  0x65, 0x10,        // 8015 ADC $10
+  0xB0, 0x0A,        // 8017 BCS $8023
+  0xA8,              // 8019 TAY
+  0xA9, 0x00,        // 801A LDA #$00
+  0x99, 0x00, 0x03,  // 801C STA $0300,Y
+  0x98,              // 801F TYA
+  0x4C, 0x14, 0x80,  // 8020 JMP $8014
+  0xE8,              // 8023 INX
+  0xD0, 0xE6,        // 8024 BNE $800C
+  0x4C, 0x00, 0x80,  // 8026 JMP $8000
+ });
+ return 0x8000;
+}
+
+// Copies a page through (zp),Y pointers in a subroutine
+static Word SetupMemcpy(Memory& mem) {
+ Put(mem, 0x8000, {
+  0xA9, 0x00, 0x85, 0x10,  // 8000 LDA #$00, STA $10
+  0xA9, 0x40, 0x85, 0x11,  // 8004 LDA #$40, STA $11
+  0xA9, 0x00, 0x85, 0x12,  // 8008 LDA #$00, STA $12
+  0xA9, 0x50, 0x85, 0x13,  // 800C LDA #$50, STA $13
+  0x20, 0x16, 0x80,        // 8010 JSR $8016
+  0x4C, 0x00, 0x80,        // 8013 JMP $8000
+  0xA0, 0x00,              // 8016 LDY #$00
+  0xB1, 0x10,              // 8018 LDA ($10),Y
+  0x91, 0x12,              // 801A STA ($12),Y
+  0xC8,                    // 801C INY
+  0xD0, 0xF9,              // 801D BNE $8018
+  0x60,                    // 801F RTS
+ });
+ return 0x8000;
+}
+
+static std::unique_ptr<Machine> NewMachine() {
+ std::unique_ptr<Machine> M(new Machine());
+ M->Fast         = FastEngine;
+ M->Cpu.Variant  = Variant;
+ M->Cpu.BusExact = BusExact;
+ M->Reset();
+ memset(M->Mem.Data, 0, MAX_MEM);
+ return M;
+}
+
+// Steps one loop iteration to learn how many instructions a cycle is worth
+static double InstructionsPerCycle(Machine& M, Word Start) {
+ uint64_t Cycles = 0, Steps = 0;
+ M.Cpu.PC        = Start;
+ do {
+  Cycles += M.Cpu.Execute(1, M.Mem);
+  Steps++;
+ } while (M.Cpu.PC != Start && Steps < BENCH_MAX_STEPS);
+ return Cycles ? (double)Steps / Cycles : 0;
+}
+
+static Result Measure(const std::string& Name, Machine& M, Word Start, uint64_t Budget) {
+ double Ratio = InstructionsPerCycle(M, Start);
+
+ auto Begin      = std::chrono::steady_clock::now();
+ uint64_t Cycles = M.Run(Budget);
+ auto End        = std::chrono::steady_clock::now();
+
+ return {Name, Cycles, (uint64_t)(Cycles * Ratio), std::chrono::duration<double>(End - Begin).count()};
+}
+
+// Cost of entering and leaving the run loop: one NOP per Run() call
+static Result MeasureSlices(uint64_t Budget) {
+ std::unique_ptr<Machine> M = NewMachine();
+ Word Start                 = SetupOpcode(M->Mem, INS_NOP_IMPL);
+ M->Cpu.PC                  = Start;
+
+ uint64_t Calls = Budget / 16, Cycles = 0;
+ auto Begin     = std::chrono::steady_clock::now();
+ for (uint64_t i = 0; i < Calls; i++) Cycles += M->Run(1);
+ auto End = std::chrono::steady_clock::now();
+
+ return {"dispatch/slice", Cycles, Calls, std::chrono::duration<double>(End - Begin).count()};
+}
+
+static void Print(const Result& Entry) {
+ printf("%-20s %12llu %12llu %10.2f %9.2f %8.2f\n", Entry.Name.c_str(), (unsigned long long)Entry.Cycles, (unsigned long long)Entry.Instructions, Entry.Seconds * 1000, Entry.Cycles / Entry.Seconds / 1e6, Entry.Seconds * 1e9 / Entry.Instructions);
+}
+
+static bool WriteJSON(const std::string& Path, const std::vector<Result>& Results) {
+ FILE* File = fopen(Path.c_str(), "w");
+ if (!File) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ fprintf(File, "{\n \"benchmarks\": [");
+ const char* Separator = "\n";
+ for (const Result& Entry : Results) {
+  fprintf(File, "%s  {\"name\": \"%s\", \"cycles\": %llu, \"instructions\": %llu, \"seconds\": %.6f, \"mhz\": %.3f, \"ns_per_instruction\": %.3f}", Separator, Entry.Name.c_str(), (unsigned long long)Entry.Cycles, (unsigned long long)Entry.Instructions, Entry.Seconds, Entry.Cycles / Entry.Seconds / 1e6, Entry.Seconds * 1e9 / Entry.Instructions);
+  Separator = ",\n";
+ }
+ fprintf(File, "\n ]\n}\n");
+ fclose(File);
+ return true;
+}
+
+int main(int argc, char** argv) {
+ uint64_t Budget = BENCH_DEFAULT_CYCLES;
+ std::string JsonPath, Filter;
+ std::vector<std::string> Roms;
+
+ for (int i = 1; i < argc; i++) {
+  std::string Argument = argv[i];
+  if (Argument == "-j" && i + 1 < argc)
+   JsonPath = argv[++i];
+  else if (Argument == "-c" && i + 1 < argc)
+   Budget = std::stoull(argv[++i], nullptr, 16);
+  else if (Argument == "-f" && i + 1 < argc)
+   Filter = argv[++i];
+  else if (Argument == "-E" && i + 1 < argc)
+   FastEngine = std::string(argv[++i]) == "fast";
+  else if (Argument == "-A" && i + 1 < argc)
+   BusExact = std::string(argv[++i]) == "bus";
+  else if (Argument == "-C" && i + 1 < argc) {
+   if ((Variant = ParseCPUVariant(argv[++i])) < 0) {
+    printf("Unknown CPU: %s\n", argv[i]);
+    return 1;
+   }
+  } else if (Argument[0] == '-') {
+   printf("Usage: bench [-c <cycles>] [-f <name filter>] [-E <reference|fast>] [-C <cpu>] [-A <instruction|bus>] [-j <json>] [<rom>[@<pc>] ...]\n");
+   return 1;
+  } else
+   Roms.push_back(Argument);
+ }
+
+ std::vector<Result> Results;
+ auto Run = [&](const std::string& Name, Word (*Setup)(Memory&, Byte), Byte Opcode) {
+  if (!Filter.empty() && Name.find(Filter) == std::string::npos) return;
+  std::unique_ptr<Machine> M = NewMachine();
+  Word Start                 = Setup(M->Mem, Opcode);
+  Results.push_back(Measure(Name, *M, Start, Budget));
+  Print(Results.back());
+ };
+
+ printf("%-20s %12s %12s %10s %9s %8s\n", "Benchmark", "Cycles", "Instructions", "ms", "MHz", "ns/ins");
+
+ if (Filter.empty() || std::string("dispatch/slice").find(Filter) != std::string::npos) {
+  Results.push_back(MeasureSlices(Budget));
+  Print(Results.back());
+ }
+ Run("dispatch/nop", SetupOpcode, INS_NOP_IMPL);
+
+ // Every opcode of the variant. WAI and STP would stop the clock, and the
+ // spare NOPs share a name, so those get their opcode appended
+ std::set<std::string> Names;
+ for (int Opcode = 0; Opcode < 256; Opcode++) {
+  const InstructionInfo& Info = GetInstruction(Opcode, Variant);
+  if (Info.Mode == MODE_NONE) continue;
+  if (ChipModel(Variant) == CPU_W65C02 && (Opcode == INS_WAI_IMPL || Opcode == INS_STP_IMPL)) continue;
+  std::string Name = std::string(Info.Mnemonic) + "/" + ModeName(Info.Mode);
+  if (!Names.insert(Name).second) {
+   char Suffix[8];
+   snprintf(Suffix, sizeof(Suffix), "/%02x", Opcode);
+   Name += Suffix;
+  }
+  Run(Name, SetupOpcode, Opcode);
+ }
+
+ Run("program/sieve", [](Memory& mem, Byte) { return SetupSieve(mem); }, 0);
+ Run("program/memcpy", [](Memory& mem, Byte) { return SetupMemcpy(mem); }, 0);
+
+ // Full 64K images like the emulator loads, started at @pc or the reset vector.
+ // Instructions are estimated from the first BENCH_MAX_STEPS of the program
+ for (const std::string& Spec : Roms) {
+  size_t At        = Spec.find('@');
+  std::string Path = Spec.substr(0, At);
+  std::ifstream Binary(Path, std::ios::binary);
+  if (!Binary.is_open()) {
+   perror(Path.c_str());
+   return 1;
+  }
+
+  std::unique_ptr<Machine> M = NewMachine();
+  M->Mem.ReadProgram(Binary, 0x0, 0xFFFF);
+  Word Start = At == std::string::npos ? M->Mem[RESET_VECTOR] | (M->Mem[RESET_VECTOR + 1] << 8) : std::stoi(Spec.substr(At + 1), nullptr, 16);
+
+  std::string Name = "rom/" + Path.substr(Path.find_last_of('/') + 1);
+  Results.push_back(Measure(Name, *M, Start, Budget));
+  Print(Results.back());
+ }
+
+ if (!JsonPath.empty() && !WriteJSON(JsonPath, Results)) return 1;
+}
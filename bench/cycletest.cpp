@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "common.h"
+#include "disasm.h"
+#include "machine.h"
+
+// Checks that the bus exact tables charge what the datasheets give: every
+// opcode of every variant is run once on its own, with and without a page
+// cross, with the flags all clear and all set and in both decimal modes, and
+// the cycles it took are compared with the instruction metadata and its
+// penalties. WAI and STP run until something stops them and are left out
+
+constexpr Word CYCLETEST_PC = 0x0280;
+
+// The indexed modes that pay for a page cross only when they read
+static bool AlwaysFixesAddress(const std::string& Mnemonic) {
+ static const char* const Names[] = {"STA", "STX", "STY", "STZ", "SAX", "ASL", "LSR", "ROL", "ROR", "INC", "DEC", "SLO", "RLA", "SRE", "RRA", "DCP", "ISC", "TSB", "TRB"};
+ for (const char* Name : Names)
+  if (Mnemonic == Name) return true;
+ return false;
+}
+
+// Operand $10 or $F0 ($30xx when absolute), X and Y $20 for the page cross
+// and the pointers at $10 and $F0 pointing into page $30. Branch offsets go
+// forwards within the page or back across it
+static int Expected(const InstructionInfo& Info, int Variant, bool Cross, bool Decimal, Word PC) {
+ std::string Mnemonic = Info.Mnemonic;
+ Word Next            = CYCLETEST_PC + InstructionLength(Info.Mode);
+ int Cycles           = Info.Cycles;
+ if (Info.Mode == MODE_REL || Info.Mode == MODE_ZPR) {
+  bool Taken = PC != Next;
+  if (Taken && Mnemonic != "BRA") Cycles++;
+  if (Taken && ((PC ^ Next) & 0xFF00)) Cycles++;
+ }
+ if (Cross && (Info.Mode == MODE_ABX || Info.Mode == MODE_ABY || Info.Mode == MODE_INY) && !AlwaysFixesAddress(Mnemonic)) Cycles++;
+ if (IsCMOS(Variant) && Decimal && (Mnemonic == "ADC" || Mnemonic == "SBC")) Cycles++;
+ return Cycles;
+}
+
+int main() {
+ int Failures = 0, Runs = 0;
+ std::unique_ptr<Machine> M(new Machine());
+ for (int Variant = 0; Variant < CPU_VARIANTS; Variant++)
+  for (int Opcode = 0; Opcode < 0x100; Opcode++) {
+   const InstructionInfo& Info = GetInstruction(Opcode, Variant);
+   std::string Mnemonic        = Info.Mnemonic;
+   if (Info.Mode == MODE_NONE || Mnemonic == "WAI" || Mnemonic == "STP") continue;
+   for (int Run = 0; Run < 8; Run++) {
+    bool Cross = Run & 1, Flags = Run & 2, Decimal = Run & 4;
+    M->Reset();
+    memset(M->Mem.Data, 0, MAX_MEM);
+    Byte* Data             = M->Mem.Data;
+    Data[CYCLETEST_PC]     = Opcode;
+    Data[CYCLETEST_PC + 1] = Cross ? 0xF0 : 0x10;
+    Data[CYCLETEST_PC + 2] = 0x30;
+    if (Info.Mode == MODE_REL) Data[CYCLETEST_PC + 1] = Cross ? 0x80 : 0x04;
+    if (Info.Mode == MODE_ZPR) Data[CYCLETEST_PC + 2] = Cross ? 0x80 : 0x04;
+    Data[0x10]      = Cross ? 0xF0 : 0x10;
+    Data[0x11]      = 0x30;
+    Data[0xF0]      = 0xF0;
+    Data[0xF1]      = 0x30;
+    Byte P          = (Flags ? 0xF7 : 0x00) | (Decimal ? CPU_65XX_PS::DecimalBit : 0);
+    M->Cpu.Variant  = Variant;
+    M->Cpu.BusExact = true;
+    M->Cpu.PC       = CYCLETEST_PC;
+    M->Cpu.SP       = 0xF0;
+    M->Cpu.A        = 0x11;
+    M->Cpu.X        = Cross ? 0x20 : 0x00;
+    M->Cpu.Y        = M->Cpu.X;
+    M->Cpu.PS       = P;
+
+    uint64_t Start = M->Cpu.TotalCycles;
+    M->Cpu.ExecuteFast(1, M->Mem);
+    int Cycles = M->Cpu.TotalCycles - Start;
+    int Wanted = Expected(Info, Variant, Cross, Decimal, M->Cpu.PC);
+    Runs++;
+    if (Cycles != Wanted) {
+     printf("%s %02x %s %s: %d cycles, %d expected (cross %d, P %02x)\n", CPUVariantName(Variant), Opcode, Info.Mnemonic, ModeName(Info.Mode), Cycles, Wanted, Cross, P);
+     Failures++;
+    }
+   }
+  }
+
+ printf("cycletest: %s, %d runs, %d off the datasheet\n", Failures ? "FAIL" : "PASS", Runs, Failures);
+ return Failures ? 1 : 0;
+}
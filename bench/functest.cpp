@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "common.h"
+#include "disasm.h"
+#include "machine.h"
+
+constexpr uint64_t FUNCTEST_SLICE_CYCLES = 1000;
+constexpr uint64_t FUNCTEST_MAX_CYCLES   = 0x40000000;  // The decimal tests take ~60M cycles
+
+// The tests end in a loop on themselves: JMP * or a branch to itself
+static bool IsTrap(const Memory& mem, Word PC, int Variant) {
+ Byte Bytes[3]   = {mem[PC], mem[(Word)(PC + 1)], mem[(Word)(PC + 2)]};
+ Instruction Ins = Decode(PC, Bytes, Variant);
+ return (Ins.Mode == MODE_REL || (Ins.Opcode == INS_JMP_AB)) && Ins.Value == PC;
+}
+
+int main(int argc, char** argv) {
+ if (argc < 2) {
+  printf("Usage: functest <image> [-p <start>] [-x <success trap>] [-e <error byte>] [-c <max cycles>] [-E <reference|fast>] [-C <cpu>] [-A <instruction|bus>]\n");
+  return 2;
+ }
+
+ Word Start = 0x0400;
+ int32_t Success = -1, ErrorByte = -1;
+ uint64_t MaxCycles = FUNCTEST_MAX_CYCLES;
+ int Variant        = CPU_NMOS;
+ bool FastEngine    = false;
+ bool BusExact      = false;
+ for (int i = 2; i + 1 < argc; i += 2) {
+  std::string Argument = argv[i], Value = argv[i + 1];
+  switch (Argument[1]) {
+  case 'p':
+   Start = std::stoi(Value, nullptr, 16);
+   break;
+  case 'x':
+   Success = std::stoi(Value, nullptr, 16);
+   break;
+  case 'e':
+   ErrorByte = std::stoi(Value, nullptr, 16);
+   break;
+  case 'c':
+   MaxCycles = std::stoull(Value, nullptr, 16);
+   break;
+  case 'E':
+   FastEngine = Value == "fast";
+   break;
+  case 'C':
+   if ((Variant = ParseCPUVariant(Value)) < 0) {
+    printf("Unknown CPU: %s\n", Value.c_str());
+    return 2;
+   }
+   break;
+  case 'A':
+   BusExact = Value == "bus";
+   break;
+  }
+ }
+
+ std::ifstream Binary(argv[1], std::ios::binary);
+ if (!Binary.is_open()) {
+  perror(argv[1]);
+  return 2;
+ }
+
+ std::unique_ptr<Machine> M(new Machine());
+ M->Reset();
+ memset(M->Mem.Data, 0, MAX_MEM);
+ M->Mem.ReadProgram(Binary, 0x0, 0xFFFF);
+ M->Fast         = FastEngine;
+ M->Cpu.PC       = Start;
+ M->Cpu.Variant  = Variant;
+ M->Cpu.BusExact = BusExact;
+
+ // A branch to itself might just not be taken yet, so a trap has to hold
+ // across two slices before the run counts as finished
+ bool Trapped   = false;
+ Word LastPC    = Start;
+ auto Begin     = std::chrono::steady_clock::now();
+ while (M->Cpu.TotalCycles < MaxCycles) {
+  M->Run(FUNCTEST_SLICE_CYCLES);
+  if (M->Cpu.StopReason != STOP_NONE) break;
+  if (M->Cpu.PC == LastPC && IsTrap(M->Mem, M->Cpu.PC, Variant)) {
+   Trapped = true;
+   break;
+  }
+  LastPC = M->Cpu.PC;
+ }
+ auto End       = std::chrono::steady_clock::now();
+ double Seconds = std::chrono::duration<double>(End - Begin).count();
+
+ bool Passed = Trapped;
+ if (Success >= 0) Passed = Passed && M->Cpu.PC == Success;
+ if (ErrorByte >= 0) Passed = Passed && M->Mem[ErrorByte] == 0;
+
+ char Text[48];
+ Byte Bytes[3] = {M->Mem[M->Cpu.PC], M->Mem[(Word)(M->Cpu.PC + 1)], M->Mem[(Word)(M->Cpu.PC + 2)]};
+ FormatInstruction(Decode(M->Cpu.PC, Bytes, Variant), Text, sizeof(Text));
+
+ if (M->Cpu.StopReason == STOP_ILLEGAL)
+  printf("%s: FAIL (illegal opcode %02x)\n", argv[1], M->Cpu.StopOpcode);
+ else
+  printf("%s: %s\n", argv[1], Passed ? "PASS" : Trapped ? "FAIL" : "FAIL (no trap, cycle limit reached)");
+ printf("PC %04x  %s  A:%02x X:%02x Y:%02x SP:%02x P:%02x\n", M->Cpu.PC, Text, M->Cpu.A, M->Cpu.X, M->Cpu.Y, M->Cpu.SP, M->Cpu.PS.GetPS());
+ if (ErrorByte >= 0) printf("Error byte %04x = %02x\n", ErrorByte, M->Mem[ErrorByte]);
+ // The instruction tests of bench/mkroms keep the number of the running test at $0200
+ if (!Passed && Start == 0x0400) printf("Test case %02x\n", M->Mem[0x0200]);
+ printf("Cycles: %llu, %.3f s, %.2f MHz\n", (unsigned long long)M->Cpu.TotalCycles, Seconds, M->Cpu.TotalCycles / Seconds / 1e6);
+
+ return Passed ? 0 : 1;
+}
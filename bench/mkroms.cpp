@@ -0,0 +1,1232 @@
+// Builds the images make selftest runs with bench/functest, so the self
+// test needs nothing from outside the tree. These are this tree's own tests,
+// not Klaus Dormann's suite and no claim of conformance to it: the models
+// below are written from the datasheets without the core's code, but by the
+// same hands, so a misreading can end up on both sides. Dormann's binaries
+// run with bench/functest as they are. The images:
+//
+//   instructions.bin   every documented NMOS instruction in every addressing
+//                      mode, zero page and page wrap, branches, JMP ($xxFF),
+//                      JSR/RTS, RTI and BRK. Starts at $0400, keeps the
+//                      running test case at $0200 (see instructions.lst) and
+//                      ends in JMP * at $F000, or at $F003 on a failure
+//   illegal.bin        the same for the stable undocumented NMOS opcodes, with
+//                      RRA, ISC, SBC and ARR in decimal mode too, for -C 6502x
+//   decimal.bin        ADC and SBC in decimal mode for every operand and
+//   decimal_65c02.bin  carry, predicted the way Bruce Clark's decimal mode
+//                      tutorial does. Starts at $0200, the ERROR byte at $0B
+//                      is 0 when the run ends in JMP *
+//
+// A test case runs one instruction over a list of vectors, each
+// the registers and operand before and after:
+//
+//   A X Y P S M | A' X' Y' P' S' M'
+//
+// On a mismatch the check routine jumps to $F003 with X the register that
+// differs (0 A, 1 X, 2 Y, 3 P, 4 S, $FF the operand) and $F2/$F3 pointing at
+// the vector.
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "ins_65xx.h"
+
+constexpr uint32_t ROM_SIZE  = 0x10000;  // Images cover all of memory
+constexpr Word ROM_CODE      = 0x0400;
+constexpr Word ROM_CASE      = 0x0200;  // Number of the running test case
+constexpr Word ROM_DATA      = 0x0320;  // Operand of the absolute and indirect modes
+constexpr Word ROM_SCRATCH   = 0x0330;  // Operand of instructions that touch no memory
+constexpr Word ROM_POINTER   = 0x0340;  // JMP (abs) pointer
+constexpr Word ROM_PAGE_BUG  = 0x03FF;  // JMP ($03FF) takes the high byte from $0300
+constexpr Word ROM_SUCCESS   = 0xF000;
+constexpr Word ROM_FAIL      = 0xF003;
+constexpr Byte ROM_ZP        = 0x20;    // Operand of the zero page modes
+constexpr Byte ROM_TEST_S    = 0xE0;    // Stack pointer the vectors run with
+constexpr Word DECIMAL_CODE  = 0x0200;
+constexpr Byte DECIMAL_ERROR = 0x0B;
+
+// Driver work area in zero page
+constexpr Byte ZP_IN     = 0xE0;  // A X Y P S M of the running vector
+constexpr Byte ZP_EXPECT = 0xE6;  // and the expected results
+constexpr Byte ZP_OUT    = 0xEC;  // A X Y P S read back after the instruction
+constexpr Byte ZP_VECTOR = 0xF2;  // Running vector
+constexpr Byte ZP_TARGET = 0xF4;  // Operand address
+constexpr Byte ZP_COUNT  = 0xF6;  // Vectors left
+constexpr Byte ZP_CHECKM = 0xF7;  // Nonzero when the operand is compared too
+constexpr Byte ZP_BRK    = 0xF8;  // P, PCL, PCH and I|D the BRK handler expects
+
+constexpr Byte FLAG_C = 0x01, FLAG_Z = 0x02, FLAG_I = 0x04, FLAG_D = 0x08, FLAG_B = 0x10, FLAG_U = 0x20, FLAG_V = 0x40, FLAG_N = 0x80;
+
+enum { FIXUP_WORD, FIXUP_REL, FIXUP_LOW, FIXUP_HIGH };
+
+// Just enough of an assembler for the images: one pass with labels resolved
+// at the end by Link()
+class Assembler {
+public:
+ std::vector<Byte> Image = std::vector<Byte>(ROM_SIZE, 0);
+ Word PC                 = 0;
+
+ void Org(Word Address) { PC = Address; }
+ void Label(const std::string& Name) { Labels[Name] = PC; }
+ std::string Local() { return "." + std::to_string(Locals++); }
+
+ void Emit(Byte Value) { Image[PC++] = Value; }
+ void Op(Byte Opcode) { Emit(Opcode); }
+ void Op(Byte Opcode, Byte Operand) {
+  Emit(Opcode);
+  Emit(Operand);
+ }
+ void OpWord(Byte Opcode, Word Operand) {
+  Emit(Opcode);
+  Emit(Operand & 0xFF);
+  Emit(Operand >> 8);
+ }
+ void OpLabel(Byte Opcode, const std::string& Target) {
+  Emit(Opcode);
+  Refer(PC, Target, FIXUP_WORD);
+  PC += 2;
+ }
+ void Branch(Byte Opcode, const std::string& Target) {
+  Emit(Opcode);
+  Refer(PC++, Target, FIXUP_REL);
+ }
+ void Low(Byte Opcode, const std::string& Target, int Addend = 0) {
+  Emit(Opcode);
+  Refer(PC++, Target, FIXUP_LOW, Addend);
+ }
+ void High(Byte Opcode, const std::string& Target, int Addend = 0) {
+  Emit(Opcode);
+  Refer(PC++, Target, FIXUP_HIGH, Addend);
+ }
+ // Branches that can reach anywhere: the inverse branch over a JMP
+ void FarBranch(Byte Opcode, Word Target) {
+  Op(Opcode ^ 0x20, 3);
+  OpWord(INS_JMP_AB, Target);
+ }
+ void Refer(Word At, const std::string& Target, int Kind, int Addend = 0) { Fixups.push_back({At, Target, Kind, Addend}); }
+
+ bool Link() {
+  for (const Fixup& F : Fixups) {
+   auto Found = Labels.find(F.Label);
+   if (Found == Labels.end()) {
+    printf("mkroms: undefined label %s\n", F.Label.c_str());
+    return false;
+   }
+   Word Value = Found->second + F.Addend;
+   switch (F.Kind) {
+   case FIXUP_WORD:
+    Image[F.At]             = Value & 0xFF;
+    Image[(Word)(F.At + 1)] = Value >> 8;
+    break;
+   case FIXUP_REL: {
+    int Offset = Value - (F.At + 1);
+    if (Offset < -128 || Offset > 127) {
+     printf("mkroms: branch to %s at %04x out of range\n", F.Label.c_str(), F.At);
+     return false;
+    }
+    Image[F.At] = (Byte)Offset;
+    break;
+   }
+   case FIXUP_LOW:
+    Image[F.At] = Value & 0xFF;
+    break;
+   case FIXUP_HIGH:
+    Image[F.At] = Value >> 8;
+    break;
+   }
+  }
+  return true;
+ }
+
+ bool Save(const std::string& Path) const {
+  FILE* File = fopen(Path.c_str(), "wb");
+  if (!File || fwrite(Image.data(), 1, Image.size(), File) != Image.size()) {
+   perror(Path.c_str());
+   if (File) fclose(File);
+   return false;
+  }
+  return fclose(File) == 0;
+ }
+
+private:
+ struct Fixup {
+  Word At;
+  std::string Label;
+  int Kind;
+  int Addend;
+ };
+ std::map<std::string, Word> Labels;
+ std::vector<Fixup> Fixups;
+ int Locals = 0;
+};
+
+//
+// Instruction models
+//
+
+struct State {
+ Byte A, X, Y, P, S, M;
+};
+typedef void (*Model)(State&);
+
+static void SetFlag(State& s, Byte Flag, bool On) { s.P = On ? s.P | Flag : s.P & ~Flag; }
+
+static void SetNZ(State& s, Byte Value) {
+ SetFlag(s, FLAG_N, Value & 0x80);
+ SetFlag(s, FLAG_Z, Value == 0);
+}
+
+// NMOS decimal mode after Bruce Clark: A and C from his sequence 1, N and V
+// from sequence 2, Z from the binary sum. SBC flags are always the binary ones
+static void Add(State& s, Byte Value) {
+ int Carry = s.P & FLAG_C;
+ int Sum   = s.A + Value + Carry;
+ if (!(s.P & FLAG_D)) {
+  SetFlag(s, FLAG_V, ~(s.A ^ Value) & (s.A ^ Sum) & 0x80);
+  SetFlag(s, FLAG_C, Sum > 0xFF);
+  s.A = Sum;
+  SetNZ(s, s.A);
+  return;
+ }
+ int Low = (s.A & 0x0F) + (Value & 0x0F) + Carry;
+ if (Low >= 0x0A) Low = ((Low + 0x06) & 0x0F) + 0x10;
+ int Signed = (int8_t)(s.A & 0xF0) + (int8_t)(Value & 0xF0) + Low;
+ int Result = (s.A & 0xF0) + (Value & 0xF0) + Low;
+ if (Result >= 0xA0) Result += 0x60;
+ SetFlag(s, FLAG_N, Signed & 0x80);
+ SetFlag(s, FLAG_V, Signed < -128 || Signed > 127);
+ SetFlag(s, FLAG_Z, (Sum & 0xFF) == 0);
+ SetFlag(s, FLAG_C, Result >= 0x100);
+ s.A = Result;
+}
+
+static void Subtract(State& s, Byte Value) {
+ State Binary = s;
+ Binary.P &= ~FLAG_D;
+ Add(Binary, ~Value);
+ if (s.P & FLAG_D) {
+  int Borrow = !(s.P & FLAG_C);
+  int Low    = (s.A & 0x0F) - (Value & 0x0F) - Borrow;
+  if (Low < 0) Low = ((Low - 0x06) & 0x0F) - 0x10;
+  int Result = (s.A & 0xF0) - (Value & 0xF0) + Low;
+  if (Result < 0) Result -= 0x60;
+  Binary.A = Result;
+ }
+ s.A = Binary.A;
+ s.P = (Binary.P & ~FLAG_D) | (s.P & FLAG_D);
+}
+
+static void Compare(State& s, Byte Register) {
+ SetFlag(s, FLAG_C, Register >= s.M);
+ SetNZ(s, Register - s.M);
+}
+
+template <Byte State::*Reg> static void Load(State& s) { SetNZ(s, s.*Reg = s.M); }
+template <Byte State::*Reg> static void Store(State& s) { s.M = s.*Reg; }
+template <Byte State::*From, Byte State::*To> static void Transfer(State& s) { SetNZ(s, s.*To = s.*From); }
+template <Byte State::*Reg> static void Increment(State& s) { SetNZ(s, ++(s.*Reg)); }
+template <Byte State::*Reg> static void Decrement(State& s) { SetNZ(s, --(s.*Reg)); }
+template <Byte State::*Reg> static void ShiftLeft(State& s) {
+ SetFlag(s, FLAG_C, s.*Reg & 0x80);
+ SetNZ(s, s.*Reg <<= 1);
+}
+template <Byte State::*Reg> static void ShiftRight(State& s) {
+ SetFlag(s, FLAG_C, s.*Reg & 0x01);
+ SetNZ(s, s.*Reg >>= 1);
+}
+template <Byte State::*Reg> static void RotateLeft(State& s) {
+ Byte Carry = s.P & FLAG_C;
+ SetFlag(s, FLAG_C, s.*Reg & 0x80);
+ SetNZ(s, s.*Reg = (s.*Reg << 1) | Carry);
+}
+template <Byte State::*Reg> static void RotateRight(State& s) {
+ Byte Carry = s.P & FLAG_C;
+ SetFlag(s, FLAG_C, s.*Reg & 0x01);
+ SetNZ(s, s.*Reg = (s.*Reg >> 1) | (Carry << 7));
+}
+template <Byte Flag, bool On> static void SetStatus(State& s) { SetFlag(s, Flag, On); }
+template <Byte State::*Reg> static void CompareWith(State& s) { Compare(s, s.*Reg); }
+
+static void And(State& s) { SetNZ(s, s.A &= s.M); }
+static void Or(State& s) { SetNZ(s, s.A |= s.M); }
+static void Xor(State& s) { SetNZ(s, s.A ^= s.M); }
+static void AddM(State& s) { Add(s, s.M); }
+static void SubtractM(State& s) { Subtract(s, s.M); }
+static void BitTest(State& s) {
+ SetFlag(s, FLAG_Z, !(s.A & s.M));
+ SetFlag(s, FLAG_N, s.M & 0x80);
+ SetFlag(s, FLAG_V, s.M & 0x40);
+}
+static void TransferXS(State& s) { s.S = s.X; }
+static void Push(State& s) {
+ s.M = s.A;
+ s.S--;
+}
+static void PushStatus(State& s) {
+ s.M = s.P | FLAG_B | FLAG_U;
+ s.S--;
+}
+static void Pull(State& s) {
+ SetNZ(s, s.A = s.M);
+ s.S++;
+}
+static void PullStatus(State& s) {
+ s.P = s.M;
+ s.S++;
+}
+static void Nothing(State&) {}
+
+// Undocumented NMOS, the combined ones as the two documented halves
+static void ShiftOr(State& s) {
+ ShiftLeft<&State::M>(s);
+ Or(s);
+}
+static void RotateAnd(State& s) {
+ RotateLeft<&State::M>(s);
+ And(s);
+}
+static void ShiftXor(State& s) {
+ ShiftRight<&State::M>(s);
+ Xor(s);
+}
+static void RotateAdd(State& s) {
+ RotateRight<&State::M>(s);
+ AddM(s);
+}
+static void DecrementCompare(State& s) {
+ s.M--;
+ Compare(s, s.A);
+}
+static void IncrementSubtract(State& s) {
+ s.M++;
+ SubtractM(s);
+}
+static void StoreAnd(State& s) { s.M = s.A & s.X; }
+static void LoadBoth(State& s) { SetNZ(s, s.A = s.X = s.M); }
+static void LoadStack(State& s) { SetNZ(s, s.A = s.X = s.S = s.M & s.S); }
+static void AndCarry(State& s) {
+ And(s);
+ SetFlag(s, FLAG_C, s.A & 0x80);
+}
+static void AndShift(State& s) {
+ s.A &= s.M;
+ ShiftRight<&State::A>(s);
+}
+static void SubtractX(State& s) {
+ Byte Value = s.A & s.X;
+ SetFlag(s, FLAG_C, Value >= s.M);
+ SetNZ(s, s.X = Value - s.M);
+}
+
+// ARR after 64doc: N and Z from the rotated value, V from bits 7 and 6 of
+// the AND. In binary mode C is bit 6 of the result, in decimal mode each
+// nibble of the AND above 4 (an odd one counts one more) adds 6 to its
+// nibble of the result and the high one sets C
+static void AndRotate(State& s) {
+ Byte Both = s.A & s.M;
+ s.A       = (Both >> 1) | ((s.P & FLAG_C) << 7);
+ SetNZ(s, s.A);
+ SetFlag(s, FLAG_V, (Both ^ s.A) & 0x40);
+ if (!(s.P & FLAG_D)) {
+  SetFlag(s, FLAG_C, s.A & 0x40);
+  return;
+ }
+ if ((Both & 0x0F) + (Both & 0x01) > 5) s.A = (s.A & 0xF0) | ((s.A + 0x06) & 0x0F);
+ bool Carry = ((Both + (Both & 0x10)) & 0x1F0) > 0x50;
+ SetFlag(s, FLAG_C, Carry);
+ if (Carry) s.A += 0x60;
+}
+
+//
+// Test vectors
+//
+
+static const Byte Values[] = {0x00, 0x01, 0x40, 0x7F, 0x80, 0x81, 0xC0, 0xFE, 0xFF, 0x55};
+static const Byte Few[]    = {0x00, 0x7F, 0x80, 0xFF};
+static const Byte Bcd[]    = {0x00, 0x01, 0x09, 0x10, 0x19, 0x49, 0x50, 0x51, 0x99};
+
+// What the registers hold when a vector does not say otherwise
+static State Base() { return {0x5A, 0xA5, 0x3C, 0x00, ROM_TEST_S, 0x96}; }
+
+typedef std::function<std::vector<State>(bool Full)> Inputs;
+
+// One register over the values, each with P clear and P = Set. The first
+// addressing mode of an instruction gets the full set, the others a few
+static Inputs Unary(Byte State::*Reg, Byte Set = 0xFF) {
+ return [=](bool Full) {
+  std::vector<State> List;
+  if (Full) {
+   for (Byte Value : Values)
+    for (Byte P : {(Byte)0x00, Set}) {
+     State s = Base();
+     s.*Reg  = Value;
+     s.P     = P;
+     List.push_back(s);
+    }
+  } else {
+   for (size_t i = 0; i < sizeof(Few); i++) {
+    State s = Base();
+    s.*Reg  = Few[i];
+    s.P     = i & 1 ? Set : 0x00;
+    List.push_back(s);
+   }
+  }
+  return List;
+ };
+}
+
+// A register against the operand. With Both each pair runs with both P,
+// otherwise P alternates
+static Inputs Binary(Byte State::*Reg, Byte Set = 0xFF, bool Both = false) {
+ return [=](bool Full) {
+  std::vector<State> List;
+  std::vector<Byte> Left(Full ? std::begin(Values) : std::begin(Few), Full ? std::end(Values) : std::end(Few));
+  std::vector<Byte> Right(Full ? std::begin(Values) : std::begin(Few), Full ? std::end(Values) : std::end(Few));
+  if (!Full) Right = {0x01, 0x80};
+  for (Byte L : Left)
+   for (Byte R : Right)
+    for (int Pass = 0; Pass < (Both && Full ? 2 : 1); Pass++) {
+     State s = Base();
+     s.*Reg  = L;
+     s.M     = R;
+     s.P     = (Both && Full ? Pass : List.size() & 1) ? Set : 0x00;
+     List.push_back(s);
+    }
+  return List;
+ };
+}
+
+// Valid BCD operands in decimal mode, both carries
+static Inputs Decimal() {
+ return [](bool) {
+  std::vector<State> List;
+  for (Byte L : Bcd)
+   for (Byte R : Bcd)
+    for (Byte Carry : {0, 1}) {
+     State s = Base();
+     s.A     = L;
+     s.M     = R;
+     s.P     = FLAG_D | Carry;
+     List.push_back(s);
+    }
+  return List;
+ };
+}
+
+// Any operands in decimal mode, both carries: the NMOS result is defined for
+// invalid BCD too
+static Inputs DecimalAny() {
+ return [](bool) {
+  std::vector<State> List;
+  for (Byte L : Values)
+   for (Byte R : Values)
+    for (Byte Carry : {0, 1}) {
+     State s = Base();
+     s.A     = L;
+     s.M     = R;
+     s.P     = FLAG_D | Carry;
+     List.push_back(s);
+    }
+  return List;
+ };
+}
+
+static Inputs Status() {
+ return [](bool) {
+  std::vector<State> List;
+  for (Byte P : {0x00, 0xFF, 0x55, 0xAA}) {
+   State s = Base();
+   s.P     = P;
+   List.push_back(s);
+  }
+  return List;
+ };
+}
+
+//
+// Addressing modes. Indexed modes fix their index register in every vector,
+// so the instruction always lands on the same operand
+//
+
+enum {
+ MODE_IMPLIED,
+ MODE_ACCUMULATOR,
+ MODE_IMMEDIATE,
+ MODE_ZEROPAGE,
+ MODE_ZEROPAGE_X,
+ MODE_ZEROPAGE_Y,
+ MODE_ABSOLUTE,
+ MODE_ABSOLUTE_X,
+ MODE_ABSOLUTE_Y,
+ MODE_INDIRECT_X,
+ MODE_INDIRECT_Y,
+ MODE_ZEROPAGE_X_WRAP,
+ MODE_ZEROPAGE_Y_WRAP,
+ MODE_ABSOLUTE_X_PAGE,
+ MODE_ABSOLUTE_Y_PAGE,
+ MODE_ABSOLUTE_X_WRAP,
+ MODE_INDIRECT_X_WRAP,
+ MODE_INDIRECT_Y_PAGE,
+ MODE_INDIRECT_Y_WRAP,
+ MODE_PUSH,
+ MODE_PULL,
+};
+
+struct Addressing {
+ const char* Name;
+ Byte Length;
+ Word Operand;
+ Byte State::*Index;
+ Byte IndexValue;
+ Word Address;  // Of the operand, immediate operands are patched in place
+};
+
+static const Addressing Modes[] = {
+ {"", 1, 0, nullptr, 0, ROM_SCRATCH},
+ {" a", 1, 0, nullptr, 0, ROM_SCRATCH},
+ {" #", 2, 0, nullptr, 0, 0},
+ {" zp", 2, ROM_ZP, nullptr, 0, ROM_ZP},
+ {" zp,x", 2, ROM_ZP - 0x10, &State::X, 0x10, ROM_ZP},
+ {" zp,y", 2, ROM_ZP - 0x10, &State::Y, 0x10, ROM_ZP},
+ {" abs", 3, ROM_DATA, nullptr, 0, ROM_DATA},
+ {" abs,x", 3, ROM_DATA - 0x10, &State::X, 0x10, ROM_DATA},
+ {" abs,y", 3, ROM_DATA - 0x10, &State::Y, 0x10, ROM_DATA},
+ {" (zp,x)", 2, 0x20, &State::X, 0x10, ROM_DATA},   // Pointer $30
+ {" (zp),y", 2, 0x32, &State::Y, 0x10, ROM_DATA},   // Pointer $32 -> $0310
+ {" zp,x wrap", 2, 0xF0, &State::X, 0x30, ROM_ZP},  // $F0 + $30 stays in page zero
+ {" zp,y wrap", 2, 0xF0, &State::Y, 0x30, ROM_ZP},
+ {" abs,x page", 3, ROM_DATA - 0x30, &State::X, 0x30, ROM_DATA},
+ {" abs,y page", 3, ROM_DATA - 0x30, &State::Y, 0x30, ROM_DATA},
+ {" abs,x wrap", 3, 0xFFF0, &State::X, 0x30, ROM_ZP},  // Past $FFFF into page zero
+ {" (zp,x) wrap", 2, 0xF8, &State::X, 0x38, ROM_DATA},  // $F8 + $38 is pointer $30
+ {" (zp),y page", 2, 0x34, &State::Y, 0x30, ROM_DATA},  // Pointer $34 -> $02F0
+ {" (zp),y wrap", 2, 0xFF, &State::Y, 0x10, ROM_DATA},  // Pointer in $FF and $00 -> $0310
+ {"", 1, 0, &State::S, ROM_TEST_S, 0x0100 + ROM_TEST_S},
+ {"", 1, 0, &State::S, ROM_TEST_S, 0x0100 + ROM_TEST_S + 1},
+};
+
+static void SetPointers(Assembler& Asm) {
+ Asm.Image[0x30] = ROM_DATA & 0xFF;
+ Asm.Image[0x31] = ROM_DATA >> 8;
+ Asm.Image[0x32] = (ROM_DATA - 0x10) & 0xFF;
+ Asm.Image[0x33] = (ROM_DATA - 0x10) >> 8;
+ Asm.Image[0x34] = (ROM_DATA - 0x30) & 0xFF;
+ Asm.Image[0x35] = (ROM_DATA - 0x30) >> 8;
+ Asm.Image[0xFF] = (ROM_DATA - 0x10) & 0xFF;
+ Asm.Image[0x00] = (ROM_DATA - 0x10) >> 8;
+}
+
+//
+// Instruction tests
+//
+
+class Suite {
+public:
+ Assembler Asm;
+ std::string Listing;
+ bool Failed = false;
+
+ // A new test case: its number goes to $0200 for bench/functest to report
+ void Case(const std::string& Name) {
+  if (++Cases > 0xFF) {
+   printf("mkroms: more than 255 test cases\n");
+   Failed = true;
+  }
+  char Line[64];
+  snprintf(Line, sizeof(Line), "%02x  %s\n", Cases & 0xFF, Name.c_str());
+  Listing += Line;
+  Asm.Op(INS_LDA_IM, Cases);
+  Asm.OpWord(INS_STA_AB, ROM_CASE);
+ }
+
+ // One instruction over its vectors
+ void Test(const std::string& Mnemonic, Byte Opcode, int Mode, Model Fn, std::vector<State> In, bool CheckM = true) {
+  const Addressing& A = Modes[Mode];
+  if (In.empty() || In.size() > 0xFF) {
+   printf("mkroms: %s%s has %zu vectors\n", Mnemonic.c_str(), A.Name, In.size());
+   Failed = true;
+   return;
+  }
+  Case(Mnemonic + A.Name);
+
+  std::string Vectors = Asm.Local(), Loop = Asm.Local(), Immediate = Asm.Local();
+  std::vector<Byte> Data;
+  for (State s : In) {
+   if (A.Index) s.*A.Index = A.IndexValue;
+   State Out = s;
+   Fn(Out);
+   Out.P |= FLAG_B | FLAG_U;
+   Data.insert(Data.end(), {s.A, s.X, s.Y, s.P, s.S, s.M, Out.A, Out.X, Out.Y, Out.P, Out.S, Out.M});
+  }
+  Pending.push_back({Vectors, Data});
+
+  Asm.Low(INS_LDA_IM, Vectors);
+  Asm.Op(INS_STA_ZP, ZP_VECTOR);
+  Asm.High(INS_LDA_IM, Vectors);
+  Asm.Op(INS_STA_ZP, ZP_VECTOR + 1);
+  if (Mode == MODE_IMMEDIATE) {
+   Asm.Low(INS_LDA_IM, Immediate);
+   Asm.Op(INS_STA_ZP, ZP_TARGET);
+   Asm.High(INS_LDA_IM, Immediate);
+  } else {
+   Asm.Op(INS_LDA_IM, A.Address & 0xFF);
+   Asm.Op(INS_STA_ZP, ZP_TARGET);
+   Asm.Op(INS_LDA_IM, A.Address >> 8);
+  }
+  Asm.Op(INS_STA_ZP, ZP_TARGET + 1);
+  Asm.Op(INS_LDA_IM, In.size());
+  Asm.Op(INS_STA_ZP, ZP_COUNT);
+  Asm.Op(INS_LDA_IM, CheckM);
+  Asm.Op(INS_STA_ZP, ZP_CHECKM);
+
+  Asm.Label(Loop);
+  Asm.OpLabel(INS_JSR_AB, "setup");
+  Asm.Op(INS_LDX_ZP, ZP_IN + 4);
+  Asm.Op(INS_TXS_IMPL);
+  Asm.Op(INS_LDX_ZP, ZP_IN + 1);
+  Asm.Op(INS_LDY_ZP, ZP_IN + 2);
+  Asm.Op(INS_LDA_ZP, ZP_IN + 3);
+  Asm.Op(INS_PHA_IMPL);
+  Asm.Op(INS_LDA_ZP, ZP_IN);
+  Asm.Op(INS_PLP_IMPL);
+
+  Asm.Emit(Opcode);
+  if (Mode == MODE_IMMEDIATE) Asm.Label(Immediate);
+  if (A.Length > 1) Asm.Emit(A.Operand & 0xFF);
+  if (A.Length > 2) Asm.Emit(A.Operand >> 8);
+
+  Asm.Op(INS_PHP_IMPL);
+  Asm.Op(INS_STA_ZP, ZP_OUT);
+  Asm.Op(INS_STX_ZP, ZP_OUT + 1);
+  Asm.Op(INS_STY_ZP, ZP_OUT + 2);
+  Asm.Op(INS_PLA_IMPL);
+  Asm.Op(INS_STA_ZP, ZP_OUT + 3);
+  Asm.Op(INS_TSX_IMPL);
+  Asm.Op(INS_STX_ZP, ZP_OUT + 4);
+  Asm.Op(INS_LDX_IM, 0xFF);
+  Asm.Op(INS_TXS_IMPL);
+  Asm.OpLabel(INS_JSR_AB, "check");
+  Asm.Branch(INS_BNE_REL, Loop);
+ }
+
+ // The same instruction in several modes, the first with the full vectors
+ void Group(const std::string& Mnemonic, std::initializer_list<std::pair<Byte, int>> Opcodes, Model Fn, Inputs In, bool CheckM = true) {
+  bool Full = true;
+  for (const auto& Entry : Opcodes) {
+   Test(Mnemonic, Entry.first, Entry.second, Fn, In(Full), CheckM);
+   Full = false;
+  }
+ }
+
+ // Taken forwards and backwards, not taken, with the other flags both ways
+ void Branch(const std::string& Mnemonic, Byte Opcode, Byte Flag, bool TakenIfSet) {
+  Case(Mnemonic);
+  for (Byte P : {Flag, (Byte)0x00, (Byte)0xFF, (Byte)(0xFF ^ Flag)}) {
+   Asm.Op(INS_LDA_IM, P);
+   Asm.Op(INS_PHA_IMPL);
+   Asm.Op(INS_PLP_IMPL);
+   std::string Forward = Asm.Local(), Back = Asm.Local(), Around = Asm.Local(), Done = Asm.Local();
+   if (((P & Flag) != 0) == TakenIfSet) {
+    Asm.Branch(Opcode, Forward);
+    Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+    Asm.Label(Forward);
+    Asm.OpLabel(INS_JMP_AB, Around);
+    Asm.Label(Back);
+    Asm.OpLabel(INS_JMP_AB, Done);
+    Asm.Label(Around);
+    Asm.Branch(Opcode, Back);
+    Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+   } else {
+    Asm.Branch(Opcode, Forward);
+    Asm.OpLabel(INS_JMP_AB, Done);
+    Asm.Label(Forward);
+    Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+   }
+   Asm.Label(Done);
+  }
+  ClearStatus();
+ }
+
+ void Jumps() {
+  std::string Target = Asm.Local();
+  Case("jmp abs");
+  Asm.OpLabel(INS_JMP_AB, Target);
+  Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+  Asm.Label(Target);
+
+  Target = Asm.Local();
+  Case("jmp (abs)");
+  Asm.Refer(ROM_POINTER, Target, FIXUP_WORD);
+  Asm.OpWord(INS_JMP_IN, ROM_POINTER);
+  Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+  Asm.Label(Target);
+
+  // The NMOS pointer fetch does not carry into the high byte
+  Target = Asm.Local();
+  Case("jmp ($xxff)");
+  Asm.Refer(ROM_PAGE_BUG, Target, FIXUP_LOW);
+  Asm.Refer(ROM_PAGE_BUG & 0xFF00, Target, FIXUP_HIGH);
+  Asm.OpWord(INS_JMP_IN, ROM_PAGE_BUG);
+  Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+  Asm.Label(Target);
+ }
+
+ void Subroutine() {
+  std::string Call = Asm.Local(), Sub = Asm.Local(), Done = Asm.Local();
+  Case("jsr/rts");
+  Asm.Op(INS_LDX_IM, 0xFF);
+  Asm.Op(INS_TXS_IMPL);
+  Asm.Label(Call);
+  Asm.OpLabel(INS_JSR_AB, Sub);
+  Asm.Op(INS_TSX_IMPL);
+  Asm.Op(INS_CPX_IM, 0xFF);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.OpLabel(INS_JMP_AB, Done);
+
+  // The return address on the stack is the last byte of the JSR
+  Asm.Label(Sub);
+  Asm.Op(INS_TSX_IMPL);
+  Asm.Op(INS_CPX_IM, 0xFD);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.OpWord(INS_LDA_AB, 0x01FE);
+  Asm.Low(INS_CMP_IM, Call, 2);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.OpWord(INS_LDA_AB, 0x01FF);
+  Asm.High(INS_CMP_IM, Call, 2);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.Op(INS_RTS_IMPL);
+  Asm.Label(Done);
+ }
+
+ void Interrupts() {
+  Case("rti");
+  for (Byte P : {0x00, 0xCF}) {
+   std::string Return = Asm.Local();
+   Asm.Op(INS_LDX_IM, 0xFF);
+   Asm.Op(INS_TXS_IMPL);
+   Asm.High(INS_LDA_IM, Return);
+   Asm.Op(INS_PHA_IMPL);
+   Asm.Low(INS_LDA_IM, Return);
+   Asm.Op(INS_PHA_IMPL);
+   Asm.Op(INS_LDA_IM, P);
+   Asm.Op(INS_PHA_IMPL);
+   Asm.Op(INS_RTI_IMPL);
+   Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+   Asm.Label(Return);
+   ExpectStatus(P);
+  }
+  ClearStatus();
+
+  // BRK pushes the address of the byte after its signature byte and P with
+  // B set, then runs the IRQ handler with I set
+  Case("brk");
+  for (Byte P : {0x00, 0xCB}) {
+   std::string Return = Asm.Local();
+   Asm.Op(INS_LDX_IM, 0xFF);
+   Asm.Op(INS_TXS_IMPL);
+   Asm.Op(INS_LDA_IM, P | FLAG_B | FLAG_U);
+   Asm.Op(INS_STA_ZP, ZP_BRK);
+   Asm.Low(INS_LDA_IM, Return);
+   Asm.Op(INS_STA_ZP, ZP_BRK + 1);
+   Asm.High(INS_LDA_IM, Return);
+   Asm.Op(INS_STA_ZP, ZP_BRK + 2);
+   Asm.Op(INS_LDA_IM, FLAG_I | (P & FLAG_D));
+   Asm.Op(INS_STA_ZP, ZP_BRK + 3);
+   Asm.Op(INS_LDA_IM, P);
+   Asm.Op(INS_PHA_IMPL);
+   Asm.Op(INS_PLP_IMPL);
+   Asm.Op(INS_BRK_IMPL);
+   Asm.Emit(0xFF);
+   Asm.Label(Return);
+   ExpectStatus(P);
+  }
+  ClearStatus();
+ }
+
+ // Shared code after the test cases: the vector driver and the BRK handler
+ void Routines() {
+  std::string Copy = Asm.Local(), Compare = Asm.Local(), Skip = Asm.Local(), Next = Asm.Local();
+  Asm.Label("setup");
+  Asm.Op(INS_LDY_IM, 11);
+  Asm.Label(Copy);
+  Asm.Op(INS_LDA_INY, ZP_VECTOR);
+  Asm.OpWord(INS_STA_ABY, ZP_IN);
+  Asm.Op(INS_DEY_IMPL);
+  Asm.Branch(INS_BPL_REL, Copy);
+  Asm.Op(INS_LDY_IM, 0);
+  Asm.Op(INS_LDA_ZP, ZP_IN + 5);
+  Asm.Op(INS_STA_INY, ZP_TARGET);
+  Asm.Op(INS_RTS_IMPL);
+
+  // Z clear on return while vectors are left
+  Asm.Label("check");
+  Asm.Op(INS_CLD_IMPL);
+  Asm.Op(INS_LDX_IM, 4);
+  Asm.Label(Compare);
+  Asm.Op(INS_LDA_ZPX, ZP_OUT);
+  Asm.Op(INS_CMP_ZPX, ZP_EXPECT);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.Op(INS_DEX_IMPL);
+  Asm.Branch(INS_BPL_REL, Compare);
+  Asm.Op(INS_LDA_ZP, ZP_CHECKM);
+  Asm.Branch(INS_BEQ_REL, Skip);
+  Asm.Op(INS_LDY_IM, 0);
+  Asm.Op(INS_LDA_INY, ZP_TARGET);
+  Asm.Op(INS_CMP_ZP, ZP_EXPECT + 5);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.Label(Skip);
+  Asm.Op(INS_CLC_IMPL);
+  Asm.Op(INS_LDA_ZP, ZP_VECTOR);
+  Asm.Op(INS_ADC_IM, 12);
+  Asm.Op(INS_STA_ZP, ZP_VECTOR);
+  Asm.Branch(INS_BCC_REL, Next);
+  Asm.Op(INS_INC_ZP, ZP_VECTOR + 1);
+  Asm.Label(Next);
+  Asm.Op(INS_DEC_ZP, ZP_COUNT);
+  Asm.Op(INS_RTS_IMPL);
+
+  Asm.Label("irq");
+  Asm.Op(INS_PHP_IMPL);
+  Asm.Op(INS_PLA_IMPL);
+  Asm.Op(INS_AND_IM, FLAG_I | FLAG_D);
+  Asm.Op(INS_CMP_ZP, ZP_BRK + 3);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.Op(INS_TSX_IMPL);
+  Asm.Op(INS_CPX_IM, 0xFC);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  for (Byte i = 0; i < 3; i++) {
+   Asm.OpWord(INS_LDA_AB, 0x01FD + i);
+   Asm.Op(INS_CMP_ZP, ZP_BRK + i);
+   Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  }
+  Asm.Op(INS_RTI_IMPL);
+ }
+
+ // The image and the list of its test cases
+ bool Save(const std::string& Directory, const std::string& Name) {
+  std::string Path = Directory + "/" + Name + ".lst";
+  FILE* File       = fopen(Path.c_str(), "w");
+  if (!File) {
+   perror(Path.c_str());
+   return false;
+  }
+  fputs(Listing.c_str(), File);
+  return fclose(File) == 0 && Asm.Save(Directory + "/" + Name + ".bin");
+ }
+
+ void Data() {
+  for (const auto& Entry : Pending) {
+   Asm.Label(Entry.first);
+   for (Byte Value : Entry.second) Asm.Emit(Value);
+  }
+ }
+
+private:
+ std::vector<std::pair<std::string, std::vector<Byte>>> Pending;
+ int Cases = 0;
+
+ // P as PHP sees it, and the stack back at $FF
+ void ExpectStatus(Byte P) {
+  Asm.Op(INS_PHP_IMPL);
+  Asm.Op(INS_PLA_IMPL);
+  Asm.Op(INS_CMP_IM, P | FLAG_B | FLAG_U);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+  Asm.Op(INS_TSX_IMPL);
+  Asm.Op(INS_CPX_IM, 0xFF);
+  Asm.FarBranch(INS_BNE_REL, ROM_FAIL);
+ }
+
+ void ClearStatus() {
+  Asm.Op(INS_LDA_IM, 0);
+  Asm.Op(INS_PHA_IMPL);
+  Asm.Op(INS_PLP_IMPL);
+ }
+};
+
+// Memory operand modes shared by the ALU instructions
+#define ALU_MODES(Op) {{INS_##Op##_IM, MODE_IMMEDIATE}, {INS_##Op##_ZP, MODE_ZEROPAGE}, {INS_##Op##_ZPX, MODE_ZEROPAGE_X}, {INS_##Op##_AB, MODE_ABSOLUTE}, {INS_##Op##_ABX, MODE_ABSOLUTE_X}, {INS_##Op##_ABY, MODE_ABSOLUTE_Y}, {INS_##Op##_INX, MODE_INDIRECT_X}, {INS_##Op##_INY, MODE_INDIRECT_Y}}
+#define SHIFT_MODES(Op) {{INS_##Op##_ZP, MODE_ZEROPAGE}, {INS_##Op##_ZPX, MODE_ZEROPAGE_X}, {INS_##Op##_AB, MODE_ABSOLUTE}, {INS_##Op##_ABX, MODE_ABSOLUTE_X}}
+// And the undocumented read-modify-write ones
+#define COMBINED_MODES(Op) {{INS_##Op##_ZP, MODE_ZEROPAGE}, {INS_##Op##_ZPX, MODE_ZEROPAGE_X}, {INS_##Op##_AB, MODE_ABSOLUTE}, {INS_##Op##_ABX, MODE_ABSOLUTE_X}, {INS_##Op##_ABY, MODE_ABSOLUTE_Y}, {INS_##Op##_INX, MODE_INDIRECT_X}, {INS_##Op##_INY, MODE_INDIRECT_Y}}
+
+static void Begin(Suite& S) {
+ SetPointers(S.Asm);
+ S.Asm.Org(ROM_CODE);
+ S.Asm.Op(INS_CLD_IMPL);
+ S.Asm.Op(INS_LDX_IM, 0xFF);
+ S.Asm.Op(INS_TXS_IMPL);
+}
+
+// Success once every case has run, then the driver, the vectors, the traps
+static bool Finish(Suite& S) {
+ Assembler& Asm = S.Asm;
+ Asm.OpWord(INS_JMP_AB, ROM_SUCCESS);
+ S.Routines();
+ S.Data();
+ if (Asm.PC > ROM_SUCCESS || Asm.PC < ROM_CODE) {
+  printf("mkroms: test does not fit below %04x\n", ROM_SUCCESS);
+  return false;
+ }
+
+ Asm.Org(ROM_SUCCESS);
+ Asm.OpWord(INS_JMP_AB, ROM_SUCCESS);
+ Asm.OpWord(INS_JMP_AB, ROM_FAIL);
+ Asm.Image[0xFFFA] = ROM_FAIL & 0xFF;
+ Asm.Image[0xFFFB] = ROM_FAIL >> 8;
+ Asm.Image[0xFFFC] = ROM_CODE & 0xFF;
+ Asm.Image[0xFFFD] = ROM_CODE >> 8;
+ Asm.Refer(0xFFFE, "irq", FIXUP_WORD);
+ return !S.Failed && Asm.Link();
+}
+
+static bool BuildInstructions(Suite& S) {
+ Begin(S);
+ S.Group("lda", ALU_MODES(LDA), Load<&State::A>, Unary(&State::M));
+ for (int Mode : {MODE_ZEROPAGE_X_WRAP, MODE_ABSOLUTE_X_PAGE, MODE_ABSOLUTE_X_WRAP, MODE_INDIRECT_X_WRAP})
+  S.Test("lda", Mode == MODE_ZEROPAGE_X_WRAP ? INS_LDA_ZPX : Mode == MODE_INDIRECT_X_WRAP ? INS_LDA_INX : INS_LDA_ABX, Mode, Load<&State::A>, Unary(&State::M)(false));
+ S.Test("lda", INS_LDA_ABY, MODE_ABSOLUTE_Y_PAGE, Load<&State::A>, Unary(&State::M)(false));
+ S.Test("lda", INS_LDA_INY, MODE_INDIRECT_Y_PAGE, Load<&State::A>, Unary(&State::M)(false));
+ S.Test("lda", INS_LDA_INY, MODE_INDIRECT_Y_WRAP, Load<&State::A>, Unary(&State::M)(false));
+ S.Group("ldx", {{INS_LDX_IM, MODE_IMMEDIATE}, {INS_LDX_ZP, MODE_ZEROPAGE}, {INS_LDX_ZPY, MODE_ZEROPAGE_Y}, {INS_LDX_AB, MODE_ABSOLUTE}, {INS_LDX_ABY, MODE_ABSOLUTE_Y}, {INS_LDX_ZPY, MODE_ZEROPAGE_Y_WRAP}}, Load<&State::X>, Unary(&State::M));
+ S.Group("ldy", {{INS_LDY_IM, MODE_IMMEDIATE}, {INS_LDY_ZP, MODE_ZEROPAGE}, {INS_LDY_ZPX, MODE_ZEROPAGE_X}, {INS_LDY_AB, MODE_ABSOLUTE}, {INS_LDY_ABX, MODE_ABSOLUTE_X}}, Load<&State::Y>, Unary(&State::M));
+
+ S.Group("sta", {{INS_STA_ZP, MODE_ZEROPAGE}, {INS_STA_ZPX, MODE_ZEROPAGE_X}, {INS_STA_AB, MODE_ABSOLUTE}, {INS_STA_ABX, MODE_ABSOLUTE_X}, {INS_STA_ABY, MODE_ABSOLUTE_Y}, {INS_STA_INX, MODE_INDIRECT_X}, {INS_STA_INY, MODE_INDIRECT_Y}, {INS_STA_ZPX, MODE_ZEROPAGE_X_WRAP}, {INS_STA_INY, MODE_INDIRECT_Y_WRAP}}, Store<&State::A>, Unary(&State::A));
+ S.Group("stx", {{INS_STX_ZP, MODE_ZEROPAGE}, {INS_STX_ZPY, MODE_ZEROPAGE_Y}, {INS_STX_AB, MODE_ABSOLUTE}}, Store<&State::X>, Unary(&State::X));
+ S.Group("sty", {{INS_STY_ZP, MODE_ZEROPAGE}, {INS_STY_ZPX, MODE_ZEROPAGE_X}, {INS_STY_AB, MODE_ABSOLUTE}}, Store<&State::Y>, Unary(&State::Y));
+
+ S.Group("tax", {{INS_TAX_IMPL, MODE_IMPLIED}}, Transfer<&State::A, &State::X>, Unary(&State::A));
+ S.Group("txa", {{INS_TXA_IMPL, MODE_IMPLIED}}, Transfer<&State::X, &State::A>, Unary(&State::X));
+ S.Group("tay", {{INS_TAY_IMPL, MODE_IMPLIED}}, Transfer<&State::A, &State::Y>, Unary(&State::A));
+ S.Group("tya", {{INS_TYA_IMPL, MODE_IMPLIED}}, Transfer<&State::Y, &State::A>, Unary(&State::Y));
+ S.Group("tsx", {{INS_TSX_IMPL, MODE_IMPLIED}}, Transfer<&State::S, &State::X>, Unary(&State::S));
+ S.Group("txs", {{INS_TXS_IMPL, MODE_IMPLIED}}, TransferXS, Unary(&State::X));
+
+ // The stack slot a pull reads is overwritten by the driver's PHP
+ S.Group("pha", {{INS_PHA_IMPL, MODE_PUSH}}, Push, Unary(&State::A));
+ S.Group("php", {{INS_PHP_IMPL, MODE_PUSH}}, PushStatus, Status());
+ S.Group("pla", {{INS_PLA_IMPL, MODE_PULL}}, Pull, Unary(&State::M), false);
+ S.Group("plp", {{INS_PLP_IMPL, MODE_PULL}}, PullStatus, Unary(&State::M), false);
+
+ S.Group("and", ALU_MODES(AND), And, Binary(&State::A));
+ S.Group("ora", ALU_MODES(ORA), Or, Binary(&State::A));
+ S.Group("eor", ALU_MODES(EOR), Xor, Binary(&State::A));
+ S.Group("adc", ALU_MODES(ADC), AddM, Binary(&State::A, 0xFF & ~FLAG_D, true));
+ S.Test("adc decimal", INS_ADC_IM, MODE_IMMEDIATE, AddM, Decimal()(true));
+ S.Group("sbc", ALU_MODES(SBC), SubtractM, Binary(&State::A, 0xFF & ~FLAG_D, true));
+ S.Test("sbc decimal", INS_SBC_IM, MODE_IMMEDIATE, SubtractM, Decimal()(true));
+ S.Group("cmp", ALU_MODES(CMP), CompareWith<&State::A>, Binary(&State::A));
+ S.Group("cpx", {{INS_CPX_IM, MODE_IMMEDIATE}, {INS_CPX_ZP, MODE_ZEROPAGE}, {INS_CPX_AB, MODE_ABSOLUTE}}, CompareWith<&State::X>, Binary(&State::X));
+ S.Group("cpy", {{INS_CPY_IM, MODE_IMMEDIATE}, {INS_CPY_ZP, MODE_ZEROPAGE}, {INS_CPY_AB, MODE_ABSOLUTE}}, CompareWith<&State::Y>, Binary(&State::Y));
+ S.Group("bit", {{INS_BIT_ZP, MODE_ZEROPAGE}, {INS_BIT_AB, MODE_ABSOLUTE}}, BitTest, Binary(&State::A));
+
+ S.Group("inc", {{INS_INC_ZP, MODE_ZEROPAGE}, {INS_INC_ZPX, MODE_ZEROPAGE_X}, {INS_INC_AB, MODE_ABSOLUTE}, {INS_INC_ABX, MODE_ABSOLUTE_X}}, Increment<&State::M>, Unary(&State::M));
+ S.Group("dec", {{INS_DEC_ZP, MODE_ZEROPAGE}, {INS_DEC_ZPX, MODE_ZEROPAGE_X}, {INS_DEC_AB, MODE_ABSOLUTE}, {INS_DEC_ABX, MODE_ABSOLUTE_X}}, Decrement<&State::M>, Unary(&State::M));
+ S.Group("inx", {{INS_INX_IMPL, MODE_IMPLIED}}, Increment<&State::X>, Unary(&State::X));
+ S.Group("iny", {{INS_INY_IMPL, MODE_IMPLIED}}, Increment<&State::Y>, Unary(&State::Y));
+ S.Group("dex", {{INS_DEX_IMPL, MODE_IMPLIED}}, Decrement<&State::X>, Unary(&State::X));
+ S.Group("dey", {{INS_DEY_IMPL, MODE_IMPLIED}}, Decrement<&State::Y>, Unary(&State::Y));
+
+ // The accumulator forms go through the same model with A as the operand
+ S.Group("asl", SHIFT_MODES(ASL), ShiftLeft<&State::M>, Unary(&State::M));
+ S.Test("asl", INS_ASL_A, MODE_ACCUMULATOR, ShiftLeft<&State::A>, Unary(&State::A)(true));
+ S.Group("lsr", SHIFT_MODES(LSR), ShiftRight<&State::M>, Unary(&State::M));
+ S.Test("lsr", INS_LSR_A, MODE_ACCUMULATOR, ShiftRight<&State::A>, Unary(&State::A)(true));
+ S.Group("rol", SHIFT_MODES(ROL), RotateLeft<&State::M>, Unary(&State::M));
+ S.Test("rol", INS_ROL_A, MODE_ACCUMULATOR, RotateLeft<&State::A>, Unary(&State::A)(true));
+ S.Group("ror", SHIFT_MODES(ROR), RotateRight<&State::M>, Unary(&State::M));
+ S.Test("ror", INS_ROR_A, MODE_ACCUMULATOR, RotateRight<&State::A>, Unary(&State::A)(true));
+
+ S.Test("clc", INS_CLC_IMPL, MODE_IMPLIED, SetStatus<FLAG_C, false>, Status()(true));
+ S.Test("sec", INS_SEC_IMPL, MODE_IMPLIED, SetStatus<FLAG_C, true>, Status()(true));
+ S.Test("cli", INS_CLI_IMPL, MODE_IMPLIED, SetStatus<FLAG_I, false>, Status()(true));
+ S.Test("sei", INS_SEI_IMPL, MODE_IMPLIED, SetStatus<FLAG_I, true>, Status()(true));
+ S.Test("cld", INS_CLD_IMPL, MODE_IMPLIED, SetStatus<FLAG_D, false>, Status()(true));
+ S.Test("sed", INS_SED_IMPL, MODE_IMPLIED, SetStatus<FLAG_D, true>, Status()(true));
+ S.Test("clv", INS_CLV_IMPL, MODE_IMPLIED, SetStatus<FLAG_V, false>, Status()(true));
+ S.Test("nop", INS_NOP_IMPL, MODE_IMPLIED, Nothing, Status()(true));
+
+ S.Branch("bpl", INS_BPL_REL, FLAG_N, false);
+ S.Branch("bmi", INS_BMI_REL, FLAG_N, true);
+ S.Branch("bvc", INS_BVC_REL, FLAG_V, false);
+ S.Branch("bvs", INS_BVS_REL, FLAG_V, true);
+ S.Branch("bcc", INS_BCC_REL, FLAG_C, false);
+ S.Branch("bcs", INS_BCS_REL, FLAG_C, true);
+ S.Branch("bne", INS_BNE_REL, FLAG_Z, false);
+ S.Branch("beq", INS_BEQ_REL, FLAG_Z, true);
+ S.Jumps();
+ S.Subroutine();
+ S.Interrupts();
+ return Finish(S);
+}
+
+// The stable undocumented NMOS opcodes, for CPU_NMOS_ILLEGAL
+static bool BuildIllegal(Suite& S) {
+ Begin(S);
+ S.Group("slo", COMBINED_MODES(SLO), ShiftOr, Binary(&State::A));
+ S.Group("rla", COMBINED_MODES(RLA), RotateAnd, Binary(&State::A));
+ S.Group("sre", COMBINED_MODES(SRE), ShiftXor, Binary(&State::A));
+ S.Group("rra", COMBINED_MODES(RRA), RotateAdd, Binary(&State::A, 0xFF & ~FLAG_D, true));
+ S.Test("rra bcd", INS_RRA_ZP, MODE_ZEROPAGE, RotateAdd, Decimal()(true));
+ S.Test("rra decimal", INS_RRA_AB, MODE_ABSOLUTE, RotateAdd, DecimalAny()(true));
+ S.Group("dcp", COMBINED_MODES(DCP), DecrementCompare, Binary(&State::A));
+ S.Group("isc", COMBINED_MODES(ISC), IncrementSubtract, Binary(&State::A, 0xFF & ~FLAG_D, true));
+ S.Test("isc bcd", INS_ISC_ZP, MODE_ZEROPAGE, IncrementSubtract, Decimal()(true));
+ S.Test("isc decimal", INS_ISC_AB, MODE_ABSOLUTE, IncrementSubtract, DecimalAny()(true));
+ S.Group("sax", {{INS_SAX_ZP, MODE_ZEROPAGE}, {INS_SAX_ZPY, MODE_ZEROPAGE_Y}, {INS_SAX_AB, MODE_ABSOLUTE}, {INS_SAX_INX, MODE_INDIRECT_X}}, StoreAnd, Binary(&State::A));
+ S.Group("lax", {{INS_LAX_ZP, MODE_ZEROPAGE}, {INS_LAX_ZPY, MODE_ZEROPAGE_Y}, {INS_LAX_AB, MODE_ABSOLUTE}, {INS_LAX_ABY, MODE_ABSOLUTE_Y}, {INS_LAX_INX, MODE_INDIRECT_X}, {INS_LAX_INY, MODE_INDIRECT_Y}}, LoadBoth, Unary(&State::M));
+ S.Group("las", {{INS_LAS_ABY, MODE_ABSOLUTE_Y}}, LoadStack, Unary(&State::M));
+
+ S.Group("anc", {{INS_ANC_IM, MODE_IMMEDIATE}, {INS_ANC_IM_2B, MODE_IMMEDIATE}}, AndCarry, Binary(&State::A));
+ S.Group("alr", {{INS_ALR_IM, MODE_IMMEDIATE}}, AndShift, Binary(&State::A));
+ S.Group("arr", {{INS_ARR_IM, MODE_IMMEDIATE}}, AndRotate, Binary(&State::A, 0xFF & ~FLAG_D, true));
+ S.Test("arr bcd", INS_ARR_IM, MODE_IMMEDIATE, AndRotate, Decimal()(true));
+ S.Test("arr decimal", INS_ARR_IM, MODE_IMMEDIATE, AndRotate, DecimalAny()(true));
+ S.Group("sbx", {{INS_SBX_IM, MODE_IMMEDIATE}}, SubtractX, Binary(&State::X));
+ S.Group("sbc", {{INS_SBC_IM_EB, MODE_IMMEDIATE}}, SubtractM, Binary(&State::A, 0xFF & ~FLAG_D, true));
+ S.Test("sbc decimal", INS_SBC_IM_EB, MODE_IMMEDIATE, SubtractM, DecimalAny()(true));
+
+ for (Byte Opcode : {INS_NOP_IMPL_1A, INS_NOP_IMPL_3A, INS_NOP_IMPL_5A, INS_NOP_IMPL_7A, INS_NOP_IMPL_DA, INS_NOP_IMPL_FA})
+  S.Test("nop", Opcode, MODE_IMPLIED, Nothing, Status()(true));
+ for (Byte Opcode : {INS_NOP_IM_80, INS_NOP_IM_82, INS_NOP_IM_89, INS_NOP_IM_C2, INS_NOP_IM_E2})
+  S.Test("nop", Opcode, MODE_IMMEDIATE, Nothing, Status()(true));
+ for (Byte Opcode : {INS_NOP_ZP_04, INS_NOP_ZP_44, INS_NOP_ZP_64})
+  S.Test("nop", Opcode, MODE_ZEROPAGE, Nothing, Status()(true));
+ for (Byte Opcode : {INS_NOP_ZPX_14, INS_NOP_ZPX_34, INS_NOP_ZPX_54, INS_NOP_ZPX_74, INS_NOP_ZPX_D4, INS_NOP_ZPX_F4})
+  S.Test("nop", Opcode, MODE_ZEROPAGE_X, Nothing, Status()(true));
+ S.Test("nop", INS_NOP_AB_0C, MODE_ABSOLUTE, Nothing, Status()(true));
+ for (Byte Opcode : {INS_NOP_ABX_1C, INS_NOP_ABX_3C, INS_NOP_ABX_5C, INS_NOP_ABX_7C, INS_NOP_ABX_DC, INS_NOP_ABX_FC})
+  S.Test("nop", Opcode, MODE_ABSOLUTE_X, Nothing, Status()(true));
+ return Finish(S);
+}
+
+//
+// Decimal mode test, Bruce Clark's program from "Decimal Mode" (6502.org
+// tutorials), appendix B, with his 6502 and 65C02 predictors
+//
+
+// Zero page of the decimal test
+enum {
+ DZ_N1    = 0x00,
+ DZ_N2    = 0x01,
+ DZ_HA    = 0x02,  // Binary result and flags
+ DZ_HNVZC = 0x03,
+ DZ_DA    = 0x04,  // Decimal result and flags
+ DZ_DNVZC = 0x05,
+ DZ_AR    = 0x06,  // Predicted result and flags
+ DZ_NF    = 0x07,
+ DZ_VF    = 0x08,
+ DZ_ZF    = 0x09,
+ DZ_CF    = 0x0A,
+ DZ_ERROR = DECIMAL_ERROR,
+ DZ_N1L   = 0x0C,
+ DZ_N1H   = 0x0D,
+ DZ_N2L   = 0x0E,
+ DZ_N2H   = 0x0F,  // Two bytes
+};
+
+// A and P of N1 op N2 in decimal, then in binary mode
+static void DecimalOperation(Assembler& Asm, Byte Opcode) {
+ Asm.Op(INS_SED_IMPL);
+ Asm.Op(INS_CPY_IM, 1);
+ Asm.Op(INS_LDA_ZP, DZ_N1);
+ Asm.Op(Opcode, DZ_N2);
+ Asm.Op(INS_STA_ZP, DZ_DA);
+ Asm.Op(INS_PHP_IMPL);
+ Asm.Op(INS_PLA_IMPL);
+ Asm.Op(INS_STA_ZP, DZ_DNVZC);
+ Asm.Op(INS_CLD_IMPL);
+ Asm.Op(INS_CPY_IM, 1);
+ Asm.Op(INS_LDA_ZP, DZ_N1);
+ Asm.Op(Opcode, DZ_N2);
+ Asm.Op(INS_STA_ZP, DZ_HA);
+ Asm.Op(INS_PHP_IMPL);
+ Asm.Op(INS_PLA_IMPL);
+ Asm.Op(INS_STA_ZP, DZ_HNVZC);
+}
+
+static bool BuildDecimal(Assembler& Asm, bool CMOS) {
+ Asm.Org(DECIMAL_CODE);
+ Asm.OpLabel(INS_JSR_AB, "test");
+ Asm.Label("done");
+ Asm.OpLabel(INS_JMP_AB, "done");
+
+ // Y is the carry, N1 and N2 run through every value
+ Asm.Label("test");
+ Asm.Op(INS_LDY_IM, 1);
+ Asm.Op(INS_STY_ZP, DZ_ERROR);
+ Asm.Op(INS_LDA_IM, 0);
+ Asm.Op(INS_STA_ZP, DZ_N1);
+ Asm.Op(INS_STA_ZP, DZ_N2);
+ Asm.Label("loop1");
+ Asm.Op(INS_LDA_ZP, DZ_N2);
+ Asm.Op(INS_AND_IM, 0x0F);
+ Asm.Op(INS_STA_ZP, DZ_N2L);
+ Asm.Op(INS_LDA_ZP, DZ_N2);
+ Asm.Op(INS_AND_IM, 0xF0);
+ Asm.Op(INS_STA_ZP, DZ_N2H);
+ Asm.Op(INS_ORA_IM, 0x0F);
+ Asm.Op(INS_STA_ZP, DZ_N2H + 1);
+ Asm.Label("loop2");
+ Asm.Op(INS_LDA_ZP, DZ_N1);
+ Asm.Op(INS_AND_IM, 0x0F);
+ Asm.Op(INS_STA_ZP, DZ_N1L);
+ Asm.Op(INS_LDA_ZP, DZ_N1);
+ Asm.Op(INS_AND_IM, 0xF0);
+ Asm.Op(INS_STA_ZP, DZ_N1H);
+ Asm.OpLabel(INS_JSR_AB, "add");
+ Asm.OpLabel(INS_JSR_AB, CMOS ? "a65c02" : "a6502");
+ Asm.OpLabel(INS_JSR_AB, "compare");
+ Asm.Branch(INS_BNE_REL, "return");
+ Asm.OpLabel(INS_JSR_AB, "sub");
+ Asm.OpLabel(INS_JSR_AB, CMOS ? "s65c02" : "s6502");
+ Asm.OpLabel(INS_JSR_AB, "compare");
+ Asm.Branch(INS_BNE_REL, "return");
+ Asm.Op(INS_INC_ZP, DZ_N1);
+ Asm.Branch(INS_BNE_REL, "loop2");
+ Asm.Op(INS_INC_ZP, DZ_N2);
+ Asm.Branch(INS_BNE_REL, "loop1");
+ Asm.Op(INS_DEY_IMPL);
+ Asm.Branch(INS_BPL_REL, "loop1");
+ Asm.Op(INS_LDA_IM, 0);
+ Asm.Op(INS_STA_ZP, DZ_ERROR);
+ Asm.Label("return");
+ Asm.Op(INS_RTS_IMPL);
+
+ // Predicted A, C and V of ADC (all of P in VF, so N too)
+ Asm.Label("add");
+ DecimalOperation(Asm, INS_ADC_ZP);
+ Asm.Op(INS_CPY_IM, 1);
+ Asm.Op(INS_LDA_ZP, DZ_N1L);
+ Asm.Op(INS_ADC_ZP, DZ_N2L);
+ Asm.Op(INS_CMP_IM, 0x0A);
+ Asm.Op(INS_LDX_IM, 0);
+ Asm.Branch(INS_BCC_REL, "a1");
+ Asm.Op(INS_INX_IMPL);
+ Asm.Op(INS_ADC_IM, 0x05);
+ Asm.Op(INS_AND_IM, 0x0F);
+ Asm.Op(INS_SEC_IMPL);
+ Asm.Label("a1");
+ Asm.Op(INS_ORA_ZP, DZ_N1H);
+ Asm.Op(INS_ADC_ZPX, DZ_N2H);
+ Asm.Op(INS_PHP_IMPL);
+ Asm.Branch(INS_BCS_REL, "a2");
+ Asm.Op(INS_CMP_IM, 0xA0);
+ Asm.Branch(INS_BCC_REL, "a3");
+ Asm.Label("a2");
+ Asm.Op(INS_ADC_IM, 0x5F);
+ Asm.Op(INS_SEC_IMPL);
+ Asm.Label("a3");
+ Asm.Op(INS_STA_ZP, DZ_AR);
+ Asm.Op(INS_PHP_IMPL);
+ Asm.Op(INS_PLA_IMPL);
+ Asm.Op(INS_STA_ZP, DZ_CF);
+ Asm.Op(INS_PLA_IMPL);
+ Asm.Op(INS_STA_ZP, DZ_VF);
+ Asm.Op(INS_RTS_IMPL);
+
+ Asm.Label("sub");
+ DecimalOperation(Asm, INS_SBC_ZP);
+ Asm.Op(INS_RTS_IMPL);
+
+ // Predicted A of SBC. The NMOS part adjusts the low nibble, the 65C02
+ // the whole byte once more at the end
+ Asm.Label("predict_sbc");
+ Asm.Op(INS_CPY_IM, 1);
+ Asm.Op(INS_LDA_ZP, DZ_N1L);
+ Asm.Op(INS_SBC_ZP, DZ_N2L);
+ Asm.Op(INS_LDX_IM, 0);
+ Asm.Branch(INS_BCS_REL, "s1");
+ Asm.Op(INS_INX_IMPL);
+ if (!CMOS) Asm.Op(INS_SBC_IM, 0x05);
+ Asm.Op(INS_AND_IM, 0x0F);
+ Asm.Op(INS_CLC_IMPL);
+ Asm.Label("s1");
+ Asm.Op(INS_ORA_ZP, DZ_N1H);
+ Asm.Op(INS_SBC_ZPX, DZ_N2H);
+ Asm.Branch(INS_BCS_REL, "s2");
+ Asm.Op(INS_SBC_IM, 0x5F);
+ Asm.Label("s2");
+ if (CMOS) {
+  Asm.Op(INS_CPX_IM, 0);
+  Asm.Branch(INS_BEQ_REL, "s3");
+  Asm.Op(INS_SBC_IM, 0x06);
+  Asm.Label("s3");
+ }
+ Asm.Op(INS_STA_ZP, DZ_AR);
+ Asm.Op(INS_RTS_IMPL);
+
+ // Z of the actual result against each predicted flag
+ Asm.Label("compare");
+ Asm.Op(INS_LDA_ZP, DZ_DA);
+ Asm.Op(INS_CMP_ZP, DZ_AR);
+ Asm.Branch(INS_BNE_REL, "c1");
+ for (auto Flag : {std::make_pair(DZ_NF, FLAG_N), std::make_pair(DZ_VF, FLAG_V), std::make_pair(DZ_ZF, FLAG_Z), std::make_pair(DZ_CF, FLAG_C)}) {
+  Asm.Op(INS_LDA_ZP, DZ_DNVZC);
+  Asm.Op(INS_EOR_ZP, Flag.first);
+  Asm.Op(INS_AND_IM, Flag.second);
+  if (Flag.second != FLAG_C) Asm.Branch(INS_BNE_REL, "c1");
+ }
+ Asm.Label("c1");
+ Asm.Op(INS_RTS_IMPL);
+
+ // NMOS: N and V from the intermediate sum, Z from the binary result,
+ // every SBC flag from the binary result
+ Asm.Label("a6502");
+ Asm.Op(INS_LDA_ZP, DZ_VF);
+ Asm.Op(INS_STA_ZP, DZ_NF);
+ Asm.Op(INS_LDA_ZP, DZ_HNVZC);
+ Asm.Op(INS_STA_ZP, DZ_ZF);
+ Asm.Op(INS_RTS_IMPL);
+
+ Asm.Label("s6502");
+ Asm.OpLabel(INS_JSR_AB, "predict_sbc");
+ Asm.Op(INS_LDA_ZP, DZ_HNVZC);
+ Asm.Op(INS_STA_ZP, DZ_NF);
+ Asm.Op(INS_STA_ZP, DZ_VF);
+ Asm.Op(INS_STA_ZP, DZ_ZF);
+ Asm.Op(INS_STA_ZP, DZ_CF);
+ Asm.Op(INS_RTS_IMPL);
+
+ // 65C02: N and Z from the decimal result
+ Asm.Label("a65c02");
+ Asm.Op(INS_LDA_ZP, DZ_AR);
+ Asm.Op(INS_PHP_IMPL);
+ Asm.Op(INS_PLA_IMPL);
+ Asm.Op(INS_STA_ZP, DZ_NF);
+ Asm.Op(INS_STA_ZP, DZ_ZF);
+ Asm.Op(INS_RTS_IMPL);
+
+ Asm.Label("s65c02");
+ Asm.OpLabel(INS_JSR_AB, "predict_sbc");
+ Asm.Op(INS_LDA_ZP, DZ_AR);
+ Asm.Op(INS_PHP_IMPL);
+ Asm.Op(INS_PLA_IMPL);
+ Asm.Op(INS_STA_ZP, DZ_NF);
+ Asm.Op(INS_STA_ZP, DZ_ZF);
+ Asm.Op(INS_LDA_ZP, DZ_HNVZC);
+ Asm.Op(INS_STA_ZP, DZ_VF);
+ Asm.Op(INS_STA_ZP, DZ_CF);
+ Asm.Op(INS_RTS_IMPL);
+
+ return Asm.Link();
+}
+
+int main(int argc, char** argv) {
+ if (argc != 2) {
+  printf("Usage: mkroms <directory>\n");
+  return 2;
+ }
+ std::string Directory = argv[1];
+
+ Suite Instructions, Illegal;
+ if (!BuildInstructions(Instructions) || !Instructions.Save(Directory, "instructions")) return 1;
+ if (!BuildIllegal(Illegal) || !Illegal.Save(Directory, "illegal")) return 1;
+
+ Assembler Nmos, Cmos;
+ if (!BuildDecimal(Nmos, false) || !Nmos.Save(Directory + "/decimal.bin")) return 1;
+ if (!BuildDecimal(Cmos, true) || !Cmos.Save(Directory + "/decimal_65c02.bin")) return 1;
+ return 0;
+}
@@ -0,0 +1,142 @@
+#include "block_device.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "common.h"
+
+BlockDevice::BlockDevice(Word Base, Memory& mem, Scheduler& sched, InterruptLines& lines, uint64_t sectorCycles) : MemoryDevice(Base, Base + BLOCK_SIZE - 1), Mem(mem), Sched(sched), Lines(lines), SectorCycles(sectorCycles) {
+ IRQSource     = Lines.AllocateIRQ();
+ CompleteEvent = Sched.Register([this](uint64_t) { Complete(); });
+}
+
+BlockDevice::~BlockDevice() {
+ if (Fd >= 0) close(Fd);
+}
+
+bool BlockDevice::Open(const std::string& Path) {
+ Fd = open(Path.c_str(), O_RDWR);
+ if (Fd < 0) Fd = open(Path.c_str(), O_RDONLY);
+ if (Fd < 0) {
+  perror(Path.c_str());
+  return false;
+ }
+ return true;
+}
+
+Byte BlockDevice::Read(Word Addr) {
+ switch (Addr - Begin) {
+ case BLOCK_COMMAND: {
+  Byte Value = Status;
+  Status &= ~BLOCK_STATUS_DONE;
+  Lines.ReleaseIRQ(IRQSource);
+  return Value;
+ }
+ case BLOCK_SECTOR_LO:
+  return Sector & 0xFF;
+ case BLOCK_SECTOR_HI:
+  return Sector >> 8;
+ case BLOCK_ADDR_LO:
+  return Address & 0xFF;
+ case BLOCK_ADDR_HI:
+  return Address >> 8;
+ case BLOCK_COUNT:
+  return Count;
+ case BLOCK_CONTROL:
+  return Control;
+ }
+ return 0;
+}
+
+void BlockDevice::Write(Word Addr, Byte Value) {
+ switch (Addr - Begin) {
+ case BLOCK_COMMAND:
+  Start(Value);
+  break;
+ case BLOCK_SECTOR_LO:
+  Sector = (Sector & 0xFF00) | Value;
+  break;
+ case BLOCK_SECTOR_HI:
+  Sector = (Sector & 0x00FF) | (Value << 8);
+  break;
+ case BLOCK_ADDR_LO:
+  Address = (Address & 0xFF00) | Value;
+  break;
+ case BLOCK_ADDR_HI:
+  Address = (Address & 0x00FF) | (Value << 8);
+  break;
+ case BLOCK_COUNT:
+  Count = Value;
+  break;
+ case BLOCK_CONTROL:
+  Control = Value;
+  break;
+ }
+}
+
+void BlockDevice::Start(Byte Cmd) {
+ if (Status & BLOCK_STATUS_BUSY) return;
+
+ uint32_t Sectors = Count ? Count : 256;
+ Command          = Cmd;
+ Status           = BLOCK_STATUS_BUSY;
+ ActiveSector     = Sector;
+ ActiveAddress    = Address;
+ // Clip at the top of the address space rather than wrapping
+ ActiveLength = std::min<uint32_t>(Sectors * BLOCK_SECTOR_SIZE, MAX_MEM - Address);
+ Lines.ReleaseIRQ(IRQSource);
+ Sched.ScheduleIn(CompleteEvent, BLOCK_COMMAND_CYCLES + Sectors * SectorCycles);
+}
+
+// Length of the run of whole or part pages from Address that all have one of
+// the Trap bits set, or all have none, up to End. Trapped says which
+static uint32_t TrapRun(const Memory& mem, uint32_t Address, uint32_t End, Byte Trap, bool& Trapped) {
+ Trapped       = mem.PageTraps[Address >> 8] & Trap;
+ uint32_t Next = (Address & ~(PAGE_SIZE - 1)) + PAGE_SIZE;
+ while (Next < End && ((mem.PageTraps[Next >> 8] & Trap) != 0) == Trapped) Next += PAGE_SIZE;
+ return std::min(Next, End) - Address;
+}
+
+// Pages nobody watches take the pread/pwrite straight to or from Data, the
+// ones with watchpoints, devices or the heat map go byte by byte over the bus
+void BlockDevice::Complete() {
+ off_t Offset = (off_t)ActiveSector * BLOCK_SECTOR_SIZE;
+ uint32_t End = ActiveAddress + ActiveLength;
+ bool Ok      = Fd >= 0 && (Command == BLOCK_CMD_READ || Command == BLOCK_CMD_WRITE);
+ bool Trapped;
+
+ for (uint32_t At = ActiveAddress, Length; Ok && At < End; At += Length) {
+  off_t Position = Offset + (At - ActiveAddress);
+  if (Command == BLOCK_CMD_READ) {
+   Length     = TrapRun(Mem, At, End, TRAP_WRITE, Trapped);
+   Byte* Into = Mem.Data + At;
+   if (Trapped) {
+    Buffer.resize(Length);
+    Into = Buffer.data();
+   }
+   ssize_t Got = pread(Fd, Into, Length, Position);
+   Ok          = Got >= 0;
+   if (!Ok) break;
+   // Past the end of the image reads as zeros
+   memset(Into + Got, 0, Length - Got);
+   if (Trapped)
+    for (uint32_t i = 0; i < Length; i++) Mem.Write(At + i, Buffer[i]);
+  } else {
+   Length     = TrapRun(Mem, At, End, TRAP_READ, Trapped);
+   Byte* From = Mem.Data + At;
+   if (Trapped) {
+    Buffer.resize(Length);
+    for (uint32_t i = 0; i < Length; i++) Buffer[i] = Mem.Read(At + i);
+    From = Buffer.data();
+   }
+   Ok = pwrite(Fd, From, Length, Position) == (ssize_t)Length;
+  }
+ }
+ if (Command == BLOCK_CMD_READ) Mem.Invalidate(ActiveAddress, ActiveLength);
+
+ Status = BLOCK_STATUS_DONE | (Ok ? 0 : BLOCK_STATUS_ERROR);
+ if (Control & BLOCK_CONTROL_IRQ) Lines.AssertIRQ(IRQSource);
+}
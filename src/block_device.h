@@ -0,0 +1,88 @@
+#ifndef _BLOCK_DEVICE_H_
+#define _BLOCK_DEVICE_H_
+
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+#include "common.h"
+#include "device.h"
+#include "interrupt.h"
+#include "memory.h"
+#include "scheduler.h"
+
+// Register layout relative to the base address
+enum {
+ BLOCK_COMMAND   = 0x0,  // W: BLOCK_CMD_*, R: BLOCK_STATUS_* (clears DONE and the IRQ)
+ BLOCK_SECTOR_LO = 0x1,
+ BLOCK_SECTOR_HI = 0x2,
+ BLOCK_ADDR_LO   = 0x3,
+ BLOCK_ADDR_HI   = 0x4,
+ BLOCK_COUNT     = 0x5,  // Sectors per transfer, 0 means 256
+ BLOCK_CONTROL   = 0x6,  // BLOCK_CONTROL_* bits
+ BLOCK_SIZE      = 0x8,
+};
+
+enum {
+ BLOCK_CMD_READ  = 0x01,  // Image -> memory
+ BLOCK_CMD_WRITE = 0x02,  // Memory -> image
+};
+
+enum {
+ BLOCK_STATUS_BUSY  = 0x01,
+ BLOCK_STATUS_ERROR = 0x02,
+ BLOCK_STATUS_DONE  = 0x80,
+};
+
+enum {
+ BLOCK_CONTROL_IRQ = 0x01,  // Raise IRQ on completion
+};
+
+constexpr uint32_t BLOCK_SECTOR_SIZE           = 256;
+constexpr uint64_t BLOCK_COMMAND_CYCLES        = 64;  // Fixed cost of every request
+constexpr uint64_t BLOCK_DEFAULT_SECTOR_CYCLES = 512;
+
+// Disk with a DMA style interface: the program sets sector, address and count
+// and writes a command, which latches them. When the charged cycles have
+// passed the transfer is done with pread/pwrite, straight into or out of Data
+// for pages with no trap bits and through the memory bus for the others, so
+// devices, watchpoints and the heat map still see their bytes. Then DONE is
+// set and the IRQ raised. Transfers stop at $FFFF instead of wrapping
+struct BlockDevice : MemoryDevice {
+ Memory& Mem;
+ Scheduler& Sched;
+ InterruptLines& Lines;
+ Byte IRQSource;
+ uint32_t CompleteEvent;
+
+ int Fd = -1;
+ uint64_t SectorCycles;
+
+ Word Sector  = 0;
+ Word Address = 0;
+ Byte Count   = 1;
+ Byte Control = 0;
+ Byte Status  = 0;
+ Byte Command = 0;
+
+ // Registers as they were when the command was written, the program may
+ // change them while the transfer is in flight
+ Word ActiveSector     = 0;
+ Word ActiveAddress    = 0;
+ uint32_t ActiveLength = 0;
+ std::vector<Byte> Buffer;
+
+ BlockDevice(Word Base, Memory& mem, Scheduler& sched, InterruptLines& lines, uint64_t sectorCycles = BLOCK_DEFAULT_SECTOR_CYCLES);
+ ~BlockDevice();
+
+ bool Open(const std::string& Path);
+
+ Byte Read(Word Address) override;
+ void Write(Word Address, Byte Value) override;
+
+ void Start(Byte Cmd);
+ void Complete();
+};
+
+#endif
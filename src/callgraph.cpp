@@ -0,0 +1,108 @@
+#include "callgraph.h"
+
+#include <algorithm>
+#include <map>
+
+#include "common.h"
+
+void CallGraph::Start(uint64_t Now, Word Entry) {
+ Nodes.assign(1, Node{Entry, 0, 0, 1, {}});
+ Stack.clear();
+ Current = 0;
+ Last    = Now;
+}
+
+// Drops frames the real stack no longer holds
+size_t CallGraph::Unwind(Byte StackPointer) {
+ size_t Popped = 0;
+ while (!Stack.empty() && Stack.back().StackPointer <= StackPointer) {
+  Stack.pop_back();
+  Popped++;
+ }
+ Current = Stack.empty() ? 0 : Stack.back().Node;
+ return Popped;
+}
+
+// StackPointer is the SP from before the return address was pushed
+void CallGraph::Call(uint64_t Now, Word Target, Byte StackPointer) {
+ Charge(Now);
+ Unbalanced += Unwind(StackPointer);
+
+ auto It = Nodes[Current].Children.find(Target);
+ uint32_t Child;
+ if (It != Nodes[Current].Children.end()) {
+  Child = It->second;
+ } else {
+  Child = Nodes.size();
+  Nodes[Current].Children[Target] = Child;
+  Nodes.push_back(Node{Target, Current, 0, 0, {}});
+ }
+ Nodes[Child].Calls++;
+
+ Stack.push_back({Child, StackPointer});
+ Current = Child;
+}
+
+// StackPointer is the SP after the return address was pulled
+void CallGraph::Return(uint64_t Now, Byte StackPointer) {
+ Charge(Now);
+ size_t Popped = Unwind(StackPointer);
+ if (Popped != 1) Unbalanced += Popped ? Popped - 1 : 1;
+}
+
+bool CallGraph::WriteCollapsed(const std::string& Path, const SymbolTable& Symbols) const {
+ FILE* File = fopen(Path.c_str(), "w");
+ if (!File) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ std::vector<std::string> Paths(Nodes.size());
+ for (uint32_t i = 0; i < Nodes.size(); i++) {
+  std::string Name = Symbols.Name(Nodes[i].Routine);
+  Paths[i]         = i ? Paths[Nodes[i].Parent] + ";" + Name : Name;
+  if (Nodes[i].Self) fprintf(File, "%s %llu\n", Paths[i].c_str(), (unsigned long long)Nodes[i].Self);
+ }
+ fclose(File);
+ return true;
+}
+
+void CallGraph::Report(FILE* File, const SymbolTable& Symbols) const {
+ struct Totals {
+  uint64_t Inclusive;
+  uint64_t Exclusive;
+  uint64_t Calls;
+ };
+
+ // Children follow their parents, so one backwards pass sums the subtrees
+ std::vector<uint64_t> Inclusive(Nodes.size());
+ for (uint32_t i = Nodes.size(); i-- > 0;) {
+  Inclusive[i] += Nodes[i].Self;
+  if (i) Inclusive[Nodes[i].Parent] += Inclusive[i];
+ }
+
+ // A recursive routine's inner calls are already inside its outer one
+ std::map<Word, Totals> Routines;
+ for (uint32_t i = 0; i < Nodes.size(); i++) {
+  Totals& Entry = Routines[Nodes[i].Routine];
+  Entry.Exclusive += Nodes[i].Self;
+  Entry.Calls += Nodes[i].Calls;
+
+  bool Nested = false;
+  for (uint32_t Up = i; Up && !Nested;) {
+   Up     = Nodes[Up].Parent;
+   Nested = Nodes[Up].Routine == Nodes[i].Routine;
+  }
+  if (!Nested) Entry.Inclusive += Inclusive[i];
+ }
+
+ std::vector<std::pair<Word, Totals>> Sorted(Routines.begin(), Routines.end());
+ std::sort(Sorted.begin(), Sorted.end(), [](const auto& a, const auto& b) { return a.second.Inclusive > b.second.Inclusive; });
+
+ fprintf(File, "Cycles: %llu, call paths: %zu, unbalanced: %llu\n", (unsigned long long)Inclusive[0], Nodes.size(), (unsigned long long)Unbalanced);
+ fprintf(File, "%-32s %10s %14s %8s %14s %8s\n", "Routine", "Calls", "Inclusive", "%", "Exclusive", "%");
+ for (const auto& Entry : Sorted) {
+  const Totals& Total = Entry.second;
+  fprintf(File, "%-32s %10llu %14llu %7.2f%% %14llu %7.2f%%\n", Symbols.Name(Entry.first).c_str(), (unsigned long long)Total.Calls, (unsigned long long)Total.Inclusive, 100.0 * Total.Inclusive / Inclusive[0], (unsigned long long)Total.Exclusive, 100.0 * Total.Exclusive / Inclusive[0]);
+ }
+}
@@ -0,0 +1,60 @@
+#ifndef _CALLGRAPH_H_
+#define _CALLGRAPH_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+
+#include "common.h"
+#include "symbols.h"
+
+// Shadow call stack fed by JSR/BRK/interrupts and RTS/RTI, building a call
+// tree with the cycles spent in each node. Cycles are charged to the top of
+// the stack whenever it changes, so nothing runs between those events.
+//
+// Frames remember the SP from before their return address was pushed. A
+// return pops every frame whose SP the real stack has unwound past, so
+// return addresses dropped with PLA, stacks reset with TXS and RTS used as
+// a computed jump do not leave the shadow stack out of step for long
+struct CallGraph {
+ struct Node {
+  Word Routine;
+  uint32_t Parent;
+  uint64_t Self;  // Exclusive cycles
+  uint64_t Calls;
+  std::unordered_map<Word, uint32_t> Children;
+ };
+
+ struct Frame {
+  uint32_t Node;
+  Byte StackPointer;
+ };
+
+ std::vector<Node> Nodes;  // Nodes[0] is the entry point, children always follow their parent
+ std::vector<Frame> Stack;
+ uint32_t Current = 0;
+ uint64_t Last    = 0;
+
+ uint64_t Unbalanced = 0;  // Frames popped without a matching return, returns without a frame
+
+ void Start(uint64_t Now, Word Entry);
+ void Call(uint64_t Now, Word Target, Byte StackPointer);
+ void Return(uint64_t Now, Byte StackPointer);
+ void Finish(uint64_t Now) { Charge(Now); }
+
+ void Charge(uint64_t Now) {
+  Nodes[Current].Self += Now - Last;
+  Last = Now;
+ }
+ size_t Unwind(Byte StackPointer);
+
+ // One "outer;inner;leaf cycles" line per call path, for flamegraph.pl
+ bool WriteCollapsed(const std::string& Path, const SymbolTable& Symbols) const;
+ // Inclusive and exclusive cycles per routine
+ void Report(FILE* File, const SymbolTable& Symbols) const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define _COMMON_H_
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
 typedef char SignByte;
@@ -12,5 +13,32 @@ extern uint32_t tickSpeed;
 extern uint32_t startPC;
 extern int32_t workCycles;
 extern std::string binPath;
+extern std::vector<std::string> watchSpecs;
+extern std::string shmName;
+extern int32_t consoleAddress;
+extern std::string consolePath;
+extern int32_t viaAddress;
+extern int32_t framebufferAddress;
+extern std::vector<uint64_t> dumpCycles;
+extern int32_t blockAddress;
+extern std::string blockPath;
+extern uint64_t blockSectorCycles;
+extern std::string tracePath;
+extern std::string tracePolicy;
+extern std::string profilePath;
+extern uint64_t sampleInterval;
+extern std::string symbolPath;
+extern std::string callGraphPath;
+extern std::string heatMapPath;
+extern uint32_t heatMapBucket;
+extern std::string engineName;
+extern uint64_t diffCheckpoint;
+extern std::string cpuVariant;
+extern std::string illegalPolicy;
+extern std::string busAccuracy;
+extern std::string monitorPath;
+extern std::vector<std::string> coreSpecs;
+extern std::vector<std::string> sharedSpecs;
+extern std::string multiMode;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "console.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "common.h"
+
+ConsoleDevice::ConsoleDevice(Word Base, Scheduler& sched, FILE* Out) : MemoryDevice(Base, Base + CONSOLE_SIZE - 1), Sched(sched), Output(Out) {
+ FlushEvent = Sched.Register([this](uint64_t) { Flush(); });
+}
+
+ConsoleDevice::~ConsoleDevice() { Flush(); }
+
+Byte ConsoleDevice::Read(Word Address) {
+ switch (Address - Begin) {
+ case CONSOLE_DATA:
+  if (InHead == InLength && !PollInput()) return 0;
+  return InBuffer[InHead++];
+ case CONSOLE_STATUS:
+  if (InHead == InLength && !PollInput()) return CONSOLE_STATUS_READY;
+  return CONSOLE_STATUS_READY | CONSOLE_STATUS_INPUT;
+ }
+ return 0;
+}
+
+void ConsoleDevice::Write(Word Address, Byte Value) {
+ if (Address - Begin != CONSOLE_DATA) return;
+
+ OutBuffer[OutLength++] = Value;
+ if (OutLength == CONSOLE_BUFFER_SIZE)
+  Flush();
+ else if (!Sched.Armed(FlushEvent))
+  Sched.ScheduleIn(FlushEvent, CONSOLE_FLUSH_CYCLES);
+}
+
+void ConsoleDevice::Flush() {
+ Sched.Cancel(FlushEvent);
+ if (!OutLength) return;
+ fwrite(OutBuffer, 1, OutLength, Output);
+ fflush(Output);
+ OutLength = 0;
+}
+
+// Refills InBuffer from stdin without blocking
+bool ConsoleDevice::PollInput() {
+ uint64_t Now = Sched.Now();
+ if (InputEOF || Now < NextPoll) return false;
+ NextPoll = Now + CONSOLE_POLL_CYCLES;
+
+ struct pollfd Poll = {STDIN_FILENO, POLLIN, 0};
+ if (poll(&Poll, 1, 0) <= 0 || !(Poll.revents & (POLLIN | POLLHUP))) return false;
+
+ ssize_t Length = read(STDIN_FILENO, InBuffer, CONSOLE_BUFFER_SIZE);
+ if (Length <= 0) {
+  InputEOF = true;
+  return false;
+ }
+ InHead   = 0;
+ InLength = Length;
+ return true;
+}
@@ -0,0 +1,52 @@
+#ifndef _CONSOLE_H_
+#define _CONSOLE_H_
+
+#include <cstdio>
+
+#include "common.h"
+#include "device.h"
+#include "scheduler.h"
+
+// Register layout relative to the base address
+enum {
+ CONSOLE_DATA   = 0x00,  // W: output byte, R: next input byte (0 if none)
+ CONSOLE_STATUS = 0x01,  // R: CONSOLE_STATUS_* bits
+ CONSOLE_SIZE   = 0x02,
+};
+
+enum {
+ CONSOLE_STATUS_INPUT = 0x01,  // An input byte is waiting
+ CONSOLE_STATUS_READY = 0x80,  // Output can take a byte, always set
+};
+
+constexpr size_t CONSOLE_BUFFER_SIZE = 4096;
+// Pending output is written out at most this many cycles after the first byte
+constexpr uint64_t CONSOLE_FLUSH_CYCLES = 100000;
+// Minimum cycles between stdin polls, keeps busy-wait loops off the syscall path
+constexpr uint64_t CONSOLE_POLL_CYCLES = 1000;
+
+struct ConsoleDevice : MemoryDevice {
+ Scheduler& Sched;
+ uint32_t FlushEvent;
+
+ FILE* Output;
+ char OutBuffer[CONSOLE_BUFFER_SIZE];
+ size_t OutLength = 0;
+
+ char InBuffer[CONSOLE_BUFFER_SIZE];
+ size_t InHead   = 0;
+ size_t InLength = 0;
+ bool InputEOF   = false;
+ uint64_t NextPoll = 0;
+
+ ConsoleDevice(Word Base, Scheduler& sched, FILE* Out = stdout);
+ ~ConsoleDevice();
+
+ Byte Read(Word Address) override;
+ void Write(Word Address, Byte Value) override;
+
+ void Flush();
+ bool PollInput();
+};
+
+#endif
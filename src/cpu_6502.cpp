@@ -1,1110 +1,289 @@
 #include "cpu_6502.h"
-#include <chrono>
-#include <thread>
 
-int32_t CPU_6502::Execute(int32_t workCycles, Memory& memory) {
- Cycles = workCycles;
- printf("PC: %04x A: %02x X: %02x Y: %02x ", PC, A, X, Y);
- while (Cycles > 0) {
-  Byte Ins = FetchByte(memory);
-  switch (Ins) {
-  // Cycles: 1
-  case INS_ADC_IM: {
-   Byte Value = FetchByte(memory);
-   ADC(Value);
-   printf("Handled INS_ADC_IM\n");
-  } break;
-
-  // Cycles: 2
-  case INS_ADC_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ADC(Value);
-   printf("Handled INS_ADC_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_ADC_ZPX: {
-   Word Address = FetchZPAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   ADC(Value);
-   printf("Handled INS_ADC_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_ADC_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ADC(Value);
-   printf("Handled INS_ADC_AB\n");
-  } break;
-
-  // Cycles: 3 (+1 on crossing page)
-  case INS_ADC_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   ADC(Value);
-   printf("Handled INS_ADC_ABX\n");
-  } break;
-
-  // Cycles: 3 (+1 if crossing page)
-  case INS_ADC_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   Byte Value   = ReadByte(memory, Address);
-   ADC(Value);
-   printf("Handled INS_ADC_ABY\n");
-  } break;
-
-  // Cycles: 5
-  case INS_ADC_INX: {
-   Word Address = FetchINAddressX(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ADC(Value);
-   printf("Handled INS_ADC_INX\n");
-  } break;
-
-  // Cycles: 4 (+1 if crossing page)
-  case INS_ADC_INY: {
-   Word Address = FetchINAddressY(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ADC(Value);
-   printf("Handled INS_ADC_INY\n");
-  } break;
-
-  // Cycles: 1
-  case INS_AND_IM: {
-   Byte Operand = FetchByte(memory);
-   AND(Operand);
-   printf("Handled INS_AND_IM\n");
-  } break;
-
-  // Cycles: 2
-  case INS_AND_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Operand = ReadByte(memory, Address);
-   AND(Operand);
-   printf("Handled INS_AND_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_AND_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Operand = ReadByte(memory, Address);
-   AND(Operand);
-   printf("Handled INS_AND_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_AND_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Operand = ReadByte(memory, Address);
-   AND(Operand);
-   printf("Handled INS_AND_AB\n");
-  } break;
-
-  // Cycles: 3 (+1 if crossing page)
-  case INS_AND_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Operand = ReadByte(memory, Address);
-   AND(Operand);
-   printf("Handled INS_AND_ABX\n");
-  } break;
-
-  // Cycles: 3 (+1 if crossing page)
-  case INS_AND_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   Byte Operand = ReadByte(memory, Address);
-   AND(Operand);
-   printf("Handled INS_AND_ABY\n");
-  } break;
-
-  // Cycles: 5
-  case INS_AND_INX: {
-   Word Address = FetchINAddressX(memory);
-   Byte Operand = ReadByte(memory, Address);
-   AND(Operand);
-   printf("Handled INS_AND_INX\n");
-  } break;
-
-  // Cycles: 4 (+1 if crossing page)
-  case INS_AND_INY: {
-   Word Address = FetchINAddressY(memory);
-   Byte Operand = ReadByte(memory, Address);
-   AND(Operand);
-   printf("Handled INS_AND_INY\n");
-  } break;
-
-  // Cycles: 1
-  case INS_ASL_A: {
-   A = ASL(A);
-   printf("Handled INS_ASL_A\n");
-  } break;
-
-  // Cycles: 4
-  case INS_ASL_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value = ASL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ASL_ZP\n");
-  } break;
-
-  // Cycles: 5 (+1 if crossed page)
-  case INS_ASL_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value = ASL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ASL_ZP\n");
-  } break;
-
-  // Cycles: 5
-  case INS_ASL_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value = ASL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ASL_AB\n");
-  } break;
-
-  // Cycles: 5 (+1 if crossed page)
-  case INS_ASL_ABX: {
-   Word Address = FetchABAddress(memory);
-   Byte Value = ASL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ASL_ABX\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BCC_REL: {
-   BCC(memory);
-   printf("Handled INS_BCC_REL\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BCS_REL: {
-   BCS(memory);
-   printf("Handled INS_BCS_REL\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BEQ_REL: {
-   BEQ(memory);
-   printf("Handled INS_BEQ_REL\n");
-  } break;
-
-  // Cycles: 2
-  case INS_BIT_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   BIT(memory, Address);
-   printf("Handled INS_BIT_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_BIT_AB: {
-   Word Address = FetchABAddress(memory);
-   BIT(memory, Address);
-   printf("Handled INS_BIT_AB\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BMI_REL: {
-   BMI(memory);
-   printf("Handled INS_BMI_REL\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BNE_REL: {
-   BNE(memory);
-   printf("Handled INS_BNE_REL\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BPL_REL: {
-   BPL(memory);
-   printf("Handled INS_BPL_REL\n");
-  } break;
-
-  // Cycles: 6
-  case INS_BRK_IMPL: {
-   BRK(memory);
-   printf("Handled INS_BRK_IMPL\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BVC_REL: {
-   BVC(memory);
-   printf("Handled INS_BVC_REL\n");
-  } break;
-
-  // Cycles: 1 (+1 if succeed, + 2 if crossed page)
-  case INS_BVS_REL: {
-   BVS(memory);
-   printf("Handled INS_BVS_REL\n");
-  } break;
-
-   // Cycles: 1
-  case INS_CLC_IMPL: {
-   CLC();
-   printf("Handled INS_CLC_IMPL\n");
-  } break;
-
-   // Cycles: 1
-  case INS_CLD_IMPL: {
-   CLD();
-   printf("Handled INS_CLD_IMPL\n");
-  } break;
-
-   // Cycles: 1
-  case INS_CLI_IMPL: {
-   CLI();
-   printf("Handled INS_CLI_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_CLV_IMPL: {
-   CLV();
-   printf("Handled INS_CLV_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_CMP_IM: {
-   Byte Value = FetchByte(memory);
-   CMP(Value);
-   printf("Handled INS_CMP_IM\n");
-  } break;
-
-  // Cycles: 2
-  case INS_CMP_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CMP(Value);
-   printf("Handled INS_CMP_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_CMP_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   CMP(Value);
-   printf("Handled INS_CMP_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_CMP_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CMP(Value);
-   printf("Handled INS_CMP_AB\n");
-  } break;
-
-  // Cycles: 3 (+1 on crossing page)
-  case INS_CMP_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   CMP(Value);
-   printf("Handled INS_CMP_ABX\n");
-  } break;
-
-  // Cycles: 3 (+1 on crossing page)
-  case INS_CMP_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   Byte Value   = ReadByte(memory, Address);
-   CMP(Value);
-   printf("Handled INS_CMP_ABY\n");
-  } break;
-
-  // Cycles: 5
-  case INS_CMP_INX: {
-   Word Address = FetchINAddressX(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CMP(Value);
-   printf("Handled INS_CMP_INX\n");
-  } break;
-
-  // Cycles: 4 (+1 on crossing page)
-  case INS_CMP_INY: {
-   Word Address = FetchINAddressY(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CMP(Value);
-   printf("Handled INS_CMP_INY\n");
-  } break;
-
-  // Cycles: 1
-  case INS_CPX_IM: {
-   Byte Value = FetchByte(memory);
-   CPX(Value);
-   printf("Handled INS_CPX_IM\n");
-  } break;
-
-  // Cycles: 2
-  case INS_CPX_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CPX(Value);
-   printf("Handled INS_CPX_ZP\n");
-  } break;
-
-   // Cycles: 3
-  case INS_CPX_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CPX(Value);
-   printf("Handled INS_CPX_AB\n");
-  } break;
-
-   // Cycles: 1
-  case INS_CPY_IM: {
-   Byte Value = FetchByte(memory);
-   CPY(Value);
-   printf("Handled INS_CPY_IM\n");
-  } break;
-
-   // Cycles: 2
-  case INS_CPY_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CPY(Value);
-   printf("Handled INS_CPY_ZP\n");
-  } break;
-
-   // Cycles: 3
-  case INS_CPY_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   CPY(Value);
-   printf("Handled INS_CPY_AB\n");
-  } break;
-
-   // Cycles: 4
-  case INS_DEC_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   DEC(memory, Address);
-   printf("Handled INS_DEC_ZP\n");
-  } break;
-
-  // Cycles: 5
-  case INS_DEC_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   DEC(memory, Address);
-   printf("Handled INS_DEC_ZPX\n");
-  } break;
-
-  // Cycles: 5
-  case INS_DEC_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   DEC(memory, Address);
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_DEC_AB\n");
-  } break;
-
-  // Cycles: 6
-  case INS_DEC_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   DEC(memory, Address);
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_DEC_ABX\n");
-  } break;
-
-  // Cycles: 1
-  case INS_DEX_IMPL: {
-   DEX();
-   printf("Handled INS_DEX_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_DEY_IMPL: {
-   DEY();
-   printf("Handled INS_DEY_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_EOR_IM: {
-   Byte Operand = FetchByte(memory);
-   EOR(Operand);
-   printf("Handled INS_EOR_IM\n");
-  } break;
-
-  // Cycles: 2
-  case INS_EOR_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   EOR(Value);
-   printf("Handled INS_EOR_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_EOR_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   EOR(Value);
-   printf("Handled INS_EOR_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_EOR_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   EOR(Value);
-   printf("Handled INS_EOR_AB\n");
-  } break;
-
-  // Cycles: 3
-  case INS_EOR_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   EOR(Value);
-   printf("Handled INS_EOR_ABX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_EOR_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   Byte Value   = ReadByte(memory, Address);
-   EOR(Value);
-   printf("Handled INS_EOR_ABY\n");
-  } break;
-
-  // Cycles: 5
-  case INS_EOR_INX: {
-   Word Address = FetchINAddressX(memory);
-   Byte Value   = ReadByte(memory, Address);
-   EOR(Value);
-   printf("Handled INS_EOR_INX\n");
-  } break;
-
-  // Cycles: 4 (+1 if crossed page)
-  case INS_EOR_INY: {
-   Word Address = FetchINAddressY(memory);
-   Byte Value   = ReadByte(memory, Address);
-   EOR(Value);
-   printf("Handled INS_EOR_INY\n");
-  } break;
-
-  // Cycles: 4
-  case INS_INC_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   INC(memory, Address);
-   printf("Handled INS_INC_ZP\n");
-  } break;
-
-  // Cycles: 5
-  case INS_INC_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   INC(memory, Address);
-   printf("Handled INS_INC_ZPX\n");
-  } break;
-
-  // Cycles: 5
-  case INS_INC_AB: {
-   Word Address = FetchABAddress(memory);
-   INC(memory, Address);
-   printf("Handled INS_INC_AB\n");
-  } break;
-
-  // Cycles: 5
-  case INS_INC_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   INC(memory, Address);
-   printf("Handled INS_INC_ABX\n");
-  } break;
-
-  // Cycles: 1
-  case INS_INX_IMPL: {
-   INX();
-   printf("Handled INS_INX_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_INY_IMPL: {
-   INY();
-   printf("Handled INS_INY_IMPL\n");
-  } break;
-
-  // Cycles: 2
-  case INS_JMP_AB: {
-   Word Address = FetchABAddress(memory);
-   JMP(Address);
-   printf("Handled INS_JMP_AB\n");
-  } break;
-
-  // Cycles: 4
-  case INS_JMP_IN: {
-   Word Address          = FetchABAddress(memory);
-   Word EffectiveAddress = ReadWord(memory, Address);
-   JMP(EffectiveAddress);
-   printf("Handled INS_JMP_IN\n");
-  } break;
-
-  // Cycles: 5
-  case INS_JSR_AB: {
-   JSR(memory);
-   printf("Handled INS_JSR_AB\n");
-  } break;
-
-  // Cycles: 1
-  case INS_LDA_IM: {
-   Byte Value = FetchByte(memory);
-   LDA(Value);
-   printf("Handled INS_LDA_IM\n");
-  } break;
-
-   // Cycles: 2
-  case INS_LDA_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDA(Value);
-   printf("Handled INS_LDA_ZP\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDA_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   LDA(Value);
-   printf("Handled INS_LDA_ZPX\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDA_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDA(Value);
-   printf("Handled INS_LDA_AB\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDA_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   LDA(Value);
-   printf("Handled INS_LDA_ABX\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDA_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   printf("\n%04x\n", Address);
-   Byte Value   = ReadByte(memory, Address);
-   LDA(Value);
-   printf("Handled INS_LDA_ABY\n");
-  } break;
-
-   // Cycles: 5
-  case INS_LDA_INX: {
-   Word Address = FetchINAddressX(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDA(Value);
-   printf("Handled INS_LDA_INX\n");
-  } break;
-
-   // Cycles: 4 (+1 if crossed page)
-  case INS_LDA_INY: {
-   Word Address = FetchINAddressY(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDA(Value);
-   printf("Handled INS_LDA_INY\n");
-  } break;
-
-   // Cycles: 1
-  case INS_LDX_IM: {
-   Byte Value = FetchByte(memory);
-   LDX(Value);
-   printf("Handled INS_LDX_IM\n");
-  } break;
-
-   // Cycles: 2
-  case INS_LDX_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDX(Value);
-   printf("Handled INS_LDX_ZP\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDX_ZPY: {
-   Byte Address = FetchZPAddress(memory, Y);
-   Byte Value   = ReadByte(memory, Address);
-   LDX(Value);
-   printf("Handled INS_LDX_ZPY\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDX_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDX(Value);
-   printf("Handled INS_LDX_AB\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDX_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   Byte Value   = ReadByte(memory, Address);
-   LDX(Value);
-   printf("Handled INS_LDX_ABY\n");
-  } break;
-
-  // Cycles: 1
-  case INS_LDY_IM: {
-   Byte Value = FetchByte(memory);
-   LDY(Value);
-   printf("Handled INS_LDY_IM\n");
-  } break;
-
-   // Cycles: 2
-  case INS_LDY_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDY(Value);
-   printf("Handled INS_LDY_ZP\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDY_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   LDY(Value);
-   printf("Handled INS_LDY_ZPX\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDY_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   LDY(Value);
-   printf("Handled INS_LDY_AB\n");
-  } break;
-
-   // Cycles: 3
-  case INS_LDY_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   LDY(Value);
-   printf("Handled INS_LDY_ABX\n");
-  } break;
-
-  // Cycles: 1
-  case INS_LSR_A: {
-   A = LSR(A);
-   printf("Handled INS_LSR_A\n");
-  } break;
-
-  // Cycles: 4
-  case INS_LSR_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value = LSR(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_LSR_ZP\n");
-  } break;
-
-  // Cycles: 5
-  case INS_LSR_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value = LSR(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_LSR_ZPX\n");
-  } break;
-
-  // Cycles: 5
-  case INS_LSR_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value = LSR(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_LSR_AB\n");
-  } break;
-
-  // Cycles: 6
-  case INS_LSR_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value = LSR(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_LSR_ABX\n");
-  } break;
-
-  case INS_NOP_IMPL: {
-   NOP();
-   printf("Handled INS_NOP_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_ORA_IM: {
-   Byte Value = FetchByte(memory);
-   ORA(Value);
-   printf("Handled INS_ORA_IM\n");
-  } break;
-
-  // Cycles: 2
-  case INS_ORA_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ORA(Value);
-   printf("Handled INS_ORA_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_ORA_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   ORA(Value);
-   printf("Handled INS_ORA_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_ORA_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ORA(Value);
-   printf("Handled INS_ORA_AB\n");
-  } break;
-
-  // Cycles: 3
-  case INS_ORA_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   ORA(Value);
-   printf("Handled INS_ORA_ABX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_ORA_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   Byte Value   = ReadByte(memory, Address);
-   ORA(Value);
-   printf("Handled INS_ORA_ABY\n");
-  } break;
-
-  // Cycles: 5
-  case INS_ORA_INX: {
-   Word Address = FetchINAddressX(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ORA(Value);
-   printf("Handled INS_ORA_INX\n");
-  } break;
-
-  // Cycles: 4 (+1 if crossed page)
-  case INS_ORA_INY: {
-   Word Address = FetchINAddressY(memory);
-   Byte Value   = ReadByte(memory, Address);
-   ORA(Value);
-   printf("Handled INS_ORA_INY\n");
-  } break;
-
-  // Cycles: 1
-  case INS_PHA_IMPL: {
-   PHA(memory);
-   printf("Handled INS_PHA_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_PHP_IMPL: {
-   PHP(memory);
-   printf("Handled INS_PHP_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_PLA_IMPL: {
-   PLA(memory);
-   printf("Handled INS_PLA_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_PLP_IMPL: {
-   PLP(memory);
-   printf("Handled INS_PLP_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_ROL_A: {
-   A = ROL(A);
-   printf("Handled INS_ROL_A\n");
-  } break;
-
-  // Cycles: 4
-  case INS_ROL_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value = ROL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ROL_ZP\n");
-  } break;
-  // Cycles: 5
-  case INS_ROL_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value = ROL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ROL_ZPX\n");
-  } break;
-  // Cycles: 5
-  case INS_ROL_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value = ROL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ROL_AB\n");
-  } break;
-
-  // Cycles: 6
-  case INS_ROL_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value = ROL(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ROL_ABX\n");
-  } break;
-
-  // Cycles: 1
-  case INS_ROR_A: {
-   A = ROR(A);
-   printf("Handled INS_ROR_A\n");
-  } break;
-
-  // Cycles: 4
-  case INS_ROR_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value = ROR(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ROR_ZP\n");
-  } break;
-  // Cycles: 5
-  case INS_ROR_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   Byte Value = ROR(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ROR_ZPX\n");
-  } break;
-  // Cycles: 5
-  case INS_ROR_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value = ROR(ReadByte(memory, Address));
-   WriteByte(memory, Address, Value);
-   printf("Handled INS_ROR_AB\n");
-  } break;
+namespace {
+
+const char* const VariantNames[CPU_VARIANTS] = {"6502", "6502x", "65c02", "r65c02", "w65c02"};
+
+// Handler table of one variant. Everything is decided while compiling, so
+// each variant's table is a constant and its Dispatch loop never asks which
+// chip it is
+template <int Chip>
+struct HandlerTable {
+ CPU_6502::Handler Entries[256] = {};
+
+ constexpr HandlerTable() {
+  for (CPU_6502::Handler& Entry : Entries) Entry = &CPU_6502::Illegal;
+
+  // The CMOS parts have no illegal opcodes, what is not an instruction
+  // skips a fixed number of bytes
+  if constexpr (IsCMOS(Chip)) {
+   for (int Op = 0x03; Op < 0x100; Op += 0x04) Entries[Op] = &CPU_6502::Reserved<Chip, 1, 1>;
+   for (int Op = 0x02; Op < 0x100; Op += 0x20) Entries[Op] = &CPU_6502::Reserved<Chip, 2, 2>;
+   Entries[0x44] = &CPU_6502::Reserved<Chip, 2, 3>;
+   Entries[0x54] = &CPU_6502::Reserved<Chip, 2, 4>;
+   Entries[0xD4] = &CPU_6502::Reserved<Chip, 2, 4>;
+   Entries[0xF4] = &CPU_6502::Reserved<Chip, 2, 4>;
+   Entries[0x5C] = &CPU_6502::Reserved<Chip, 3, 8>;
+   Entries[0xDC] = &CPU_6502::Reserved<Chip, 3, 4>;
+   Entries[0xFC] = &CPU_6502::Reserved<Chip, 3, 4>;
+  }
 
-  // Cycles: 6
-  case INS_ROR_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value = ROR(ReadByte(memory, Address));
+#define OPCODE(Op, ...) Entries[Op] = &CPU_6502::Handle_##Op<Chip>;
+#include "ops_6502.h"
+  if constexpr (ChipModel(Chip) == CPU_NMOS_ILLEGAL) {
+#include "ops_6502x.h"
+  }
+  if constexpr (IsCMOS(Chip)) {
+#include "ops_65c02.h"
+  }
+  if constexpr (ChipModel(Chip) == CPU_R65C02 || ChipModel(Chip) == CPU_W65C02) {
+#include "ops_r65c02.h"
+  }
+  if constexpr (ChipModel(Chip) == CPU_W65C02) {
+#include "ops_w65c02.h"
+  }
+#undef OPCODE
+ }
+};
+
+template <int Chip>
+constexpr HandlerTable<Chip> Handlers;
+
+}  // namespace
+
+int ParseCPUVariant(const std::string& Name) {
+ for (int Chip = 0; Chip < CPU_VARIANTS; Chip++)
+  if (Name == VariantNames[Chip]) return Chip;
+ return -1;
+}
+
+const char* CPUVariantName(int Chip) { return Chip >= 0 && Chip < CPU_VARIANTS ? VariantNames[Chip] : "?"; }
+
+int ParseIllegalPolicy(const std::string& Name) {
+ if (Name == "halt") return ILLEGAL_HALT;
+ if (Name == "callback") return ILLEGAL_CALLBACK;
+ if (Name == "nop") return ILLEGAL_NOP;
+ return -1;
+}
+
+// Nothing but the bus sees a dummy read, the value is thrown away. Like every
+// access it is a cycle of its own, see CPU_BUS_EXACT
+template <int Chip>
+inline void CPU_6502::DummyRead(Memory& memory, Word Address) {
+ if constexpr (IsBusExact(Chip)) ReadByte(memory, Address);
+}
+
+// The NMOS adds the index to the low byte first and reads from that address
+// while it fixes the high byte, on a page cross only unless the instruction
+// writes. The 65C02 reads the last operand byte again instead
+template <int Chip>
+inline void CPU_6502::IndexCycle(Memory& memory, Word Address, Byte Index, bool Write) {
+ if constexpr (IsBusExact(Chip)) {
+  Word Unfixed = ((Address - Index) & 0xFF00) | (Address & 0x00FF);
+  if (!Write && Unfixed == Address) return;
+  ReadByte(memory, IsCMOS(Chip) ? (Word)(PC - 1) : Unfixed);
+ }
+}
+
+// zp,X and zp,Y read the unindexed address while adding
+template <int Chip>
+inline Byte CPU_6502::FetchZPIndexed(Memory& memory, Byte Index) {
+ Byte Address = FetchZPAddress(memory, Index);
+ DummyRead<Chip>(memory, (Byte)(Address - Index));
+ return Address;
+}
+
+template <int Chip>
+inline Word CPU_6502::FetchABIndexed(Memory& memory, Byte Index, bool Write) {
+ Word Address = FetchABAddress(memory, Index);
+ IndexCycle<Chip>(memory, Address, Index, Write);
+ return Address;
+}
+
+// (zp,X) reads the pointer before X is added to it
+template <int Chip>
+inline Word CPU_6502::FetchINIndexedX(Memory& memory) {
+ if constexpr (!IsBusExact(Chip)) return FetchINAddressX(memory);
+ Byte Pointer = FetchByte(memory);
+ DummyRead<Chip>(memory, Pointer);
+ EatCycles(1);
+ LastAddress = ReadZPWord(memory, Pointer + X);
+ return LastAddress;
+}
+
+template <int Chip>
+inline Word CPU_6502::FetchINIndexedY(Memory& memory, bool Write) {
+ Word Address = FetchINAddressY(memory);
+ IndexCycle<Chip>(memory, Address, Y, Write);
+ return Address;
+}
+
+// A taken branch reads the next opcode while it adds the offset, and the
+// unfixed target when the high byte has to change
+template <int Chip>
+inline void CPU_6502::Branch(Memory& memory, bool Value, bool Needed) {
+ Word Next = PC + 1;
+ ConditionalBranch(memory, Value, Needed);
+ if constexpr (IsBusExact(Chip)) {
+  if (Value != Needed) return;
+  ReadByte(memory, Next);
+  if ((PC ^ Next) & 0xFF00) ReadByte(memory, (Next & 0xFF00) | (PC & 0x00FF));
+ }
+}
+
+// ADC and SBC in decimal mode take one more cycle on the 65C02, a read of the
+// next opcode
+template <int Chip>
+inline void CPU_6502::DecimalCycle(Memory& memory) {
+ if constexpr (IsCMOS(Chip))
+  if (PS.D) DummyRead<Chip>(memory, PC);
+}
+
+// Between the read and the write the NMOS writes the old value back, the
+// 65C02 reads it a second time
+template <int Chip, typename Operation>
+inline void CPU_6502::Modify(Memory& memory, Word Address, Operation Op) {
+ Byte Value = ReadByte(memory, Address);
+ if constexpr (IsBusExact(Chip)) {
+  if constexpr (IsCMOS(Chip))
+   ReadByte(memory, Address);
+  else
    WriteByte(memory, Address, Value);
-   printf("Handled INS_ROR_ABX\n");
-  } break;
-
-  // Cycles: 5
-  case INS_RTI_IMPL: {
-   RTI(memory);
-   printf("Handled INS_RTI_IMPL\n");
-  } break;
-
-  // Cycles: 5
-  case INS_RTS_IMPL: {
-   RTS(memory);
-   printf("Handled INS_RTS_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_SBC_IM: {
-   Byte Value = FetchByte(memory);
-   SBC(Value);
-   printf("Handled INS_SBC_IM\n");
-  } break;
-
-  // Cycles: 2
-  case INS_SBC_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   SBC(Value);
-   printf("Handled INS_SBC_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_SBC_ZPX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   SBC(Value);
-   printf("Handled INS_SBC_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_SBC_AB: {
-   Word Address = FetchABAddress(memory);
-   Byte Value   = ReadByte(memory, Address);
-   SBC(Value);
-   printf("Handled INS_SBC_AB\n");
-  } break;
-
-  // Cycles: 3 (+1 on crossing page)
-  case INS_SBC_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   Byte Value   = ReadByte(memory, Address);
-   SBC(Value);
-   printf("Handled INS_SBC_ABX\n");
-  } break;
-
-  // Cycles: 3 (+1 if crossing page)
-  case INS_SBC_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   Byte Value   = ReadByte(memory, Address);
-   SBC(Value);
-   printf("Handled INS_SBC_ABY\n");
-  } break;
-
-  // Cycles: 5
-  case INS_SBC_INX: {
-   Word Address = FetchINAddressX(memory);
-   Byte Value   = ReadByte(memory, Address);
-   SBC(Value);
-   printf("Handled INS_SBC_INX\n");
-  } break;
-
-  // Cycles: 4 (+1 if crossing page)
-  case INS_SBC_INY: {
-   Word Address = FetchINAddressY(memory);
-   Byte Value   = ReadByte(memory, Address);
-   SBC(Value);
-   printf("Handled INS_SBC_INY\n");
-  } break;
-
-  // Cycles: 1
-  case INS_SED_IMPL: {
-   SED();
-   printf("Handled INS_SED_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_SEC_IMPL: {
-   SEC();
-   printf("Handled INS_SEC_IMPL\n");
-  } break;
-
-  // Cycles: 1
-  case INS_SEI_IMPL: {
-   SEI();
-   printf("Handled INS_SEI_IMPL\n");
-  } break;
-
-  // Cycles: 2
-  case INS_STA_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   STA(memory, Address);
-   printf("Handled INS_STA_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_STA_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   STA(memory, Address);
-   printf("Handled INS_STA_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_STA_AB: {
-   Word Address = FetchABAddress(memory);
-   STA(memory, Address);
-   printf("Handled INS_STA_AB\n");
-  } break;
-
-  // Cycles: 3 (+1 if crossed page)
-  case INS_STA_ABX: {
-   Word Address = FetchABAddress(memory, X);
-   STA(memory, Address);
-   printf("Handled INS_STA_ABX\n");
-  } break;
-
-  // Cycles: 3 (+1 if crossed page)
-  case INS_STA_ABY: {
-   Word Address = FetchABAddress(memory, Y);
-   STA(memory, Address);
-   printf("Handled INS_STA_ABY\n");
-  } break;
-
-  // Cycles: 5
-  case INS_STA_INX: {
-   Word Address = FetchINAddressX(memory);
-   WriteByte(memory, Address, A);
-   printf("Handled INS_STA_INX\n");
-  } break;
-
-  // Cycles: 4 (+1 if crossed page)
-  case INS_STA_INY: {
-   Word Address = FetchINAddressY(memory);
-   WriteByte(memory, Address, A);
-   printf("Handled INS_STA_INY\n");
-  } break;
-
-  // Cycles: 2
-  case INS_STX_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   STX(memory, Address);
-   printf("Handled INS_STX_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_STX_ZPY: {
-   Byte Address = FetchZPAddress(memory, Y);
-   STX(memory, Address);
-   printf("Handled INS_STX_ZPY\n");
-  } break;
-
-  // Cycles: 3
-  case INS_STX_AB: {
-   Word Address = FetchABAddress(memory);
-   STX(memory, Address);
-   printf("Handled INS_STX_AB\n");
-  } break;
-
-  // Cycles: 2
-  case INS_STY_ZP: {
-   Byte Address = FetchZPAddress(memory);
-   STY(memory, Address);
-   printf("Handled INS_STY_ZP\n");
-  } break;
-
-  // Cycles: 3
-  case INS_STY_ZPX: {
-   Byte Address = FetchZPAddress(memory, X);
-   STY(memory, Address);
-   printf("Handled INS_STY_ZPX\n");
-  } break;
-
-  // Cycles: 3
-  case INS_STY_AB: {
-   Word Address = FetchABAddress(memory);
-   STY(memory, Address);
-   printf("Handled INS_STY_AB\n");
-  } break;
-
-  case INS_TYA_IMPL: {
-   TYA();
-   printf("Handled INS_TYA_IMPL\n");
-  } break;
-
-  case INS_TAY_IMPL: {
-   TAY();
-   printf("Handled INS_TAY_IMPL\n");
-  } break;
+ }
+ WriteByte(memory, Address, Op(Value));
+}
+
+#define OPCODE(Op, ...) \
+ template <int Chip>    \
+ void CPU_6502::Handle_##Op([[maybe_unused]] Memory& memory) __VA_ARGS__
+#include "ops_6502.h"
+#include "ops_6502x.h"
+#include "ops_65c02.h"
+#include "ops_r65c02.h"
+#include "ops_w65c02.h"
+#undef OPCODE
+
+// The opcode fetch is already paid for. A halt ends the slice at once and
+// leaves PC on the opcode, so a host that fixes things up can resume there
+void CPU_6502::Illegal(Memory& memory) {
+ if (IllegalPolicy == ILLEGAL_NOP) {
+  NOP();
+  if (BusCycles) ReadByte(memory, PC);
+  return;
+ }
+ if (IllegalPolicy == ILLEGAL_CALLBACK && OnIllegal) {
+  OnIllegal(*this, memory, Opcode);
+  return;
+ }
+ PC--;
+ StopReason = STOP_ILLEGAL;
+ StopOpcode = Opcode;
+ Lines.RequestStop();
+ Cycles = 0;
+}
+
+// The bus exact tables fetch the operand and spend the other cycles reading
+// the address it names, which is close to what the chips do
+template <int Chip, int Length, int Cost>
+void CPU_6502::Reserved([[maybe_unused]] Memory& memory) {
+ if constexpr (IsBusExact(Chip)) {
+  Word Address = Length > 1 ? FetchByte(memory) : 0;
+  if constexpr (Length > 2) Address |= FetchByte(memory) << 8;
+  for (int Cycle = Length; Cycle < Cost; Cycle++) ReadByte(memory, Address);
+ } else {
+  PC += Length - 1;
+  EatCycles(Cost - 1);
+ }
+}
+
+// Same loop as Execute, each opcode is one indirect call through the
+// variant's handler table instead of a trip through the switch
+template <int Chip, bool Traced>
+int32_t CPU_6502::Dispatch(int32_t workCycles, Memory& memory) {
+ uint64_t StartCycles = TotalCycles;
+ Cycles               = workCycles;
+ BusCycles            = IsBusExact(Chip);
+ while (Cycles > 0) {
+  InstructionStart = TotalCycles;
+  if (Lines.Signal) {
+   if (Lines.Signal & INTERRUPT_STOP) break;
+   if (ServiceInterrupt(memory)) {
+    if constexpr (IsCMOS(Chip)) PS.D = 0;
+    continue;
+   }
+  }
 
-  case INS_TXA_IMPL: {
-   TXA();
-   printf("Handled INS_TXA_IMPL\n");
-  } break;
+  TraceRecord* Record = Traced && Trace ? &TraceInstruction(memory) : nullptr;
 
-  case INS_TAX_IMPL: {
-   TAX();
-   printf("Handled INS_TAX_IMPL\n");
-  } break;
+  Byte Ins = FetchOpcode(memory);
+  Opcode   = Ins;
+  PROFILE(Profile.Current = Ins;)
+  (this->*Handlers<Chip>.Entries[Ins])(memory);
+  if (Traced && Record) Record->EffectiveAddress = LastAddress;
+  PROFILE(Profile.Retire(TotalCycles - InstructionStart);)
+ }
+ return TotalCycles - StartCycles;
+}
+
+template <bool Traced, int Exact>
+int32_t CPU_6502::DispatchVariant(int32_t workCycles, Memory& memory) {
+ switch (Variant) {
+ case CPU_NMOS_ILLEGAL:
+  return Dispatch<CPU_NMOS_ILLEGAL | Exact, Traced>(workCycles, memory);
+ case CPU_65C02:
+  return Dispatch<CPU_65C02 | Exact, Traced>(workCycles, memory);
+ case CPU_R65C02:
+  return Dispatch<CPU_R65C02 | Exact, Traced>(workCycles, memory);
+ case CPU_W65C02:
+  return Dispatch<CPU_W65C02 | Exact, Traced>(workCycles, memory);
+ }
+ return Dispatch<CPU_NMOS | Exact, Traced>(workCycles, memory);
+}
+
+int32_t CPU_6502::ExecuteFast(int32_t workCycles, Memory& memory) {
+ if (BusExact) return DispatchVariant<false, CPU_BUS_EXACT>(workCycles, memory);
+ return DispatchVariant<false, 0>(workCycles, memory);
+}
+
+// Reference interpreter, a plain switch over the same bodies the tables are
+// built from. It is not an independent implementation: against the tables it
+// checks the wiring and the dispatch loop, not what an instruction does. It
+// only knows the instruction level NMOS opcodes, the other variants and the
+// bus exact tables run with the trace hooks
+int32_t CPU_6502::Execute(int32_t workCycles, Memory& memory) {
+ if (BusExact) return DispatchVariant<true, CPU_BUS_EXACT>(workCycles, memory);
+ if (Variant != CPU_NMOS) return DispatchVariant<true, 0>(workCycles, memory);
 
-  case INS_TSX_IMPL: {
-   TSX();
-   printf("Handled INS_TSX_IMPL\n");
-  } break;
+ constexpr int Chip   = CPU_NMOS;
+ uint64_t StartCycles = TotalCycles;
+ Cycles               = workCycles;
+ BusCycles            = false;
+ while (Cycles > 0) {
+  InstructionStart = TotalCycles;
+  if (Lines.Signal) {
+   if (Lines.Signal & INTERRUPT_STOP) break;
+   if (ServiceInterrupt(memory)) continue;
+  }
 
-  case INS_TXS_IMPL: {
-   TXS();
-   printf("Handled INS_TXS_IMPL\n");
-  } break;
+  TraceRecord* Record = Trace ? &TraceInstruction(memory) : nullptr;
 
-  default: {
-   printf("Ins %02x Isn't handled\n", Ins);
-   std::this_thread::sleep_for(std::chrono::microseconds(125));
-   return 0;
-  } break;
+  Byte Ins = FetchOpcode(memory);
+  Opcode   = Ins;
+  PROFILE(Profile.Current = Ins;)
+  switch (Ins) {
+#define OPCODE(Op, ...) \
+  case Op:               \
+   __VA_ARGS__ break;
+#include "ops_6502.h"
+#undef OPCODE
+
+  default:
+   Illegal(memory);
+   break;
   }
+  if (Record) Record->EffectiveAddress = LastAddress;
+  PROFILE(Profile.Retire(TotalCycles - InstructionStart);)
  }
- return workCycles - Cycles;
-}
\ No newline at end of file
+ // Cycles may have been cut short by the scheduler, count what was really eaten
+ return TotalCycles - StartCycles;
+}
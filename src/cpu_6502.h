@@ -1,10 +1,114 @@
 #ifndef _CPU_6502_H_
 #define _CPU_6502_H_
 
+#include <functional>
+#include <string>
+
 #include "cpu_65xx.h"
 
+// Chip variants. All share the bodies in ops_6502.h, each adds the opcodes of
+// its extensions and gets a handler table of its own, built at compile time
+enum {
+ CPU_NMOS         = 0,  // 6502, documented opcodes
+ CPU_NMOS_ILLEGAL = 1,  // 6502 with the undocumented opcodes, ops_6502x.h
+ CPU_65C02        = 2,  // CMOS, ops_65c02.h
+ CPU_R65C02       = 3,  // 65C02 with the Rockwell bit instructions, ops_r65c02.h
+ CPU_W65C02       = 4,  // R65C02 with WAI and STP, ops_w65c02.h
+ CPU_VARIANTS,
+};
+
+// Added to a variant for its bus exact tables. The default tables are
+// instruction level: every access an instruction needs for its result, in an
+// order that is close enough, and a cycle count per instruction that is not
+// always the datasheet's. The bus exact ones also do the dummy reads and
+// writes of the real chip, in cycle order, so devices that react to being
+// read see what they would on hardware. There every access is one cycle and
+// nothing else costs any, so each instruction takes the datasheet count
+constexpr int CPU_BUS_EXACT = 0x10;
+
+constexpr int ChipModel(int Chip) { return Chip & ~CPU_BUS_EXACT; }
+constexpr bool IsCMOS(int Chip) { return ChipModel(Chip) >= CPU_65C02; }
+constexpr bool IsBusExact(int Chip) { return (Chip & CPU_BUS_EXACT) != 0; }
+
+// What an opcode the variant does not implement does
+enum {
+ ILLEGAL_HALT     = 0,  // Stop with STOP_ILLEGAL, PC on the opcode
+ ILLEGAL_CALLBACK = 1,  // Hand it to OnIllegal, halt when there is none
+ ILLEGAL_NOP      = 2,  // One byte, two cycles
+};
+
+// Why Execute gave back control before the cycles ran out
+enum {
+ STOP_NONE    = 0,
+ STOP_ILLEGAL = 1,
+};
+
+// "6502", "6502x", "65c02", "r65c02" or "w65c02", -1 when unknown
+int ParseCPUVariant(const std::string& Name);
+const char* CPUVariantName(int Chip);
+// "halt", "callback" or "nop", -1 when unknown
+int ParseIllegalPolicy(const std::string& Name);
+
 struct CPU_6502 : CPU_65XX {
+ typedef void (CPU_6502::*Handler)(Memory& memory);
+ // Called with PC past the opcode, may emulate it and move PC on
+ typedef std::function<void(CPU_6502& Cpu, Memory& memory, Byte Opcode)> IllegalHandler;
+
+ int Variant   = CPU_NMOS;  // Picks the table once per Execute call, never per instruction
+ bool BusExact = false;     // Run the CPU_BUS_EXACT tables
+
+ int IllegalPolicy = ILLEGAL_HALT;
+ IllegalHandler OnIllegal;
+ int StopReason    = STOP_NONE;  // Machine::Run clears it when it starts
+ Byte StopOpcode   = 0;
+ Byte Opcode       = 0;  // As fetched by the running instruction, memory may have changed since
+
  int32_t Execute(int32_t Cycles, Memory& Memory);
+ int32_t ExecuteFast(int32_t Cycles, Memory& Memory);
+
+ // Table dispatch loop of one variant, Traced adds the trace hooks
+ template <int Chip, bool Traced>
+ int32_t Dispatch(int32_t Cycles, Memory& memory);
+ template <bool Traced, int Exact>
+ int32_t DispatchVariant(int32_t Cycles, Memory& memory);
+
+ // Accesses only the bus exact tables make. Elsewhere the dummies compile to
+ // nothing and the fetches are the plain ones of CPU_65XX
+ template <int Chip>
+ void DummyRead(Memory& memory, Word Address);
+ template <int Chip>
+ Byte FetchZPIndexed(Memory& memory, Byte Index);
+ template <int Chip>
+ Word FetchABIndexed(Memory& memory, Byte Index, bool Write = false);
+ template <int Chip>
+ Word FetchINIndexedX(Memory& memory);
+ template <int Chip>
+ Word FetchINIndexedY(Memory& memory, bool Write = false);
+ template <int Chip>
+ void IndexCycle(Memory& memory, Word Address, Byte Index, bool Write);
+ template <int Chip>
+ void Branch(Memory& memory, bool Value, bool Needed);
+ template <int Chip>
+ void DecimalCycle(Memory& memory);
+ // Read-modify-write, Operation maps the old value to the one written back
+ template <int Chip, typename Operation>
+ void Modify(Memory& memory, Word Address, Operation Op);
+
+ // One handler per opcode and variant, bodies from the ops_*.h files
+#define OPCODE(Op, ...) \
+ template <int Chip>    \
+ void Handle_##Op(Memory& memory);
+#include "ops_6502.h"
+#include "ops_6502x.h"
+#include "ops_65c02.h"
+#include "ops_r65c02.h"
+#include "ops_w65c02.h"
+#undef OPCODE
+ void Illegal(Memory& memory);
+
+ // Reserved CMOS opcodes, a NOP of fixed length and cost
+ template <int Chip, int Length, int Cost>
+ void Reserved(Memory& memory);
 };
 
-#endif
\ No newline at end of file
+#endif
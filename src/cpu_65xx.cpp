@@ -10,78 +10,159 @@ void CPU_65XX::Reset(Memory& Mem) {
  PC = 0xFFFC;
  SP = 0xFF;
  PS.U = 1;
+ TotalCycles = 0;
+ Waiting     = false;
+ Stopped     = false;
  Mem.Init();
 }
 
-int32_t CPU_65XX::EatCycles(int32_t amount) { return Cycles -= amount; }
+// Called at an instruction boundary when Lines.Signal is non-zero
+bool CPU_65XX::ServiceInterrupt(Memory& mem) {
+ if (Stopped) return false;
+ if (Lines.Signal & INTERRUPT_NMI) {
+  Lines.Signal &= ~INTERRUPT_NMI;
+  Interrupt(mem, NMI_VECTOR);
+  return true;
+ }
+ if ((Lines.Signal & INTERRUPT_IRQ_MASK) && !PS.I) {
+  Interrupt(mem, IRQ_VECTOR);
+  return true;
+ }
+ return false;
+}
+
+// Hardware interrupt sequence, 7 cycles like BRK but pushes B clear. The
+// bus exact tables read PC twice before the pushes
+void CPU_65XX::Interrupt(Memory& mem, Word Vector) {
+ if (Trace) TraceInstruction(mem, Vector == NMI_VECTOR ? TRACE_NMI : TRACE_IRQ);
+ EatCycles(2);
+ if (BusCycles) {
+  ReadByte(mem, PC);
+  ReadByte(mem, PC);
+ }
+ if (Waiting) {
+  Waiting = false;
+  PC++;
+ }
+ StackPushWord(mem, PC);
+ StackPushByte(mem, (PS.GetPS() | CPU_65XX_PS::UnusedBit) & ~CPU_65XX_PS::BreakBit);
+ PS.I = true;
+ PC   = ReadWord(mem, Vector);
+ if (Calls) Calls->Call(TotalCycles, PC, SP + 3);
+ PROFILE(Profile.Interrupts++; Profile.InterruptCycles += 7;)
+}
+
+// Starts a trace record with the state before the instruction at PC runs.
+// Operands are peeked so devices see no extra reads
+TraceRecord& CPU_65XX::TraceInstruction(Memory& mem, Byte Kind) {
+ TraceRecord& Record     = Trace->Next();
+ Record.Cycle            = TotalCycles;
+ Record.PC               = PC;
+ Record.EffectiveAddress = 0;
+ Record.Opcode           = mem.Peek(PC);
+ Record.Operand[0]       = mem.Peek(PC + 1);
+ Record.Operand[1]       = mem.Peek(PC + 2);
+ Record.A                = A;
+ Record.X                = X;
+ Record.Y                = Y;
+ Record.SP               = SP;
+ Record.P                = PS.GetPS();
+ Record.Kind             = Kind;
+ return Record;
+}
+
+int32_t CPU_65XX::EatCycles(int32_t amount) {
+ if (BusCycles) return Cycles;
+ TotalCycles += amount;
+ return Cycles -= amount;
+}
+
+int32_t CPU_65XX::Tick(int32_t amount) {
+ TotalCycles += amount;
+ return Cycles -= amount;
+}
+
+Byte CPU_65XX::FetchOpcode(Memory& mem) {
+ Tick(1);
+ Byte Opcode = mem.Fetch(PC);
+ PC++;
+ return Opcode;
+}
 
 Byte CPU_65XX::FetchByte(Memory& mem) {
- EatCycles(1);
- Byte Value = mem[PC];
+ Tick(1);
+ Byte Value = mem.Read(PC);
  PC++;
  return Value;
 }
 
 Word CPU_65XX::FetchWord(Memory& mem) {
- EatCycles(2);
+ Tick(2);
  Byte lo, hi;
- lo = mem[PC];
+ lo = mem.Read(PC);
  PC++;
- hi = mem[PC];
+ hi = mem.Read(PC);
  PC++;
  return (Word)(hi << 8) | lo;
 }
 
 Byte CPU_65XX::ReadByte(Memory& mem, Word Address) {
- EatCycles(1);
- return mem[Address];
+ Tick(1);
+ return mem.Read(Address);
 }
 
 Word CPU_65XX::ReadWord(Memory& mem, Word Address) {
- EatCycles(2);
- Byte lo = mem[Address];
- Byte hi = mem[Address + 1];
+ Tick(2);
+ Byte lo = mem.Read(Address);
+ Byte hi = mem.Read(Address + 1);
+ return (Word)(hi << 8) | lo;
+}
+
+Word CPU_65XX::ReadZPWord(Memory& mem, Byte Address) {
+ Tick(2);
+ Byte lo = mem.Read(Address);
+ Byte hi = mem.Read((Byte)(Address + 1));
  return (Word)(hi << 8) | lo;
 }
 
 void CPU_65XX::WriteByte(Memory& mem, Word Address, Byte Value) {
- EatCycles(1);
- mem[Address] = Value;
+ Tick(1);
+ mem.Write(Address, Value);
 }
 
 void CPU_65XX::WriteWord(Memory& mem, Word Address, Word Value) {
- EatCycles(2);
- mem[Address] = (Value >> 8) & 0xFF;
+ Tick(2);
+ mem.Write(Address, Value & 0xFF);
  Address++;
- mem[Address] = (Value & 0xFF);
+ mem.Write(Address, Value >> 8);
 }
 
 void CPU_65XX::StackPushByte(Memory& mem, Byte Value) {
- EatCycles(1);
- mem[0x100 + SP] = Value;
+ Tick(1);
+ mem.Write(0x100 + SP, Value);
  SP--;
 }
 
 void CPU_65XX::StackPushWord(Memory& mem, Word Value) {
- EatCycles(2);
- mem[0x100 + SP] = Value >> 8;
+ Tick(2);
+ mem.Write(0x100 + SP, Value >> 8);
  SP--;
- mem[0x100 + SP] = Value & 0xFF;
+ mem.Write(0x100 + SP, Value & 0xFF);
  SP--;
 }
 
 Byte CPU_65XX::StackPopByte(Memory& mem) {
- EatCycles(1);
+ Tick(1);
  SP++;
- return mem[0x100 + SP];
+ return mem.Read(0x100 + SP);
 }
 
 Word CPU_65XX::StackPopWord(Memory& mem) {
- EatCycles(2);
+ Tick(2);
  SP++;
- Byte lo = mem[0x100 + SP];
+ Byte lo = mem.Read(0x100 + SP);
  SP++;
- Byte hi = mem[0x100 + SP];
+ Byte hi = mem.Read(0x100 + SP);
  return (Word)(hi << 8) | lo;
 }
 
@@ -91,6 +172,7 @@ Byte CPU_65XX::FetchZPAddress(Memory& mem, Byte Offset) {
   EatCycles(1);
   Address += Offset;
  }
+ LastAddress = Address;
  return Address;
 }
 
@@ -99,27 +181,41 @@ Word CPU_65XX::FetchABAddress(Memory& mem, Byte Offset) {
 
  Word EffectiveAddress = Address + Offset;
 
- if ((Address & 0xFF00) != (EffectiveAddress & 0xFF00)) EatCycles(1);
+ if ((Address & 0xFF00) != (EffectiveAddress & 0xFF00)) {
+  EatCycles(1);
+  PROFILE(Profile.Opcodes[Profile.Current].PageCross++;)
+ }
+ LastAddress = EffectiveAddress;
  return EffectiveAddress;
 }
 
 Word CPU_65XX::FetchINAddressX(Memory& mem) {
  Byte ZeroPageAddress = FetchByte(mem);
- Word IndirectAddress = (ZeroPageAddress + X) & 0xFF;
+ Byte IndirectAddress = ZeroPageAddress + X;
  EatCycles(1);
 
- Word EffectiveAddress = ReadWord(mem, IndirectAddress);
+ Word EffectiveAddress = ReadZPWord(mem, IndirectAddress);
+ LastAddress           = EffectiveAddress;
+ return EffectiveAddress;
+}
+
+Word CPU_65XX::FetchINAddress(Memory& mem) {
+ Byte ZeroPageAddress  = FetchByte(mem);
+ Word EffectiveAddress = ReadZPWord(mem, ZeroPageAddress);
+ LastAddress           = EffectiveAddress;
  return EffectiveAddress;
 }
 
 Word CPU_65XX::FetchINAddressY(Memory& mem) {
  Byte ZeroPageAddress  = FetchByte(mem);
- Word IndirectAddress  = ReadWord(mem, ZeroPageAddress);
+ Word IndirectAddress  = ReadZPWord(mem, ZeroPageAddress);
  Word EffectiveAddress = IndirectAddress + Y;
 
  if ((IndirectAddress & 0xFF00) != (EffectiveAddress & 0xFF00)) {
   EatCycles(1);
+  PROFILE(Profile.Opcodes[Profile.Current].PageCross++;)
  }
 
+ LastAddress = EffectiveAddress;
  return EffectiveAddress;
 }
\ No newline at end of file
@@ -3,9 +3,13 @@
 
 #include <cstdint>
 
+#include "callgraph.h"
 #include "common.h"
 #include "ins_65xx.h"
+#include "interrupt.h"
 #include "memory.h"
+#include "profile.h"
+#include "trace.h"
 
 // CPU PROGRAM COUNTER STUFF
 
@@ -33,7 +37,7 @@ struct CPU_65XX_PS {
   V = (NewPS & OverflowBit) ? 1 : 0;
   N = (NewPS & NegativeBit) ? 1 : 0;
  }
- const Byte GetPS() {
+ Byte GetPS() const {
   Byte PS = 0;
   if (C) PS |= CarryBit;
   if (Z) PS |= ZeroBit;
@@ -67,17 +71,42 @@ public:
  Byte Y;  // Y Register
 
  int32_t Cycles;
+ uint64_t TotalCycles      = 0;  // Cycles eaten since reset
+ uint64_t InstructionStart = 0;  // TotalCycles when the running instruction or interrupt entry began
 
  struct CPU_65XX_PS PS;  // Processor status
 
+ InterruptLines Lines;
+
+ TraceBuffer* Trace = nullptr;
+ CallGraph* Calls   = nullptr;  // Fed by JSR/RTS/BRK/RTI and interrupts when set
+ Word LastAddress;  // Effective address of the last memory operand, for the trace
+
+ bool Waiting   = false;  // Parked on WAI, PC still points at it
+ bool Stopped   = false;  // STP, only a reset starts the clock again
+ bool BusCycles = false;  // Set by the CPU_BUS_EXACT tables, see EatCycles
+
+ PROFILE(Profiler Profile;)
+
  void Reset(Memory& mem);
+ bool ServiceInterrupt(Memory& mem);
+ void Interrupt(Memory& mem, Word Vector);
+ TraceRecord& TraceInstruction(Memory& mem, Byte Kind = TRACE_INSTRUCTION);
+ // The instruction level timing: the cost of the work between the accesses,
+ // spread over the instruction bodies. Nothing with BusCycles set, there every
+ // bus access is one cycle and the dummy accesses pay for the rest
  int32_t EatCycles(int32_t amount);
+ // Time that passes at any accuracy: the bus accesses themselves and a CPU
+ // that is stopped or asleep
+ int32_t Tick(int32_t amount);
 
+ Byte FetchOpcode(Memory& mem);
  Byte FetchByte(Memory& mem);
  Word FetchWord(Memory& mem);
 
  Byte ReadByte(Memory& mem, Word Address);
  Word ReadWord(Memory& mem, Word Address);
+ Word ReadZPWord(Memory& mem, Byte Address);  // Pointer in zero page, the high byte wraps to $00
 
  void WriteByte(Memory& mem, Word Address, Byte Value);
  void WriteWord(Memory& mem, Word Address, Word Value);
@@ -93,25 +122,21 @@ public:
 
  Word FetchINAddressX(Memory& Memory);
  Word FetchINAddressY(Memory& Memory);
+ Word FetchINAddress(Memory& Memory);  // 65C02 (zp)
 
  // private:
  void SetZeroNegativeFlags(Byte Value);
 
  void ConditionalBranch(Memory& mem, bool Value, bool Needed);
 
- void ADC(Byte Operand);
+ // CMOS picks the 65C02 decimal mode: valid N and Z and one more cycle
+ void AddWithCarry(Byte Operand, bool CMOS = false);  // ADC without the cycle, for the combined opcodes
+ void SubtractWithBorrow(Byte Operand, bool CMOS = false);
+ void ADC(Byte Operand, bool CMOS = false);
  void AND(Byte Operand);
  Byte ASL(Byte Value);
- void BCC(Memory& mem);
- void BCS(Memory& mem);
- void BEQ(Memory& mem);
  void BIT(Memory& mem, Word Address);
- void BMI(Memory& mem);
- void BNE(Memory& mem);
- void BPL(Memory& mem);
  void BRK(Memory& mem);
- void BVC(Memory& mem);
- void BVS(Memory& mem);
  void CLC();
  void CLD();
  void CLI();
@@ -119,15 +144,15 @@ public:
  void CMP(Byte Operand);
  void CPX(Byte Operand);
  void CPY(Byte Operand);
- void DEC(Memory& mem, Word Address);
+ Byte DEC(Byte Value);
  void DEX();
  void DEY();
  void EOR(Byte Value);
- void INC(Memory& mem, Word Address);
+ Byte INC(Byte Value);
  void INX();
  void INY();
  void JMP(Word Address);
- void JSR(Memory& mem);
+ void JSR(Memory& mem, Byte Low);
  void LDA(Byte Value);
  void LDX(Byte Value);
  void LDY(Byte Value);
@@ -136,25 +161,52 @@ public:
  void ORA(Byte Value);
  void PHA(Memory& mem);
  void PHP(Memory& mem);
+ void PHX(Memory& mem);
+ void PHY(Memory& mem);
  void PLA(Memory& mem);
  void PLP(Memory& mem);
+ void PLX(Memory& mem);
+ void PLY(Memory& mem);
+ Byte RMB(Byte Value, Byte Bit);
  Byte ROL(Byte Value);
  Byte ROR(Byte Value);
  void RTI(Memory& mem);
  void RTS(Memory& mem);
- void SBC(Byte Operand);
+ void SBC(Byte Operand, bool CMOS = false);
  void SEC();
  void SED();
  void SEI();
+ Byte SMB(Byte Value, Byte Bit);
  void STA(Memory& mem, Word Address);
  void STX(Memory& mem, Word Address);
  void STY(Memory& mem, Word Address);
+ void STZ(Memory& mem, Word Address);
+ void STP();
  void TAX();
  void TAY();
+ Byte TRB(Byte Value);
+ Byte TSB(Byte Value);
+ bool TestBit(Memory& mem, Byte Bit);  // BBR/BBS
  void TSX();
  void TXA();
  void TXS();
  void TYA();
+ void WAI();
+
+ // Undocumented NMOS, see ops_6502x.h
+ void ALR(Byte Operand);
+ void ANC(Byte Operand);
+ void ARR(Byte Operand);
+ Byte DCP(Byte Value);
+ Byte ISC(Byte Value);
+ void LAS(Byte Value);
+ void LAX(Byte Value);
+ Byte RLA(Byte Value);
+ Byte RRA(Byte Value);
+ void SAX(Memory& mem, Word Address);
+ void SBX(Byte Operand);
+ Byte SLO(Byte Value);
+ Byte SRE(Byte Value);
 };
 
 #endif
\ No newline at end of file
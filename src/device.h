@@ -0,0 +1,27 @@
+#ifndef _DEVICE_H_
+#define _DEVICE_H_
+
+#include <cstdint>
+
+#include "common.h"
+
+// Memory mapped peripheral. Pages covered by a device are trapped, so the
+// CPU reaches it through Memory's slow path while plain RAM stays untouched
+struct MemoryDevice {
+ Word Begin;
+ Word End;  // Inclusive
+
+ MemoryDevice(Word begin, Word end) : Begin(begin), End(end) {}
+ virtual ~MemoryDevice() {}
+
+ virtual Byte Read(Word Address)              = 0;
+ virtual void Write(Word Address, Byte Value) = 0;
+ // The byte Memory::Peek shows for Address, when the device keeps one. By
+ // default Data under the device is shown, registers have no side to peek
+ virtual const Byte* Peek(Word) const { return nullptr; }
+};
+
+// A device covers Base to Base + Size - 1 and may not wrap past $FFFF
+inline bool DeviceFits(int32_t Base, uint32_t Size) { return Base >= 0 && (uint32_t)Base + Size <= 0x10000; }
+
+#endif
@@ -0,0 +1,116 @@
+#include "diffexec.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "common.h"
+#include "disasm.h"
+
+DiffRunner::DiffRunner(const Memory& Image, Word Start, uint64_t checkpoint, int Variant, int IllegalPolicy, bool BusExact) : Reference(new Machine()), Fast(new Machine()), Checkpoint(checkpoint ? checkpoint : 1), SavedMemory(MAX_MEM) {
+ for (Machine* M : {Reference.get(), Fast.get()}) {
+  M->Reset();
+  memcpy(M->Mem.Data, Image.Data, MAX_MEM);
+  M->Cpu.PC            = Start;
+  M->Cpu.A             = 0;  // Reset leaves them as they were, both sides must agree
+  M->Cpu.X             = 0;
+  M->Cpu.Y             = 0;
+  M->Cpu.Variant       = Variant;
+  M->Cpu.IllegalPolicy = IllegalPolicy;
+ }
+ // The fast side runs the bus exact tables, checked against the reference
+ // switch which is always instruction level
+ Fast->Cpu.BusExact = BusExact;
+}
+
+void DiffRunner::Step() {
+ Reference->Cpu.Execute(1, Reference->Mem);
+ Fast->Cpu.ExecuteFast(1, Fast->Mem);
+ Instructions++;
+}
+
+// The bus exact tables count cycles the datasheet's way, which the
+// instruction level reference does not, so their cycles are not compared
+bool DiffRunner::SameRegisters() {
+ CPU_6502& a = Reference->Cpu;
+ CPU_6502& b = Fast->Cpu;
+ return a.PC == b.PC && a.A == b.A && a.X == b.X && a.Y == b.Y && a.SP == b.SP && (a.TotalCycles == b.TotalCycles || b.BusExact) && a.PS.GetPS() == b.PS.GetPS();
+}
+
+bool DiffRunner::SameMemory() const { return memcmp(Reference->Mem.Data, Fast->Mem.Data, MAX_MEM) == 0; }
+
+void DiffRunner::Save() {
+ SavedCpu = Reference->Cpu;
+ memcpy(SavedMemory.data(), Reference->Mem.Data, MAX_MEM);
+ SavedInstructions = Instructions;
+}
+
+void DiffRunner::Restore() {
+ for (Machine* M : {Reference.get(), Fast.get()}) {
+  bool BusExact   = M->Cpu.BusExact;  // The one setting the two sides differ in
+  M->Cpu          = SavedCpu;
+  M->Cpu.BusExact = BusExact;
+  memcpy(M->Mem.Data, SavedMemory.data(), MAX_MEM);
+ }
+ Instructions = SavedInstructions;
+}
+
+bool DiffRunner::Run(uint64_t Cycles) {
+ Save();
+ while (Reference->Cpu.TotalCycles < Cycles) {
+  Step();
+  bool AtCheckpoint = Instructions - SavedInstructions == Checkpoint;
+  if (SameRegisters() && (!AtCheckpoint || SameMemory())) {
+   if (AtCheckpoint) Save();
+   // Neither engine gets past an illegal opcode, there is nothing more to compare
+   if (Reference->Cpu.StopReason == STOP_ILLEGAL) {
+    printf("Illegal opcode 0x%02x at PC 0x%04x\n", Reference->Cpu.StopOpcode, Reference->Cpu.PC);
+    break;
+   }
+   continue;
+  }
+
+  // Replay from the checkpoint with memory compared every step
+  Restore();
+  Word PC;
+  Byte Bytes[3];
+  do {
+   PC = Reference->Cpu.PC;
+   for (Word i = 0; i < 3; i++) Bytes[i] = Reference->Mem[(Word)(PC + i)];
+   Step();
+  } while (SameRegisters() && SameMemory() && Reference->Cpu.StopReason != STOP_ILLEGAL);
+
+  Report(PC, Bytes);
+  return false;
+ }
+
+ printf("No divergence in %llu instructions, %llu cycles\n", (unsigned long long)Instructions, (unsigned long long)Reference->Cpu.TotalCycles);
+ return true;
+}
+
+void DiffRunner::Report(Word PC, const Byte* Bytes) const {
+ CPU_6502& a = Reference->Cpu;
+ CPU_6502& b = Fast->Cpu;
+
+ char Text[48];
+ FormatInstruction(Decode(PC, Bytes, Reference->Cpu.Variant), Text, sizeof(Text));
+ printf("Divergence at instruction %llu, PC %04x: %s\n", (unsigned long long)Instructions, PC, Text);
+
+ printf("%-8s %10s %10s\n", "", "Reference", "Fast");
+ printf("%-8s %10x %10x%s\n", "PC", a.PC, b.PC, a.PC != b.PC ? "  *" : "");
+ printf("%-8s %10x %10x%s\n", "A", a.A, b.A, a.A != b.A ? "  *" : "");
+ printf("%-8s %10x %10x%s\n", "X", a.X, b.X, a.X != b.X ? "  *" : "");
+ printf("%-8s %10x %10x%s\n", "Y", a.Y, b.Y, a.Y != b.Y ? "  *" : "");
+ printf("%-8s %10x %10x%s\n", "SP", a.SP, b.SP, a.SP != b.SP ? "  *" : "");
+ printf("%-8s %10x %10x%s\n", "P", a.PS.GetPS(), b.PS.GetPS(), a.PS.GetPS() != b.PS.GetPS() ? "  *" : "");
+ printf("%-8s %10llu %10llu%s\n", "Cycles", (unsigned long long)a.TotalCycles, (unsigned long long)b.TotalCycles, a.TotalCycles != b.TotalCycles ? "  *" : "");
+
+ size_t Lines = 0;
+ for (uint32_t Address = 0; Address < MAX_MEM; Address++) {
+  if (Reference->Mem.Data[Address] == Fast->Mem.Data[Address]) continue;
+  if (Lines++ == DIFF_MAX_MEMORY_LINES) {
+   printf("...\n");
+   break;
+  }
+  printf("$%04x    %10x %10x  *\n", Address, Reference->Mem.Data[Address], Fast->Mem.Data[Address]);
+ }
+}
@@ -0,0 +1,47 @@
+#ifndef _DIFFEXEC_H_
+#define _DIFFEXEC_H_
+
+#include <memory>
+#include <vector>
+
+#include <cstdint>
+
+#include "common.h"
+#include "cpu_6502.h"
+#include "machine.h"
+#include "memory.h"
+
+constexpr size_t DIFF_MAX_MEMORY_LINES = 16;
+
+// Runs the reference interpreter (Execute) and the fast engine (ExecuteFast)
+// in lockstep on two copies of the same machine. Registers and cycle counts
+// are compared after every instruction, memory every Checkpoint instructions.
+// On a mismatch both machines go back to the last good checkpoint and replay
+// comparing memory after every instruction, so the report names the first
+// instruction that diverged. Only CPU and RAM take part, devices keep state
+// of their own that a checkpoint cannot restore. Both engines expand the
+// bodies in ops_6502.h, so a bug in a body shows up on both sides alike
+struct DiffRunner {
+ std::unique_ptr<Machine> Reference;
+ std::unique_ptr<Machine> Fast;
+ uint64_t Checkpoint;
+ uint64_t Instructions = 0;
+
+ CPU_6502 SavedCpu;  // Both engines match at a checkpoint, one copy is enough
+ std::vector<Byte> SavedMemory;
+ uint64_t SavedInstructions = 0;
+
+ DiffRunner(const Memory& Image, Word Start, uint64_t checkpoint, int Variant = CPU_NMOS, int IllegalPolicy = ILLEGAL_HALT, bool BusExact = false);
+
+ // True when Cycles passed without a divergence, else the report is printed
+ bool Run(uint64_t Cycles);
+
+ void Step();
+ bool SameRegisters();
+ bool SameMemory() const;
+ void Save();
+ void Restore();
+ void Report(Word PC, const Byte* Bytes) const;
+};
+
+#endif
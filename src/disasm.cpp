@@ -0,0 +1,93 @@
+#include "disasm.h"
+
+#include <cstdio>
+
+#include "common.h"
+
+Instruction Decode(Word Address, const Byte* Bytes, int Variant) {
+ const InstructionInfo& Info = GetInstruction(Bytes[0], Variant);
+ Instruction Ins;
+ Ins.Address    = Address;
+ Ins.Opcode     = Bytes[0];
+ Ins.Mode       = Info.Mode;
+ Ins.Length     = InstructionLength(Info.Mode);
+ Ins.Mnemonic   = Info.Mnemonic;
+ Ins.Operand[0] = Ins.Length > 1 ? Bytes[1] : 0;
+ Ins.Operand[1] = Ins.Length > 2 ? Bytes[2] : 0;
+
+ if (Ins.Mode == MODE_REL)
+  Ins.Value = Address + 2 + (SignByte)Ins.Operand[0];
+ else if (Ins.Mode == MODE_ZPR)
+  Ins.Value = Address + 3 + (SignByte)Ins.Operand[1];
+ else
+  Ins.Value = Ins.Operand[0] | (Ins.Operand[1] << 8);
+ return Ins;
+}
+
+size_t FormatInstruction(const Instruction& Ins, char* Buffer, size_t Size, const SymbolTable* Symbols) {
+ char Operand[40];
+ const Symbol* Label = nullptr;
+ if (Symbols && (Ins.Mode == MODE_AB || Ins.Mode == MODE_ABX || Ins.Mode == MODE_ABY || Ins.Mode == MODE_IN || Ins.Mode == MODE_INAX || Ins.Mode == MODE_REL || Ins.Mode == MODE_ZPR)) {
+  Label = Symbols->Lookup(Ins.Value);
+  if (Label && Label->Address != Ins.Value) Label = nullptr;
+ }
+
+ if (Label)
+  snprintf(Operand, sizeof(Operand), "%.32s", Label->Name.c_str());
+ else
+  snprintf(Operand, sizeof(Operand), Ins.Length == 3 || Ins.Mode == MODE_REL ? "$%04x" : "$%02x", Ins.Value);
+
+ switch (Ins.Mode) {
+ case MODE_NONE:
+  return snprintf(Buffer, Size, ".byte $%02x", Ins.Opcode);
+ case MODE_IMPL:
+  return snprintf(Buffer, Size, "%s", Ins.Mnemonic);
+ case MODE_ACC:
+  return snprintf(Buffer, Size, "%s A", Ins.Mnemonic);
+ case MODE_IM:
+  return snprintf(Buffer, Size, "%s #%s", Ins.Mnemonic, Operand);
+ case MODE_ZPX:
+ case MODE_ABX:
+  return snprintf(Buffer, Size, "%s %s,X", Ins.Mnemonic, Operand);
+ case MODE_ZPY:
+ case MODE_ABY:
+  return snprintf(Buffer, Size, "%s %s,Y", Ins.Mnemonic, Operand);
+ case MODE_IN:
+ case MODE_INZ:
+  return snprintf(Buffer, Size, "%s (%s)", Ins.Mnemonic, Operand);
+ case MODE_INX:
+ case MODE_INAX:
+  return snprintf(Buffer, Size, "%s (%s,X)", Ins.Mnemonic, Operand);
+ case MODE_INY:
+  return snprintf(Buffer, Size, "%s (%s),Y", Ins.Mnemonic, Operand);
+ case MODE_ZPR:
+  return snprintf(Buffer, Size, "%s $%02x,%s", Ins.Mnemonic, Ins.Operand[0], Operand);
+ }
+ return snprintf(Buffer, Size, "%s %s", Ins.Mnemonic, Operand);
+}
+
+Disassembler::Disassembler(const SymbolTable* symbols, int variant) : Symbols(symbols), Variant(variant), Cache(MAX_MEM) {}
+
+const Disassembler::Entry& Disassembler::Lookup(Word Address, const Byte* Bytes) {
+ Entry& Cached = Cache[Address];
+ if (Cached.Valid && Cached.Ins.Opcode == Bytes[0] && (Cached.Ins.Length < 2 || Cached.Ins.Operand[0] == Bytes[1]) && (Cached.Ins.Length < 3 || Cached.Ins.Operand[1] == Bytes[2])) {
+  Hits++;
+  return Cached;
+ }
+
+ Misses++;
+ Cached.Ins = Decode(Address, Bytes, Variant);
+ FormatInstruction(Cached.Ins, Cached.Text, sizeof(Cached.Text), Symbols);
+ Cached.Valid = true;
+ return Cached;
+}
+
+const Disassembler::Entry& Disassembler::Lookup(const Memory& mem, Word Address) {
+ Byte Bytes[3] = {mem.Peek(Address), mem.Peek(Address + 1), mem.Peek(Address + 2)};
+ return Lookup(Address, Bytes);
+}
+
+// A write to Address can change the instruction starting there or at the two before it
+void Disassembler::Invalidate(Word Address, uint32_t Length) {
+ for (uint32_t i = 0; i < Length + 2; i++) Cache[(Word)(Address - 2 + i)].Valid = false;
+}
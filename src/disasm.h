@@ -0,0 +1,62 @@
+#ifndef _DISASM_H_
+#define _DISASM_H_
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+#include "ins_65xx.h"
+#include "memory.h"
+#include "symbols.h"
+
+// One decoded instruction. Value is the operand as the mode uses it: the
+// immediate, the zero page or absolute base address, or the branch target
+struct Instruction {
+ Word Address;
+ Byte Opcode;
+ Byte Operand[2];
+ Byte Mode;    // MODE_*
+ Byte Length;  // 1-3 bytes
+ const char* Mnemonic;
+ Word Value;
+};
+
+// Bytes holds at least Length bytes starting with the opcode. Variant is the
+// CPU_* whose opcode set to decode with
+Instruction Decode(Word Address, const Byte* Bytes, int Variant = 0);
+
+// Assembler syntax, e.g. "LDA ($12),Y" or "JSR main". Absolute operands that
+// exactly match a label are printed by name when Symbols is given
+size_t FormatInstruction(const Instruction& Ins, char* Buffer, size_t Size, const SymbolTable* Symbols = nullptr);
+
+// Per-address cache of decoded and formatted instructions. An entry remembers
+// the bytes it was decoded from and is thrown away when they no longer match,
+// so code written after it was cached is decoded again
+struct Disassembler {
+ struct Entry {
+  Instruction Ins;
+  char Text[48];
+  bool Valid;
+ };
+
+ const SymbolTable* Symbols;
+ int Variant;
+ std::vector<Entry> Cache;
+ uint64_t Hits   = 0;
+ uint64_t Misses = 0;
+
+ Disassembler(const SymbolTable* symbols = nullptr, int variant = 0);
+
+ const Entry& Lookup(Word Address, const Byte* Bytes);
+ // Goes through Memory::Peek, so devices see no reads
+ const Entry& Lookup(const Memory& mem, Word Address);
+
+ // Drops the entries a write of Length bytes at Address can affect. Called
+ // for writes from outside the CPU (DMA, host pokes) rather than leaving it
+ // to the byte compare
+ void Invalidate(Word Address, uint32_t Length = 1);
+};
+
+#endif
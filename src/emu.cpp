@@ -4,25 +4,144 @@
 #include <sys/types.h>
 #include <thread>
 
+#include "block_device.h"
+#include "callgraph.h"
 #include "common.h"
+#include "console.h"
 #include "cpu_6502.h"
+#include "diffexec.h"
+#include "disasm.h"
+#include "framebuffer.h"
+#include "heatmap.h"
+#include "machine.h"
+#include "monitor.h"
+#include "multicore.h"
 #include "parser.h"
+#include "sampler.h"
+#include "shm_export.h"
+#include "symbols.h"
+#include "trace.h"
+#include "via_6522.h"
+#include "watchpoint.h"
 
 int32_t workCycles = 1000;
 uint32_t startPC   = 0x8000;
 uint32_t tickSpeed = 0;
 
 std::string binPath = "program.bin";
+std::vector<std::string> watchSpecs;
+std::string shmName;
+int32_t consoleAddress = -1;
+std::string consolePath;
+int32_t viaAddress = -1;
+int32_t framebufferAddress = -1;
+std::vector<uint64_t> dumpCycles;
+int32_t blockAddress = -1;
+std::string blockPath;
+uint64_t blockSectorCycles = BLOCK_DEFAULT_SECTOR_CYCLES;
+std::string tracePath;
+std::string tracePolicy = "block";
+std::string profilePath;
+uint64_t sampleInterval = 0;
+std::string symbolPath;
+std::string callGraphPath;
+std::string heatMapPath;
+uint32_t heatMapBucket = 1;
+std::string engineName = "reference";
+uint64_t diffCheckpoint = 0;
+std::string cpuVariant = "6502";
+std::string illegalPolicy = "halt";
+std::string busAccuracy   = "instruction";
+std::string monitorPath;
+std::vector<std::string> coreSpecs;
+std::vector<std::string> sharedSpecs;
+std::string multiMode = "parallel";
+
+// Runs core 0 from the usual image and one more core per -K
+// <image>[@<pc>], all set up like cpu, sharing the -X ranges
+static int RunCores(const CPU_6502& cpu, bool Fast) {
+ MultiMachine System;
+ if ((System.Mode = ParseMultiMode(multiMode)) < 0) {
+  printf("Unknown multi-CPU mode: %s\n", multiMode.c_str());
+  return 1;
+ }
+
+ std::vector<std::string> Images = {binPath};
+ std::vector<Word> Starts        = {(Word)startPC};
+ for (const std::string& Spec : coreSpecs) {
+  size_t At      = Spec.find('@');
+  uint32_t Start = startPC;
+  if (At == 0 || (At != std::string::npos && !ParseHex(Spec.substr(At + 1), 0xFFFF, Start))) {
+   printf("Bad core '%s', use -K <image>[@<pc>] with the PC in hex\n", Spec.c_str());
+   return 1;
+  }
+  Images.push_back(Spec.substr(0, At));
+  Starts.push_back(Start);
+ }
+
+ for (size_t Core = 0; Core < Images.size(); Core++) {
+  Machine& M = System.AddCore();
+  M.Reset();
+  std::ifstream Image(Images[Core], std::ios::binary);
+  if (!Image.is_open()) {
+   printf("Cannot open %s\n", Images[Core].c_str());
+   return 1;
+  }
+  M.Mem.ReadProgram(Image, 0x0, 0xFFFF);
+  M.Fast              = Fast;
+  M.Cpu.Variant       = cpu.Variant;
+  M.Cpu.IllegalPolicy = cpu.IllegalPolicy;
+  M.Cpu.BusExact      = cpu.BusExact;
+  M.Cpu.A             = 0;
+  M.Cpu.X             = 0;
+  M.Cpu.Y             = 0;
+  M.Cpu.PC            = Starts[Core];
+ }
+
+ for (const std::string& Spec : sharedSpecs) {
+  size_t Dash = Spec.find('-');
+  uint32_t Begin, End;
+  bool Ok = ParseHex(Spec.substr(0, Dash), 0xFFFF, Begin);
+  End     = Begin;
+  if (Ok && Dash != std::string::npos) Ok = ParseHex(Spec.substr(Dash + 1), 0xFFFF, End);
+  if (!Ok || Begin > End) {
+   printf("Bad shared range '%s', use -X <begin>[-<end>] in hex\n", Spec.c_str());
+   return 1;
+  }
+  System.Share(Begin, End);
+ }
+
+ auto Started = std::chrono::steady_clock::now();
+ uint64_t Ran = System.Run(workCycles > 0 ? workCycles : 0);
+ double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Started).count();
+
+ for (size_t Core = 0; Core < System.Cores.size(); Core++) {
+  CPU_6502& Cpu = System.Cores[Core]->Cpu;
+  printf("Core %zu: PC 0x%04x A 0x%02x X 0x%02x Y 0x%02x SP 0x%02x P 0x%02x, %llu cycles\n", Core, Cpu.PC, Cpu.A, Cpu.X, Cpu.Y, Cpu.SP, Cpu.PS.GetPS(), (unsigned long long)Cpu.TotalCycles);
+  if (Cpu.StopReason == STOP_ILLEGAL) printf("Core %zu: illegal opcode 0x%02x at PC 0x%04x\n", Core, Cpu.StopOpcode, Cpu.PC);
+ }
+
+ // FNV-1a over the shared pages, equal runs give equal sums
+ uint32_t Sum = 2166136261u;
+ for (size_t Address = 0; Address < MAX_MEM; Address++) {
+  if (!System.SharedPage[Address >> 8]) continue;
+  Sum = (Sum ^ System.Shared[Address]) * 16777619u;
+ }
+ printf("Shared pages checksum 0x%08x\n", Sum);
+ printf("%llu cycles on %zu cores in %.3f s (%s)\n", (unsigned long long)Ran, System.Cores.size(), Seconds, multiMode.c_str());
+ return 0;
+}
 
 int main(int argc, char** argv) {
- CPU_6502 cpu;
- Memory mem;
+ Machine M;
+ CPU_6502& cpu = M.Cpu;
+ Memory& mem   = M.Mem;
 
- if (!argv[1]) {
+ if (argc < 2) {
   printf("Usage: emulator [program] [Cycles]\n");
   return 1;
  }
- cpu.Reset(mem);
+ M.Reset();
 
  parseArgs(argv);
 
@@ -30,12 +149,152 @@ int main(int argc, char** argv) {
  mem.ReadProgram(binFile, 0x0, 0xFFFF);
  binFile.close();
 
+ if (engineName == "fast")
+  M.Fast = true;
+ else if (engineName != "reference") {
+  printf("Unknown engine: %s\n", engineName.c_str());
+  return 1;
+ }
+ if ((cpu.Variant = ParseCPUVariant(cpuVariant)) < 0) {
+  printf("Unknown CPU: %s\n", cpuVariant.c_str());
+  return 1;
+ }
+ // Nothing to call back into from the command line
+ if ((cpu.IllegalPolicy = ParseIllegalPolicy(illegalPolicy)) < 0 || cpu.IllegalPolicy == ILLEGAL_CALLBACK) {
+  printf("Unknown illegal opcode policy: %s\n", illegalPolicy.c_str());
+  return 1;
+ }
+ if (busAccuracy == "bus")
+  cpu.BusExact = true;
+ else if (busAccuracy != "instruction") {
+  printf("Unknown bus accuracy: %s\n", busAccuracy.c_str());
+  return 1;
+ }
+
+ // Checks the fast engine against the reference instead of a normal run.
+ // Execute() only has its own switch for NMOS, for the other variants it runs
+ // the same table and there would be nothing to compare. With -A bus only the
+ // fast side runs the bus exact tables, the reference stays on its switch
+ if (diffCheckpoint) {
+  if (cpu.Variant != CPU_NMOS) {
+   printf("-D needs -C 6502, the reference has no switch of its own for %s\n", cpuVariant.c_str());
+   return 1;
+  }
+  DiffRunner Diff(mem, startPC, diffCheckpoint, cpu.Variant, cpu.IllegalPolicy, cpu.BusExact);
+  return Diff.Run(workCycles) ? 0 : 1;
+ }
+
+ if (!coreSpecs.empty()) return RunCores(cpu, M.Fast);
+
+ for (const std::string& Spec : watchSpecs) {
+  Watchpoint Watch;
+  if (!ParseWatchpoint(Spec, Watch)) {
+   printf("Bad watchpoint '%s'\n", Spec.c_str());
+   return 1;
+  }
+  mem.AddWatchpoint(Watch);
+ }
+
+ // Their ranges would wrap past $FFFF into zero page
+ const struct {
+  const char* Name;
+  int32_t Base;
+  uint32_t Size;
+ } Mapped[] = {{"Console", consoleAddress, CONSOLE_SIZE}, {"VIA", viaAddress, VIA_SIZE}, {"Framebuffer", framebufferAddress, FB_SIZE}, {"Block device", blockAddress, BLOCK_SIZE}};
+ for (const auto& Device : Mapped) {
+  if (Device.Base >= 0 && !DeviceFits(Device.Base, Device.Size)) {
+   printf("%s at 0x%04x does not fit below $FFFF\n", Device.Name, Device.Base);
+   return 1;
+  }
+ }
+
+ FILE* ConsoleOut = stdout;
+ if (!consolePath.empty() && !(ConsoleOut = fopen(consolePath.c_str(), "wb"))) {
+  perror(consolePath.c_str());
+  return 1;
+ }
+ ConsoleDevice Console(consoleAddress, M.Sched, ConsoleOut);
+ if (consoleAddress >= 0) mem.AttachDevice(&Console);
+
+ VIA_6522 Via(viaAddress, M.Sched, cpu.Lines);
+ if (viaAddress >= 0) mem.AttachDevice(&Via);
+
+ FramebufferDevice Framebuffer(framebufferAddress);
+ if (framebufferAddress >= 0) {
+  mem.AttachDevice(&Framebuffer);
+  for (uint64_t Cycle : dumpCycles) {
+   uint32_t Event = M.Sched.Register([&Framebuffer, Cycle](uint64_t) {
+    char Path[32];
+    snprintf(Path, sizeof(Path), "frame_%llx.ppm", (unsigned long long)Cycle);
+    Framebuffer.DumpPPM(Path);
+   });
+   M.Sched.Schedule(Event, Cycle);
+  }
+ }
+
+ BlockDevice Disk(blockAddress, mem, M.Sched, cpu.Lines, blockSectorCycles);
+ if (blockAddress >= 0) {
+  if (!blockPath.empty() && !Disk.Open(blockPath)) return 1;
+  mem.AttachDevice(&Disk);
+ }
+
+ SharedExport Export;
+ if (!shmName.empty()) {
+  if (!Export.Open(shmName, mem)) return 1;
+  Export.StartPublishing(M.Sched, cpu);
+ }
+
+ TraceBuffer Trace;
+ if (!tracePath.empty()) {
+  int Policy = ParseTracePolicy(tracePolicy);
+  if (Policy < 0) {
+   printf("Unknown trace overflow policy: %s\n", tracePolicy.c_str());
+   return 1;
+  }
+  if (!Trace.Open(tracePath, Policy)) return 1;
+  cpu.Trace = &Trace;
+ }
+
+ SymbolTable Symbols;
+ if (!symbolPath.empty() && !Symbols.Load(symbolPath)) return 1;
+
+ Disassembler Disasm(&Symbols, cpu.Variant);
+ mem.Disasm = &Disasm;
+
+ HeatMap Heat(heatMapPath.empty() ? MAX_MEM : heatMapBucket);
+ if (!heatMapPath.empty()) mem.AttachHeatMap(&Heat);
+
+ PCSampler Sampler(M.Sched, cpu, sampleInterval);
+ if (sampleInterval) Sampler.Start();
+
  cpu.PC = startPC;
 
- Word loop;
- for (; workCycles > 0; workCycles--) {
+ CallGraph Calls;
+ if (!callGraphPath.empty()) {
+  Calls.Start(cpu.TotalCycles, cpu.PC);
+  cpu.Calls = &Calls;
+ }
+
+ // The machine runs on a thread of its own, the monitor talks to it
+ if (!monitorPath.empty() && workCycles > 0) {
+  if (!RunMonitor(M, workCycles, monitorPath)) return 1;
+  workCycles = 0;
+  if (mem.Break) printf("Watchpoint: %s 0x%04x = 0x%02x, PC 0x%04x\n", WatchKindName(mem.LastHit.Kind), mem.LastHit.Address, mem.LastHit.Value, cpu.PC);
+  if (cpu.StopReason == STOP_ILLEGAL) printf("Illegal opcode 0x%02x at PC 0x%04x\n", cpu.StopOpcode, cpu.PC);
+ }
+ while (workCycles > 0) {
   //  Word OldPc = cpu.PC;
-  cpu.Execute(1, mem);
+  // Without a tick delay run freely, device events slice the run as needed
+  workCycles -= M.Run(tickSpeed ? 1 : workCycles);
+
+  if (mem.Break) {
+   printf("Watchpoint: %s 0x%04x = 0x%02x, PC 0x%04x\n", WatchKindName(mem.LastHit.Kind), mem.LastHit.Address, mem.LastHit.Value, cpu.PC);
+   break;
+  }
+  if (cpu.StopReason == STOP_ILLEGAL) {
+   printf("Illegal opcode 0x%02x at PC 0x%04x\n", cpu.StopOpcode, cpu.PC);
+   break;
+  }
 
   // Check PC loop
   //   if (OldPc == cpu.PC)
@@ -43,6 +302,26 @@ int main(int argc, char** argv) {
   //   if (loop > 5)
   //    break;
 
-  std::this_thread::sleep_for(std::chrono::nanoseconds(tickSpeed));
+  if (tickSpeed) std::this_thread::sleep_for(std::chrono::nanoseconds(tickSpeed));
+ }
+ Export.Close(mem);
+ Trace.Close();
+ if (Trace.Dropped || Trace.Stalls) printf("Trace: %llu records, %llu dropped, %llu stalls\n", (unsigned long long)Trace.Total, (unsigned long long)Trace.Dropped, (unsigned long long)Trace.Stalls);
+ Console.Flush();
+ if (sampleInterval) Sampler.Report(stdout, Symbols, Disasm, mem);
+ if (mem.Heat) {
+  Heat.Report(stdout, Symbols);
+  Heat.DumpPPM(heatMapPath);
+ }
+ if (cpu.Calls) {
+  Calls.Finish(cpu.TotalCycles);
+  Calls.Report(stdout, Symbols);
+  Calls.WriteCollapsed(callGraphPath, Symbols);
  }
+#ifdef EMU_PROFILE
+ if (!profilePath.empty()) cpu.Profile.Report(profilePath, cpu.Variant);
+#else
+ if (!profilePath.empty()) printf("Profiler is not compiled in, rebuild with make PROFILE=1\n");
+#endif
+ if (ConsoleOut != stdout) fclose(ConsoleOut);
 }
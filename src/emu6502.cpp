@@ -0,0 +1,251 @@
+#include "emu6502.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <memory>
+#include <vector>
+
+#include "common.h"
+#include "emu_thread.h"
+#include "machine.h"
+
+struct emu6502 {
+ Machine M;
+ Byte IRQSource;
+ std::unique_ptr<EmulationThread> Thread;  // Threaded mode, after emu6502_start
+
+ emu6502() { IRQSource = M.Cpu.Lines.AllocateIRQ(); }
+};
+
+uint32_t emu6502_api_version(void) { return EMU6502_API_VERSION; }
+
+emu6502* emu6502_create(void) {
+ emu6502* emu = new emu6502();
+ memset(emu->M.Mem.Data, 0, MAX_MEM);
+ emu6502_reset(emu);
+ return emu;
+}
+
+void emu6502_destroy(emu6502* emu) { delete emu; }
+
+void emu6502_reset(emu6502* emu) {
+ CPU_6502& Cpu   = emu->M.Cpu;
+ Memory& Mem     = emu->M.Mem;
+ Cpu.SP          = 0xFF;
+ Cpu.A           = 0;
+ Cpu.X           = 0;
+ Cpu.Y           = 0;
+ Cpu.PS          = CPU_65XX_PS::UnusedBit | CPU_65XX_PS::InterruptDisableBit;
+ Cpu.TotalCycles = 0;
+ Cpu.Waiting     = false;
+ Cpu.Stopped     = false;
+ Cpu.StopReason  = STOP_NONE;
+ Cpu.Lines.Signal &= ~(INTERRUPT_NMI | INTERRUPT_STOP);
+ Cpu.PC = Mem[RESET_VECTOR] | (Mem[RESET_VECTOR + 1] << 8);
+}
+
+size_t emu6502_load(emu6502* emu, uint16_t address, const void* data, size_t size) {
+ if (size > MAX_MEM - address) size = MAX_MEM - address;
+ memcpy(emu->M.Mem.Data + address, data, size);
+ return size;
+}
+
+long emu6502_load_file(emu6502* emu, uint16_t address, const char* path) {
+ FILE* File = fopen(path, "rb");
+ if (!File) return -1;
+ size_t Loaded = fread(emu->M.Mem.Data + address, 1, MAX_MEM - address, File);
+ fclose(File);
+ return Loaded;
+}
+
+uint64_t emu6502_run(emu6502* emu, uint64_t cycles) { return emu->M.Run(cycles); }
+
+void emu6502_read(emu6502* emu, uint16_t address, void* data, size_t size) {
+ Byte* Out = (Byte*)data;
+ while (size) {
+  size_t Chunk = size < MAX_MEM - address ? size : MAX_MEM - address;
+  memcpy(Out, emu->M.Mem.Data + address, Chunk);
+  Out += Chunk;
+  size -= Chunk;
+  address = 0;
+ }
+}
+
+void emu6502_write(emu6502* emu, uint16_t address, const void* data, size_t size) {
+ const Byte* In = (const Byte*)data;
+ while (size) {
+  size_t Chunk = size < MAX_MEM - address ? size : MAX_MEM - address;
+  memcpy(emu->M.Mem.Data + address, In, Chunk);
+  In += Chunk;
+  size -= Chunk;
+  address = 0;
+ }
+}
+
+uint8_t* emu6502_memory(emu6502* emu) { return emu->M.Mem.Data; }
+
+void emu6502_get_registers(emu6502* emu, emu6502_registers* registers) {
+ CPU_6502& Cpu     = emu->M.Cpu;
+ registers->cycles = Cpu.TotalCycles;
+ registers->pc     = Cpu.PC;
+ registers->a      = Cpu.A;
+ registers->x      = Cpu.X;
+ registers->y      = Cpu.Y;
+ registers->sp     = Cpu.SP;
+ registers->p      = Cpu.PS.GetPS();
+ registers->pad    = 0;
+}
+
+void emu6502_set_registers(emu6502* emu, const emu6502_registers* registers) {
+ CPU_6502& Cpu   = emu->M.Cpu;
+ Cpu.TotalCycles = registers->cycles;
+ Cpu.PC          = registers->pc;
+ Cpu.A           = registers->a;
+ Cpu.X           = registers->x;
+ Cpu.Y           = registers->y;
+ Cpu.SP          = registers->sp;
+ Cpu.PS          = registers->p;
+}
+
+void emu6502_set_irq(emu6502* emu, int level) { emu->M.Cpu.Lines.SetIRQ(emu->IRQSource, level); }
+
+void emu6502_nmi(emu6502* emu) { emu->M.Cpu.Lines.TriggerNMI(); }
+
+void emu6502_set_fast(emu6502* emu, int fast) { emu->M.Fast = fast; }
+
+// The C API passes CPU_* through as is
+static_assert((int)EMU6502_CPU_6502 == CPU_NMOS && (int)EMU6502_CPU_6502X == CPU_NMOS_ILLEGAL, "CPU numbering");
+static_assert((int)EMU6502_CPU_65C02 == CPU_65C02 && (int)EMU6502_CPU_R65C02 == CPU_R65C02 && (int)EMU6502_CPU_W65C02 == CPU_W65C02, "CPU numbering");
+
+int emu6502_set_cpu(emu6502* emu, int cpu) {
+ if (cpu < 0 || cpu >= CPU_VARIANTS) return -1;
+ emu->M.Cpu.Variant = cpu;
+ return 0;
+}
+
+void emu6502_set_bus_exact(emu6502* emu, int exact) { emu->M.Cpu.BusExact = exact != 0; }
+
+static_assert((int)EMU6502_ILLEGAL_HALT == ILLEGAL_HALT && (int)EMU6502_ILLEGAL_CALLBACK == ILLEGAL_CALLBACK && (int)EMU6502_ILLEGAL_NOP == ILLEGAL_NOP, "policy numbering");
+static_assert((int)EMU6502_STOP_NONE == STOP_NONE && (int)EMU6502_STOP_ILLEGAL == STOP_ILLEGAL, "stop reason numbering");
+
+int emu6502_set_illegal_policy(emu6502* emu, int policy) {
+ if (policy < ILLEGAL_HALT || policy > ILLEGAL_NOP) return -1;
+ emu->M.Cpu.IllegalPolicy = policy;
+ return 0;
+}
+
+void emu6502_set_illegal_handler(emu6502* emu, emu6502_illegal_handler handler, void* user) {
+ if (!handler) {
+  emu->M.Cpu.OnIllegal = nullptr;
+  return;
+ }
+ emu->M.Cpu.OnIllegal = [emu, handler, user](CPU_6502& Cpu, Memory&, Byte Opcode) { handler(emu, Opcode, Cpu.PC - 1, user); };
+}
+
+int emu6502_stop_reason(emu6502* emu, uint8_t* opcode) {
+ if (opcode) *opcode = emu->M.Cpu.StopOpcode;
+ return emu->M.Cpu.StopReason;
+}
+
+// One command of a batch. Thread is set when the batch runs on the
+// emulation thread, the only place PAUSE and RESUME mean anything
+static bool ExecuteCommand(emu6502* emu, emu6502_command& Command, EmulationThread* Thread) {
+ switch (Command.op) {
+ case EMU6502_CMD_RUN:
+  Command.value = emu6502_run(emu, Command.value);
+  break;
+ case EMU6502_CMD_READ:
+  emu6502_read(emu, Command.address, Command.data, Command.size);
+  break;
+ case EMU6502_CMD_WRITE:
+  emu6502_write(emu, Command.address, Command.data, Command.size);
+  break;
+ case EMU6502_CMD_GET_REGISTERS:
+  emu6502_get_registers(emu, (emu6502_registers*)Command.data);
+  break;
+ case EMU6502_CMD_SET_REGISTERS:
+  emu6502_set_registers(emu, (const emu6502_registers*)Command.data);
+  break;
+ case EMU6502_CMD_IRQ:
+  emu6502_set_irq(emu, Command.value != 0);
+  break;
+ case EMU6502_CMD_NMI:
+  emu6502_nmi(emu);
+  break;
+ case EMU6502_CMD_RESET:
+  emu6502_reset(emu);
+  break;
+ case EMU6502_CMD_PAUSE:
+ case EMU6502_CMD_RESUME: {
+  if (!Thread) return false;
+  HostCommand State;
+  State.Kind = Command.op == EMU6502_CMD_PAUSE ? HOST_PAUSE : HOST_RESUME;
+  Thread->Apply(State);
+  break;
+ }
+ case EMU6502_CMD_STEP:
+  Command.value = emu->M.Step(Command.value);
+  break;
+ default:
+  return false;
+ }
+ return true;
+}
+
+size_t emu6502_batch(emu6502* emu, emu6502_command* commands, size_t count) {
+ for (size_t i = 0; i < count; i++)
+  if (!ExecuteCommand(emu, commands[i], nullptr)) return i;
+ return count;
+}
+
+static_assert((int)EMU6502_THREAD_RUNNING == THREAD_RUNNING && (int)EMU6502_THREAD_PAUSED == THREAD_PAUSED, "thread state numbering");
+static_assert((int)EMU6502_THREAD_HALTED == THREAD_HALTED && (int)EMU6502_THREAD_FINISHED == THREAD_FINISHED, "thread state numbering");
+
+int emu6502_start(emu6502* emu, uint64_t cycles, uint64_t slice_cycles, int paused) {
+ if (emu->Thread) return -1;
+ emu->Thread.reset(new EmulationThread(emu->M, cycles, slice_cycles));
+ emu->Thread->Start(paused != 0);
+ return 0;
+}
+
+void emu6502_stop(emu6502* emu) { emu->Thread.reset(); }
+
+long emu6502_post(emu6502* emu, emu6502_command* commands, size_t count, int wait) {
+ EmulationThread* Thread = emu->Thread.get();
+ if (!Thread) return -1;
+
+ if (wait) {
+  size_t Executed = 0;
+  std::future<void> Done = Thread->Call([emu, commands, count, &Executed](EmulationThread& Thread) {
+   for (Executed = 0; Executed < count; Executed++)
+    if (!ExecuteCommand(emu, commands[Executed], &Thread)) break;
+  });
+  Done.wait();
+  return Executed;
+ }
+
+ // Nothing the caller owns may be touched once this returns
+ std::vector<emu6502_command> Batch(commands, commands + count);
+ std::vector<std::vector<Byte>> Payloads;
+ for (emu6502_command& Command : Batch) {
+  if (Command.op == EMU6502_CMD_READ || Command.op == EMU6502_CMD_GET_REGISTERS) return -1;
+  if (Command.op == EMU6502_CMD_WRITE) Payloads.emplace_back((const Byte*)Command.data, (const Byte*)Command.data + Command.size);
+  if (Command.op == EMU6502_CMD_SET_REGISTERS) Payloads.emplace_back((const Byte*)Command.data, (const Byte*)Command.data + sizeof(emu6502_registers));
+ }
+ Thread->Call([emu, Batch, Payloads](EmulationThread& Thread) mutable {
+  size_t Payload = 0;
+  for (emu6502_command& Command : Batch) {
+   if (Command.op == EMU6502_CMD_WRITE || Command.op == EMU6502_CMD_SET_REGISTERS) Command.data = Payloads[Payload++].data();
+   if (!ExecuteCommand(emu, Command, &Thread)) break;
+  }
+ });
+ return count;
+}
+
+int emu6502_thread_state(emu6502* emu) {
+ if (!emu->Thread) return EMU6502_THREAD_NONE;
+ int State = emu->Thread->State.load(std::memory_order_acquire);
+ // An exited thread is one that was asked to stop, emu6502_stop is next
+ return State == THREAD_EXITED ? EMU6502_THREAD_NONE : State;
+}
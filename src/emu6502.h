@@ -0,0 +1,160 @@
+#ifndef _EMU6502_H_
+#define _EMU6502_H_
+
+/* C interface of libemu6502. Every call takes the instance it works on,
+ * the library keeps no global state, so instances can live on different
+ * threads. The layout of the structs below only changes together with
+ * EMU6502_API_VERSION */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMU6502_API_VERSION 1
+
+typedef struct emu6502 emu6502;
+
+typedef struct {
+ uint64_t cycles; /* Since reset */
+ uint16_t pc;
+ uint8_t a;
+ uint8_t x;
+ uint8_t y;
+ uint8_t sp;
+ uint8_t p;
+ uint8_t pad;
+} emu6502_registers;
+
+enum {
+ EMU6502_CMD_RUN           = 0, /* Run value cycles, value is set to the cycles executed */
+ EMU6502_CMD_READ          = 1, /* size bytes from address into data */
+ EMU6502_CMD_WRITE         = 2, /* size bytes from data to address */
+ EMU6502_CMD_GET_REGISTERS = 3, /* data points to an emu6502_registers */
+ EMU6502_CMD_SET_REGISTERS = 4,
+ EMU6502_CMD_IRQ           = 5, /* value is the IRQ level, 0 or 1 */
+ EMU6502_CMD_NMI           = 6,
+ EMU6502_CMD_RESET         = 7,
+ EMU6502_CMD_PAUSE         = 8,  /* Only through emu6502_post */
+ EMU6502_CMD_RESUME        = 9,  /* Only through emu6502_post, also goes on after a halt */
+ EMU6502_CMD_STEP          = 10, /* value instructions, value is set to the cycles they took */
+};
+
+/* Where the thread started by emu6502_start is */
+enum {
+ EMU6502_THREAD_NONE     = -1, /* Not started */
+ EMU6502_THREAD_RUNNING  = 0,
+ EMU6502_THREAD_PAUSED   = 1,
+ EMU6502_THREAD_HALTED   = 2, /* Illegal opcode or STP, EMU6502_CMD_RESUME goes on */
+ EMU6502_THREAD_FINISHED = 3, /* The cycles given to emu6502_start are used up */
+};
+
+enum {
+ EMU6502_CPU_6502   = 0, /* NMOS, documented opcodes */
+ EMU6502_CPU_6502X  = 1, /* NMOS with the undocumented opcodes */
+ EMU6502_CPU_65C02  = 2,
+ EMU6502_CPU_R65C02 = 3, /* Rockwell bit instructions */
+ EMU6502_CPU_W65C02 = 4, /* Rockwell set, WAI and STP */
+};
+
+/* What an opcode the selected CPU does not have does */
+enum {
+ EMU6502_ILLEGAL_HALT     = 0, /* emu6502_run returns early, PC on the opcode (default) */
+ EMU6502_ILLEGAL_CALLBACK = 1, /* Calls the handler set below, halts when there is none */
+ EMU6502_ILLEGAL_NOP      = 2, /* One byte NOP */
+};
+
+enum {
+ EMU6502_STOP_NONE    = 0,
+ EMU6502_STOP_ILLEGAL = 1,
+};
+
+/* pc is the address of the opcode, the CPU's PC is already past it. The
+ * handler may emulate the opcode through emu6502_get/set_registers and
+ * memory access, execution goes on at whatever PC it leaves behind */
+typedef void (*emu6502_illegal_handler)(emu6502* emu, uint8_t opcode, uint16_t pc, void* user);
+
+/* One step of a batch. A host that does "write input, run a frame, read the
+ * screen, read registers" can do it in one call through emu6502_batch */
+typedef struct {
+ uint32_t op; /* EMU6502_CMD_* */
+ uint32_t size;
+ uint16_t address;
+ uint16_t pad[3];
+ uint64_t value;
+ void* data;
+} emu6502_command;
+
+uint32_t emu6502_api_version(void);
+
+emu6502* emu6502_create(void);
+void emu6502_destroy(emu6502* emu);
+
+/* Registers to their power-on values, PC from the reset vector. Memory is kept */
+void emu6502_reset(emu6502* emu);
+
+/* Copies an image into memory at address, clipped at $FFFF. Returns bytes loaded */
+size_t emu6502_load(emu6502* emu, uint16_t address, const void* data, size_t size);
+/* Returns bytes loaded, or -1 when the file cannot be read */
+long emu6502_load_file(emu6502* emu, uint16_t address, const char* path);
+
+/* Runs at least cycles cycles (the last instruction is finished), returns the cycles run */
+uint64_t emu6502_run(emu6502* emu, uint64_t cycles);
+
+/* Bulk copies, wrapping at $FFFF. They go straight to RAM without side effects */
+void emu6502_read(emu6502* emu, uint16_t address, void* data, size_t size);
+void emu6502_write(emu6502* emu, uint16_t address, const void* data, size_t size);
+/* The 64K of RAM itself, valid until emu6502_destroy. Reads and writes through
+ * it cost nothing per call and are what an FFI host should use for hot data */
+uint8_t* emu6502_memory(emu6502* emu);
+
+void emu6502_get_registers(emu6502* emu, emu6502_registers* registers);
+void emu6502_set_registers(emu6502* emu, const emu6502_registers* registers);
+
+void emu6502_set_irq(emu6502* emu, int level);
+void emu6502_nmi(emu6502* emu);
+
+/* Selects the table dispatch engine (1) or the reference interpreter (0) */
+void emu6502_set_fast(emu6502* emu, int fast);
+/* EMU6502_CPU_*, returns 0 or -1 for an unknown variant */
+int emu6502_set_cpu(emu6502* emu, int cpu);
+/* Every bus cycle's access, dummies included, for devices that react to
+ * reads (1), or only the accesses instructions need (0, the default) */
+void emu6502_set_bus_exact(emu6502* emu, int exact);
+/* EMU6502_ILLEGAL_*, returns 0 or -1 for an unknown policy */
+int emu6502_set_illegal_policy(emu6502* emu, int policy);
+void emu6502_set_illegal_handler(emu6502* emu, emu6502_illegal_handler handler, void* user);
+/* EMU6502_STOP_* of the last emu6502_run, opcode (if not NULL) gets the offending byte */
+int emu6502_stop_reason(emu6502* emu, uint8_t* opcode);
+
+/* Executes count commands in order, returns how many were executed. Stops
+ * at the first command with an unknown op */
+size_t emu6502_batch(emu6502* emu, emu6502_command* commands, size_t count);
+
+/* Threaded mode. The machine runs on a thread of its own in slices of
+ * slice_cycles (0 for the default), for cycles cycles or without end when 0,
+ * starting paused if paused is set. While it runs the instance may only be
+ * used through emu6502_post, emu6502_thread_state and emu6502_stop; the
+ * illegal opcode handler is called on the emulation thread. Returns -1 when
+ * a thread is already running */
+int emu6502_start(emu6502* emu, uint64_t cycles, uint64_t slice_cycles, int paused);
+/* Joins the thread, batches still queued are dropped. The instance can be
+ * used directly again afterwards */
+void emu6502_stop(emu6502* emu);
+/* Queues a batch for the emulation thread, which executes all of it between
+ * two slices. Any thread may post. With wait set the call returns once the
+ * batch ran, with the same result as emu6502_batch. Without it the batch and
+ * the data of WRITE and SET_REGISTERS are copied and the call returns count
+ * at once; READ and GET_REGISTERS are refused then. Returns -1 when no
+ * thread runs or the batch is refused */
+long emu6502_post(emu6502* emu, emu6502_command* commands, size_t count, int wait);
+/* EMU6502_THREAD_* */
+int emu6502_thread_state(emu6502* emu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+#include "emu_thread.h"
+
+#include <algorithm>
+#include <chrono>
+
+EmulationThread::EmulationThread(Machine& m, uint64_t budget, uint64_t sliceCycles) : M(m), SliceCycles(sliceCycles ? sliceCycles : EMU_THREAD_SLICE_CYCLES), Budget(budget) {}
+
+EmulationThread::~EmulationThread() { Stop(); }
+
+void EmulationThread::Start(bool paused) {
+ if (Worker.joinable()) return;
+ StartCycles = M.Cpu.TotalCycles;
+ Quit        = false;
+ Cycles.store(StartCycles, std::memory_order_relaxed);
+ State.store(paused ? THREAD_PAUSED : THREAD_RUNNING, std::memory_order_release);
+ Worker = std::thread(&EmulationThread::Loop, this);
+}
+
+void EmulationThread::Stop() {
+ if (!Worker.joinable()) return;
+ HostCommand* Command = new HostCommand();
+ Command->Kind        = HOST_QUIT;
+ Post(Command);
+ Worker.join();
+
+ // Nobody is left to apply them, waiters get a broken promise
+ while (HostCommand* Left = Commands.Pop()) delete Left;
+}
+
+std::future<void> EmulationThread::Post(HostCommand* Command) {
+ std::future<void> Applied = Command->Applied.get_future();
+ Commands.Push(Command);
+ return Applied;
+}
+
+static HostCommand* NewCommand(int Kind, uint64_t Value = 0) {
+ HostCommand* Command = new HostCommand();
+ Command->Kind        = Kind;
+ Command->Value       = Value;
+ return Command;
+}
+
+std::future<void> EmulationThread::Pause() { return Post(NewCommand(HOST_PAUSE)); }
+
+std::future<void> EmulationThread::Resume() { return Post(NewCommand(HOST_RESUME)); }
+
+std::future<void> EmulationThread::Step(uint64_t Instructions) { return Post(NewCommand(HOST_STEP, Instructions)); }
+
+std::future<void> EmulationThread::Poke(Word Address, const Byte* Data, size_t Size) {
+ HostCommand* Command = NewCommand(HOST_POKE);
+ Command->Address     = Address;
+ Command->Data.assign(Data, Data + Size);
+ return Post(Command);
+}
+
+std::future<void> EmulationThread::SetIRQ(bool Level) { return Post(NewCommand(HOST_IRQ, Level)); }
+
+std::future<void> EmulationThread::NMI() { return Post(NewCommand(HOST_NMI)); }
+
+std::future<void> EmulationThread::Snapshot(MachineSnapshot& Out) {
+ HostCommand* Command = NewCommand(HOST_SNAPSHOT);
+ Command->Snapshot    = &Out;
+ return Post(Command);
+}
+
+std::future<void> EmulationThread::Call(HostCall Function) {
+ HostCommand* Command = NewCommand(HOST_CALL);
+ Command->Call        = std::move(Function);
+ return Post(Command);
+}
+
+void EmulationThread::Loop() {
+ while (!Quit) {
+  while (HostCommand* Command = Commands.Pop()) {
+   Apply(*Command);
+   Command->Applied.set_value();
+   delete Command;
+  }
+  if (Quit) break;
+
+  if (State.load(std::memory_order_relaxed) != THREAD_RUNNING) {
+   std::this_thread::sleep_for(std::chrono::microseconds(EMU_THREAD_IDLE_US));
+   continue;
+  }
+  RunSlice();
+ }
+ State.store(THREAD_EXITED, std::memory_order_release);
+}
+
+void EmulationThread::RunSlice() {
+ uint64_t Slice = SliceCycles;
+ if (Budget) {
+  // Steps may already have used it up
+  uint64_t Used = M.Cpu.TotalCycles - StartCycles;
+  if (Used >= Budget) {
+   State.store(THREAD_FINISHED, std::memory_order_release);
+   return;
+  }
+  Slice = std::min(Slice, Budget - Used);
+ }
+ M.Run(Slice);
+ Cycles.store(M.Cpu.TotalCycles, std::memory_order_release);
+
+ if (M.Mem.Break || M.Cpu.StopReason != STOP_NONE)
+  State.store(THREAD_HALTED, std::memory_order_release);
+ else if (Budget && M.Cpu.TotalCycles - StartCycles >= Budget)
+  State.store(THREAD_FINISHED, std::memory_order_release);
+}
+
+void EmulationThread::Apply(HostCommand& Command) {
+ CPU_6502& Cpu = M.Cpu;
+
+ switch (Command.Kind) {
+ case HOST_PAUSE:
+  if (State.load(std::memory_order_relaxed) == THREAD_RUNNING) State.store(THREAD_PAUSED, std::memory_order_release);
+  break;
+ case HOST_RESUME:
+  if (State.load(std::memory_order_relaxed) == THREAD_FINISHED) break;
+  M.Mem.Break    = false;
+  Cpu.StopReason = STOP_NONE;
+  State.store(THREAD_RUNNING, std::memory_order_release);
+  break;
+ case HOST_STEP:
+  M.Step(Command.Value);
+  Cycles.store(Cpu.TotalCycles, std::memory_order_release);
+  break;
+ case HOST_POKE: {
+  Word Address = Command.Address;
+  for (Byte Value : Command.Data) M.Mem.Data[Address++] = Value;
+  M.Mem.Invalidate(Command.Address, Command.Data.size());
+  break;
+ }
+ case HOST_IRQ:
+  if (IRQSource < 0) IRQSource = Cpu.Lines.AllocateIRQ();
+  Cpu.Lines.SetIRQ(IRQSource, Command.Value != 0);
+  break;
+ case HOST_NMI:
+  Cpu.Lines.TriggerNMI();
+  break;
+ case HOST_SNAPSHOT: {
+  MachineSnapshot& Out = *Command.Snapshot;
+  Out.State            = State.load(std::memory_order_relaxed);
+  Out.Cycles           = Cpu.TotalCycles;
+  Out.PC               = Cpu.PC;
+  Out.A                = Cpu.A;
+  Out.X                = Cpu.X;
+  Out.Y                = Cpu.Y;
+  Out.SP               = Cpu.SP;
+  Out.P                = Cpu.PS.GetPS();
+  Out.Memory.assign(M.Mem.Data, M.Mem.Data + MAX_MEM);
+  break;
+ }
+ case HOST_CALL:
+  if (Command.Call) Command.Call(*this);
+  break;
+ case HOST_QUIT:
+  Quit = true;
+  break;
+ }
+}
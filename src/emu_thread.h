@@ -0,0 +1,72 @@
+#ifndef _EMU_THREAD_H_
+#define _EMU_THREAD_H_
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+#include "host_queue.h"
+#include "machine.h"
+
+constexpr uint64_t EMU_THREAD_SLICE_CYCLES = 20000;  // About 20 ms of a 1 MHz machine, far less of host time
+constexpr uint32_t EMU_THREAD_IDLE_US      = 200;    // Poll interval of a thread with nothing to run
+
+enum {
+ THREAD_RUNNING  = 0,
+ THREAD_PAUSED   = 1,  // By the host
+ THREAD_HALTED   = 2,  // Watchpoint hit or a CPU StopReason, HOST_RESUME goes on
+ THREAD_FINISHED = 3,  // Budget used up, commands are still applied
+ THREAD_EXITED   = 4,
+};
+
+// Runs a Machine on a thread of its own, Budget cycles or until stopped, in
+// slices of SliceCycles through Machine::Run. The host only posts commands;
+// they are applied between slices, so the instruction loop stays exactly as
+// it is and a host action waits at most one slice. Nothing else may touch
+// the machine while the thread runs
+struct EmulationThread {
+ Machine& M;
+ uint64_t SliceCycles;
+ uint64_t Budget;  // Cycles to run, 0 for no limit
+
+ CommandQueue Commands;
+ std::thread Worker;
+
+ // Published by the emulation thread after every slice
+ std::atomic<int> State{THREAD_PAUSED};
+ std::atomic<uint64_t> Cycles{0};
+
+ // Emulation thread only
+ uint64_t StartCycles = 0;
+ bool Quit            = false;
+ int IRQSource        = -1;  // Allocated on the first HOST_IRQ
+
+ EmulationThread(Machine& m, uint64_t budget = 0, uint64_t sliceCycles = EMU_THREAD_SLICE_CYCLES);
+ ~EmulationThread();
+
+ void Start(bool paused = false);
+ // Posts HOST_QUIT and joins, commands still queued are dropped
+ void Stop();
+
+ // Takes ownership, the future is ready once the command was applied
+ std::future<void> Post(HostCommand* Command);
+
+ std::future<void> Pause();
+ std::future<void> Resume();
+ std::future<void> Step(uint64_t Instructions = 1);
+ std::future<void> Poke(Word Address, const Byte* Data, size_t Size);
+ std::future<void> SetIRQ(bool Level);
+ std::future<void> NMI();
+ std::future<void> Snapshot(MachineSnapshot& Out);
+ std::future<void> Call(HostCall Function);
+
+ void Loop();
+ void Apply(HostCommand& Command);
+ void RunSlice();
+};
+
+#endif
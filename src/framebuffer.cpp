@@ -0,0 +1,51 @@
+#include "framebuffer.h"
+
+#include <cstdio>
+
+#include "common.h"
+
+// Host starts out black like Pixels, so nothing is dirty yet
+FramebufferDevice::FramebufferDevice(Word Base) : MemoryDevice(Base, Base + FB_SIZE - 1) {}
+
+Byte FramebufferDevice::Read(Word Address) { return Pixels[Address - Begin]; }
+
+void FramebufferDevice::Write(Word Address, Byte Value) {
+ uint32_t Offset = Address - Begin;
+ if (Pixels[Offset] == Value) return;
+
+ Pixels[Offset] = Value;
+ uint32_t Row   = Offset / FB_WIDTH;
+ Dirty[Row / 64] |= 1ull << (Row % 64);
+}
+
+void FramebufferDevice::Render() {
+ for (uint32_t Chunk = 0; Chunk < sizeof(Dirty) / sizeof(Dirty[0]); Chunk++) {
+  while (Dirty[Chunk]) {
+   uint32_t Row = Chunk * 64 + __builtin_ctzll(Dirty[Chunk]);
+   Dirty[Chunk] &= Dirty[Chunk] - 1;
+
+   const Byte* Src = &Pixels[Row * FB_WIDTH];
+   Byte* Dst       = &Host[Row * FB_WIDTH * 3];
+   for (uint32_t x = 0; x < FB_WIDTH; x++) {
+    Byte Pixel = Src[x];
+    *Dst++     = ((Pixel >> 5) & 0x07) * 255 / 7;
+    *Dst++     = ((Pixel >> 2) & 0x07) * 255 / 7;
+    *Dst++     = (Pixel & 0x03) * 255 / 3;
+   }
+  }
+ }
+}
+
+bool FramebufferDevice::DumpPPM(const std::string& Path) {
+ Render();
+
+ FILE* File = fopen(Path.c_str(), "wb");
+ if (!File) {
+  perror(Path.c_str());
+  return false;
+ }
+ fprintf(File, "P6\n%u %u\n255\n", FB_WIDTH, FB_HEIGHT);
+ fwrite(Host, 1, sizeof(Host), File);
+ fclose(File);
+ return true;
+}
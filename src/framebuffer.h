@@ -0,0 +1,32 @@
+#ifndef _FRAMEBUFFER_H_
+#define _FRAMEBUFFER_H_
+
+#include <string>
+
+#include <cstdint>
+
+#include "common.h"
+#include "device.h"
+
+constexpr uint32_t FB_WIDTH  = 64;
+constexpr uint32_t FB_HEIGHT = 64;
+constexpr uint32_t FB_SIZE   = FB_WIDTH * FB_HEIGHT;
+
+// Memory mapped display, one byte per pixel in RGB332 (rrrgggbb). Writes mark
+// their row dirty and Render() converts only dirty rows into the host RGB
+// buffer, so a dump after a few changed pixels does not redraw the screen
+struct FramebufferDevice : MemoryDevice {
+ Byte Pixels[FB_SIZE]   = {};
+ Byte Host[FB_SIZE * 3] = {};  // RGB888, kept in sync with Pixels by Render()
+ uint64_t Dirty[(FB_HEIGHT + 63) / 64] = {};  // One bit per row
+
+ FramebufferDevice(Word Base);
+
+ Byte Read(Word Address) override;
+ void Write(Word Address, Byte Value) override;
+
+ void Render();
+ bool DumpPPM(const std::string& Path);
+};
+
+#endif
@@ -0,0 +1,67 @@
+#include "heatmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common.h"
+#include "memory.h"
+
+HeatMap::HeatMap(uint32_t BucketSize) : Shift(0) {
+ while ((2u << Shift) <= BucketSize && (2u << Shift) <= MAX_MEM) Shift++;
+ Reads.assign(MAX_MEM >> Shift, 0);
+ Writes.assign(MAX_MEM >> Shift, 0);
+ Execs.assign(MAX_MEM >> Shift, 0);
+}
+
+static Byte LogScale(uint64_t Value, double Max) {
+ if (!Value) return 0;
+ return (Byte)(32 + 223 * log1p((double)Value) / Max);
+}
+
+bool HeatMap::DumpPPM(const std::string& Path) const {
+ FILE* File = fopen(Path.c_str(), "wb");
+ if (!File) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ uint64_t MaxRead  = *std::max_element(Reads.begin(), Reads.end());
+ uint64_t MaxWrite = *std::max_element(Writes.begin(), Writes.end());
+ uint64_t MaxExec  = *std::max_element(Execs.begin(), Execs.end());
+ double LogRead    = log1p((double)MaxRead);
+ double LogWrite   = log1p((double)MaxWrite);
+ double LogExec    = log1p((double)MaxExec);
+
+ fprintf(File, "P6\n256 256\n255\n");
+ for (uint32_t Address = 0; Address < MAX_MEM; Address++) {
+  uint32_t Bucket = Address >> Shift;
+  Byte Pixel[3]   = {LogScale(Writes[Bucket], LogWrite), LogScale(Reads[Bucket], LogRead), LogScale(Execs[Bucket], LogExec)};
+  fwrite(Pixel, 1, sizeof(Pixel), File);
+ }
+ fclose(File);
+ return true;
+}
+
+void HeatMap::Report(FILE* File, const SymbolTable& Symbols, size_t Top) const {
+ std::vector<uint32_t> Order;
+ uint64_t Total = 0;
+ for (uint32_t Bucket = 0; Bucket < Reads.size(); Bucket++) {
+  uint64_t Accesses = Reads[Bucket] + Writes[Bucket];
+  Total += Accesses;
+  if (Accesses) Order.push_back(Bucket);
+ }
+ std::sort(Order.begin(), Order.end(), [&](uint32_t a, uint32_t b) { return Reads[a] + Writes[a] > Reads[b] + Writes[b]; });
+ if (Order.size() > Top) Order.resize(Top);
+
+ fprintf(File, "Data accesses: %llu, bucket size %u\n", (unsigned long long)Total, BucketSize());
+ fprintf(File, "%-11s %-32s %12s %12s %12s %8s\n", "Address", "Label", "Reads", "Writes", "Executes", "%");
+ for (uint32_t Bucket : Order) {
+  Word Address = Bucket << Shift;
+  char Range[16];
+  if (Shift)
+   snprintf(Range, sizeof(Range), "%04x-%04x", Address, Address + BucketSize() - 1);
+  else
+   snprintf(Range, sizeof(Range), "%04x", Address);
+  fprintf(File, "%-9s%s %-32s %12llu %12llu %12llu %7.2f%%\n", Range, Address < PAGE_SIZE ? " z" : "  ", Symbols.Name(Address).c_str(), (unsigned long long)Reads[Bucket], (unsigned long long)Writes[Bucket], (unsigned long long)Execs[Bucket], 100.0 * (Reads[Bucket] + Writes[Bucket]) / Total);
+ }
+}
@@ -0,0 +1,42 @@
+#ifndef _HEATMAP_H_
+#define _HEATMAP_H_
+
+#include <string>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+
+#include "common.h"
+#include "symbols.h"
+#include "watchpoint.h"
+
+// Read/write/execute counters per bucket of BucketSize addresses (a power
+// of two). Memory feeds it from the trap slow path with every page trapped,
+// so a run without a heatmap keeps the plain array accesses. Execute counts
+// opcode fetches, operand bytes are counted as reads
+struct HeatMap {
+ uint32_t Shift;
+ std::vector<uint64_t> Reads;
+ std::vector<uint64_t> Writes;
+ std::vector<uint64_t> Execs;
+
+ HeatMap(uint32_t BucketSize = 1);
+
+ uint32_t BucketSize() const { return 1u << Shift; }
+
+ void Count(Word Address, Byte Kind) {
+  uint32_t Bucket = Address >> Shift;
+  if (Kind & WATCH_READ) Reads[Bucket]++;
+  if (Kind & WATCH_WRITE) Writes[Bucket]++;
+  if (Kind & WATCH_EXEC) Execs[Bucket]++;
+ }
+
+ // 256x256, one pixel per address with page number as the row. Red is
+ // writes, green reads, blue executes, each on a log scale
+ bool DumpPPM(const std::string& Path) const;
+ // Hottest buckets by data accesses, zero page ones marked
+ void Report(FILE* File, const SymbolTable& Symbols, size_t Top = 32) const;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "host_queue.h"
+
+HostCommand* CommandQueue::Pop() {
+ HostCommand* First = Tail;
+ HostCommand* Next  = First->Next.load(std::memory_order_acquire);
+
+ // The stub only keeps the list from running empty, step over it
+ if (First == &Stub) {
+  if (!Next) return nullptr;
+  Tail  = Next;
+  First = Next;
+  Next  = Next->Next.load(std::memory_order_acquire);
+ }
+ if (Next) {
+  Tail = Next;
+  return First;
+ }
+
+ // First looks like the last one. Either a push is half done, or it really
+ // is last and the stub goes back in behind it so it can be handed out
+ if (First != Head.load(std::memory_order_acquire)) return nullptr;
+ Push(&Stub);
+ Next = First->Next.load(std::memory_order_acquire);
+ if (Next) {
+  Tail = Next;
+  return First;
+ }
+ return nullptr;
+}
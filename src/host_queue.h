@@ -0,0 +1,81 @@
+#ifndef _HOST_QUEUE_H_
+#define _HOST_QUEUE_H_
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <vector>
+
+#include <cstdint>
+
+#include "common.h"
+
+struct EmulationThread;
+
+// What the host asks of a machine running on its own thread
+enum {
+ HOST_PAUSE    = 0,
+ HOST_RESUME   = 1,  // Also after a halt, clears the watchpoint hit and StopReason
+ HOST_STEP     = 2,  // Value instructions, whatever the state
+ HOST_POKE     = 3,  // Data into RAM at Address, wrapping at $FFFF, no device sees it
+ HOST_IRQ      = 4,  // Value is the level of the host's own IRQ source
+ HOST_NMI      = 5,
+ HOST_SNAPSHOT = 6,  // Registers and RAM into *Snapshot
+ HOST_CALL     = 7,  // Runs Call on the emulation thread
+ HOST_QUIT     = 8,
+};
+
+// Registers and RAM as they were at a slice boundary. Device state is not
+// part of it
+struct MachineSnapshot {
+ int State       = 0;  // THREAD_* of the emulation thread at that point
+ uint64_t Cycles = 0;
+ Word PC         = 0;
+ Byte A          = 0;
+ Byte X          = 0;
+ Byte Y          = 0;
+ Byte SP         = 0;
+ Byte P          = 0;
+ std::vector<Byte> Memory;
+};
+
+typedef std::function<void(EmulationThread& Thread)> HostCall;
+
+// One queued request. The queue links them through Next, the emulation
+// thread deletes them once applied and fulfils Applied, so a host that needs
+// the result (a snapshot, a step) waits on the future it got from Post()
+struct HostCommand {
+ std::atomic<HostCommand*> Next{nullptr};
+ int Kind       = HOST_CALL;
+ Word Address   = 0;
+ uint64_t Value = 0;
+ std::vector<Byte> Data;
+ MachineSnapshot* Snapshot = nullptr;
+ HostCall Call;
+ std::promise<void> Applied;
+};
+
+// Intrusive multiple producer, single consumer queue (Vyukov). Producers
+// never wait on each other or on the consumer: a push is one exchange on
+// Head and a store. The consumer owns Tail and only runs at slice boundaries.
+// A producer that is between its two steps hides the commands behind it for
+// that long, Pop() then returns nullptr and they are picked up next time
+struct CommandQueue {
+ std::atomic<HostCommand*> Head;
+ HostCommand* Tail;
+ HostCommand Stub;
+
+ CommandQueue() : Head(&Stub), Tail(&Stub) {}
+
+ // Any thread
+ void Push(HostCommand* Command) {
+  Command->Next.store(nullptr, std::memory_order_relaxed);
+  HostCommand* Previous = Head.exchange(Command, std::memory_order_acq_rel);
+  Previous->Next.store(Command, std::memory_order_release);
+ }
+
+ // Consumer thread only
+ HostCommand* Pop();
+};
+
+#endif
@@ -8,13 +8,68 @@ void CPU_65XX::SetZeroNegativeFlags(Byte Value) {
  PS.N = (Value & CPU_65XX_PS::NegativeBit) != 0;
 }
 
-void CPU_65XX::ADC(Byte Operand) {
- EatCycles(1);
+void CPU_65XX::ADC(Byte Operand, bool CMOS) {
+ EatCycles(CMOS && PS.D ? 2 : 1);
+ AddWithCarry(Operand, CMOS);
+}
+
+// V is set when both inputs have the same sign and the result has the other.
+// In decimal mode each nibble is adjusted as it is added. The NMOS takes N
+// and V from the high nibble before its adjustment and Z from the binary sum,
+// the 65C02 sets N and Z from the result
+void CPU_65XX::AddWithCarry(Byte Operand, bool CMOS) {
  Word Sum = (Word)A + (Word)Operand + (Word)PS.C;
- PS.C     = (Sum > 0xFF);
- A        = (Byte)Sum;
- PS.V     = (((A ^ Operand) & (A ^ (Byte)Sum)) & 0x80) != 0;
- SetZeroNegativeFlags(A);
+ if (!PS.D) {
+  PS.V = ((A ^ Sum) & (Operand ^ Sum) & 0x80) != 0;
+  PS.C = (Sum > 0xFF);
+  A    = (Byte)Sum;
+  SetZeroNegativeFlags(A);
+  return;
+ }
+
+ Word Low = (A & 0x0F) + (Operand & 0x0F) + PS.C;
+ if (Low > 0x09) Low += 0x06;
+ Word High = (A >> 4) + (Operand >> 4) + (Low > 0x0F);
+ PS.Z      = (Byte)Sum == 0;
+ PS.N      = (High & 0x08) != 0;
+ PS.V      = ((A ^ (High << 4)) & ~(A ^ Operand) & 0x80) != 0;
+ if (High > 0x09) High += 0x06;
+ PS.C = (High > 0x0F);
+ A    = (Byte)((High << 4) | (Low & 0x0F));
+ if (CMOS) SetZeroNegativeFlags(A);
+}
+
+// The flags always come from the binary difference, only A is adjusted in
+// decimal mode. The NMOS adjusts each nibble, the 65C02 the whole byte, which
+// differs for invalid BCD; it also sets N and Z from the result
+void CPU_65XX::SubtractWithBorrow(Byte Operand, bool CMOS) {
+ Byte Borrow     = !PS.C;
+ Word Difference = (Word)A - (Word)Operand - Borrow;
+ PS.V            = ((A ^ Operand) & (A ^ Difference) & 0x80) != 0;
+ PS.C            = (Difference < 0x100);
+ SetZeroNegativeFlags((Byte)Difference);
+ if (!PS.D) {
+  A = (Byte)Difference;
+  return;
+ }
+
+ int Low = (A & 0x0F) - (Operand & 0x0F) - Borrow;
+ if (CMOS) {
+  int Result = (int)A - Operand - Borrow;
+  if (Result < 0) Result -= 0x60;
+  if (Low < 0) Result -= 0x06;
+  A = (Byte)Result;
+  SetZeroNegativeFlags(A);
+  return;
+ }
+
+ int High = (A >> 4) - (Operand >> 4);
+ if (Low < 0) {
+  Low -= 0x06;
+  High--;
+ }
+ if (High < 0) High -= 0x06;
+ A = (Byte)((High << 4) | (Low & 0x0F));
 }
 
 void CPU_65XX::AND(Byte Operand) {
@@ -34,30 +89,31 @@ Byte CPU_65XX::ASL(Byte Value) {
 
 void CPU_65XX::ConditionalBranch(Memory& mem, bool Value, bool Needed) {
  SignByte Offset = (SignByte)FetchByte(mem);
+ LastAddress     = PC + Offset;
  if (Value == Needed) {
   const Word PrevPC = PC;
   PC += Offset;
   EatCycles(1);
-
-  if ((PC >> 8) != (PrevPC >> 8)) EatCycles(1);
+  PROFILE(Profile.Opcodes[Profile.Current].Taken++;)
+
+  if ((PC >> 8) != (PrevPC >> 8)) {
+   EatCycles(1);
+   PROFILE(Profile.Opcodes[Profile.Current].PageCross++;)
+  }
+ } else {
+  PROFILE(Profile.Opcodes[Profile.Current].NotTaken++;)
  }
 }
 
-void CPU_65XX::BCS(Memory& mem) { ConditionalBranch(mem, PS.C, true); }
-
-void CPU_65XX::BCC(Memory& mem) { ConditionalBranch(mem, PS.C, false); }
-
-void CPU_65XX::BEQ(Memory& mem) { ConditionalBranch(mem, PS.Z, true); }
-
-void CPU_65XX::BNE(Memory& mem) { ConditionalBranch(mem, PS.Z, false); }
-
-void CPU_65XX::BMI(Memory& mem) { ConditionalBranch(mem, PS.N, true); }
-
-void CPU_65XX::BPL(Memory& mem) { ConditionalBranch(mem, PS.N, false); }
-
-void CPU_65XX::BVS(Memory& mem) { ConditionalBranch(mem, PS.V, true); }
-
-void CPU_65XX::BVC(Memory& mem) { ConditionalBranch(mem, PS.V, false); }
+// BBR/BBS: reads the zero page operand and hands back the bit, the branch
+// offset follows. The bus exact tables read the operand a second time
+bool CPU_65XX::TestBit(Memory& mem, Byte Bit) {
+ Byte Address = FetchZPAddress(mem);
+ Byte Value   = ReadByte(mem, Address);
+ EatCycles(1);
+ if (BusCycles) ReadByte(mem, Address);
+ return (Value >> Bit) & 1;
+}
 
 void CPU_65XX::BIT(Memory& mem, Word Address) {
  Byte Value = ReadByte(mem, Address);
@@ -69,13 +125,14 @@ void CPU_65XX::BIT(Memory& mem, Word Address) {
 }
 
 void CPU_65XX::BRK(Memory& mem) {
+ EatCycles(1);  // Padding byte read
  StackPushWord(mem, PC + 1);
- const Word InterruptVector = 0xFFFE;
  PS.B = true;
  PS.U = true;
  StackPushByte(mem, PS);
- PC     = ReadWord(mem, InterruptVector);
+ PC   = ReadWord(mem, IRQ_VECTOR);
  PS.I = true;
+ if (Calls) Calls->Call(TotalCycles, PC, SP + 3);
 }
 
 void CPU_65XX::CLC() {
@@ -101,7 +158,6 @@ void CPU_65XX::CLV() {
 void CPU_65XX::CMP(Byte Operand) {
  EatCycles(1);
  Byte Sub = A - Operand;
- printf("0x%02x - 0x%02x = 0x%02x ", A, Operand, Sub);
 
  PS.N = (Sub & CPU_65XX_PS::NegativeBit) > 0;
  PS.C = (A >= Operand);
@@ -111,7 +167,6 @@ void CPU_65XX::CMP(Byte Operand) {
 void CPU_65XX::CPX(Byte Operand) {
  EatCycles(1);
  Byte Sub = X - Operand;
- printf("0x%02x - 0x%02x = 0x%02x ", X, Operand, Sub);
 
  PS.C = (X >= Operand);
  PS.N = (Sub & CPU_65XX_PS::NegativeBit) != 0;
@@ -121,18 +176,16 @@ void CPU_65XX::CPX(Byte Operand) {
 void CPU_65XX::CPY(Byte Operand) {
  EatCycles(1);
  Byte Sub = Y - Operand;
- printf("0x%02x - 0x%02x = 0x%02x ", Y, Operand, Sub);
 
  PS.C = (Y >= Operand);
  PS.N = (Sub & CPU_65XX_PS::NegativeBit) != 0;
  PS.Z = (Y == Operand);
 }
 
-void CPU_65XX::DEC(Memory& mem, Word Address) {
- Byte Value = ReadByte(mem, Address);
+Byte CPU_65XX::DEC(Byte Value) {
  Value--;
- WriteByte(mem, Address, Value);
  SetZeroNegativeFlags(Value);
+ return Value;
 }
 
 void CPU_65XX::DEX() {
@@ -153,55 +206,49 @@ void CPU_65XX::EOR(Byte Value) {
  SetZeroNegativeFlags(A);
 }
 
-void CPU_65XX::INC(Memory& mem, Word Address) {
- Byte Value = ReadByte(mem, Address);
+Byte CPU_65XX::INC(Byte Value) {
  Value++;
- WriteByte(mem, Address, Value);
  SetZeroNegativeFlags(Value);
+ return Value;
 }
 
 void CPU_65XX::INX() {
  EatCycles(1);
  X++;
  SetZeroNegativeFlags(X);
- printf("X: %d ", X);
 }
 
 void CPU_65XX::INY() {
  EatCycles(1);
  Y++;
  SetZeroNegativeFlags(Y);
- printf("Y: %d ", Y);
 }
 
 void CPU_65XX::JMP(Word Address) {
- printf("0x%04x ", Address);
- //  if(Address == 0x371e)
- //   printf("N 0x%02x V 0x%02x Z 0x%02x C 0x%02x ", PS.N, PS.V, PS.Z, PS.C);
-
  PC = Address;
 }
 
-void CPU_65XX::JSR(Memory& mem) {
- Word EffectiveAddress = FetchWord(mem);
- StackPushWord(mem, PC - 1);
- PC = EffectiveAddress;
+// Called between the two operand bytes: the return address is pushed before
+// the high byte is fetched, PC is on it
+void CPU_65XX::JSR(Memory& mem, Byte Low) {
+ StackPushWord(mem, PC);
+ Word EffectiveAddress = (Word)(FetchByte(mem) << 8) | Low;
+ LastAddress           = EffectiveAddress;
+ PC                    = EffectiveAddress;
+ if (Calls) Calls->Call(TotalCycles, PC, SP + 2);
 }
 
 void CPU_65XX::LDA(Byte Value) {
- printf("LOAD 0x%02x ", Value);
  A = Value;
  SetZeroNegativeFlags(A);
 }
 
 void CPU_65XX::LDX(Byte Value) {
- printf("LOAD 0x%02x ", Value);
  X = Value;
  SetZeroNegativeFlags(X);
 }
 
 void CPU_65XX::LDY(Byte Value) {
- printf("LOAD 0x%02x ", Value);
  Y = Value;
  SetZeroNegativeFlags(Y);
 }
@@ -227,22 +274,29 @@ void CPU_65XX::ORA(Byte Value) {
 void CPU_65XX::PHA(Memory& mem) {
  EatCycles(1);
  StackPushByte(mem, A);
- printf("%02x ", A);
 }
 
 void CPU_65XX::PHP(Memory& mem) {
  EatCycles(1);
  PS.U = 1;
  PS.B = 1;
- printf("%02x ", PS.GetPS());
  StackPushByte(mem, PS);
 }
 
+void CPU_65XX::PHX(Memory& mem) {
+ EatCycles(1);
+ StackPushByte(mem, X);
+}
+
+void CPU_65XX::PHY(Memory& mem) {
+ EatCycles(1);
+ StackPushByte(mem, Y);
+}
+
 void CPU_65XX::PLA(Memory& mem) {
  EatCycles(1);
  A = StackPopByte(mem);
  SetZeroNegativeFlags(A);
- printf("%02x ", A);
 }
 
 void CPU_65XX::PLP(Memory& mem) {
@@ -250,7 +304,23 @@ void CPU_65XX::PLP(Memory& mem) {
  PS   = StackPopByte(mem);
  PS.B = false;
  PS.U = false;
- printf("%02x ", PS.GetPS());
+}
+
+void CPU_65XX::PLX(Memory& mem) {
+ EatCycles(1);
+ X = StackPopByte(mem);
+ SetZeroNegativeFlags(X);
+}
+
+void CPU_65XX::PLY(Memory& mem) {
+ EatCycles(1);
+ Y = StackPopByte(mem);
+ SetZeroNegativeFlags(Y);
+}
+
+Byte CPU_65XX::RMB(Byte Value, Byte Bit) {
+ EatCycles(1);
+ return Value & ~(1 << Bit);
 }
 
 Byte CPU_65XX::ROL(Byte Value) {
@@ -267,10 +337,10 @@ Byte CPU_65XX::ROL(Byte Value) {
 
 Byte CPU_65XX::ROR(Byte Value) {
  Byte Bit = PS.C;
- PS.C = (Value & CPU_65XX_PS::NegativeBit) != 0;
+ PS.C = (Value & CPU_65XX_PS::CarryBit) != 0;
 
- Value <<= 1;
- Value |= Bit;
+ Value >>= 1;
+ Value |= Bit << 7;
 
  SetZeroNegativeFlags(Value);
  EatCycles(1);
@@ -283,15 +353,20 @@ void CPU_65XX::RTI(Memory& mem) {
  PS.B = false;
  PS.U = false;
  PC   = StackPopWord(mem);
+ if (Calls) Calls->Return(TotalCycles, SP);
 }
 
 void CPU_65XX::RTS(Memory& mem) {
  EatCycles(3);
  Word EffectiveAddress = StackPopWord(mem);
  PC                    = EffectiveAddress + 1;
+ if (Calls) Calls->Return(TotalCycles, SP);
 }
 
-void CPU_65XX::SBC(Byte Operand) { ADC(~Operand); }
+void CPU_65XX::SBC(Byte Operand, bool CMOS) {
+ EatCycles(CMOS && PS.D ? 2 : 1);
+ SubtractWithBorrow(Operand, CMOS);
+}
 
 void CPU_65XX::SEC() {
  EatCycles(1);
@@ -308,12 +383,27 @@ void CPU_65XX::SEI() {
  PS.I = 1;
 }
 
+Byte CPU_65XX::SMB(Byte Value, Byte Bit) {
+ EatCycles(1);
+ return Value | (1 << Bit);
+}
+
 void CPU_65XX::STA(Memory& mem, Word Address) { WriteByte(mem, Address, A); }
 
 void CPU_65XX::STX(Memory& mem, Word Address) { WriteByte(mem, Address, X); }
 
 void CPU_65XX::STY(Memory& mem, Word Address) { WriteByte(mem, Address, Y); }
 
+void CPU_65XX::STZ(Memory& mem, Word Address) { WriteByte(mem, Address, 0); }
+
+// Nothing but a reset brings the CPU back, interrupts included. PC stays on
+// STP and the rest of every slice is eaten
+void CPU_65XX::STP() {
+ Stopped = true;
+ PC--;
+ Tick(Cycles > 0 ? Cycles : 1);
+}
+
 void CPU_65XX::TAX() {
  EatCycles(1);
  X = A;
@@ -338,6 +428,19 @@ void CPU_65XX::TYA() {
  SetZeroNegativeFlags(A);
 }
 
+// Z is set from A AND the old value, like BIT
+Byte CPU_65XX::TRB(Byte Value) {
+ PS.Z = (A & Value) == 0;
+ EatCycles(1);
+ return Value & ~A;
+}
+
+Byte CPU_65XX::TSB(Byte Value) {
+ PS.Z = (A & Value) == 0;
+ EatCycles(1);
+ return Value | A;
+}
+
 void CPU_65XX::TSX() {
  EatCycles(1);
  X = SP;
@@ -348,3 +451,118 @@ void CPU_65XX::TXS() {
  EatCycles(1);
  SP = X;
 }
+
+// Sleeps until an interrupt line is active. A pending IRQ wakes the CPU even
+// with I set, it then simply carries on after WAI. While asleep PC stays on
+// WAI and the rest of the slice is eaten, so time runs on to the next device
+// event; Interrupt() steps over WAI before pushing the return address
+void CPU_65XX::WAI() {
+ EatCycles(2);
+ if (Lines.Signal & (INTERRUPT_NMI | INTERRUPT_IRQ_MASK)) {
+  Waiting = false;
+  return;
+ }
+ Waiting = true;
+ PC--;
+ if (Cycles > 0) Tick(Cycles);
+}
+
+// Undocumented NMOS. The read-modify-write ones do the shift or step of the
+// documented instruction on the value read and combine the result with A, the
+// caller writes back what they return
+
+Byte CPU_65XX::SLO(Byte Value) {
+ Value = ASL(Value);
+ A |= Value;
+ SetZeroNegativeFlags(A);
+ return Value;
+}
+
+Byte CPU_65XX::RLA(Byte Value) {
+ Value = ROL(Value);
+ A &= Value;
+ SetZeroNegativeFlags(A);
+ return Value;
+}
+
+Byte CPU_65XX::SRE(Byte Value) {
+ Value = LSR(Value);
+ A ^= Value;
+ SetZeroNegativeFlags(A);
+ return Value;
+}
+
+Byte CPU_65XX::RRA(Byte Value) {
+ Value = ROR(Value);
+ AddWithCarry(Value);
+ return Value;
+}
+
+Byte CPU_65XX::DCP(Byte Value) {
+ Value--;
+ EatCycles(1);
+ PS.C = (A >= Value);
+ PS.Z = (A == Value);
+ PS.N = ((Byte)(A - Value) & CPU_65XX_PS::NegativeBit) != 0;
+ return Value;
+}
+
+Byte CPU_65XX::ISC(Byte Value) {
+ Value++;
+ EatCycles(1);
+ SubtractWithBorrow(Value);
+ return Value;
+}
+
+void CPU_65XX::SAX(Memory& mem, Word Address) { WriteByte(mem, Address, A & X); }
+
+void CPU_65XX::LAX(Byte Value) {
+ A = X = Value;
+ SetZeroNegativeFlags(A);
+}
+
+void CPU_65XX::LAS(Byte Value) {
+ A = X = SP = Value & SP;
+ SetZeroNegativeFlags(A);
+}
+
+// AND, then C is a copy of N
+void CPU_65XX::ANC(Byte Operand) {
+ AND(Operand);
+ PS.C = PS.N;
+}
+
+// AND, then LSR A
+void CPU_65XX::ALR(Byte Operand) {
+ A = LSR(A & Operand);
+}
+
+// AND, then ROR A with C and V taken from bits 6 and 5 of the result. In
+// decimal mode N, Z and V still come from the rotated value, then each nibble
+// is adjusted when the nibble of the AND result it came from is above 4, and
+// the high nibble's adjustment is C
+void CPU_65XX::ARR(Byte Operand) {
+ EatCycles(1);
+ Byte Value = A & Operand;
+ A          = (Value >> 1) | (PS.C << 7);
+ SetZeroNegativeFlags(A);
+ PS.V = ((A >> 6) ^ (A >> 5)) & 1;
+ if (!PS.D) {
+  PS.C = (A >> 6) & 1;
+  return;
+ }
+
+ Byte Low = Value & 0x0F, High = Value >> 4;
+ if (Low + (Low & 1) > 5) A = (A & 0xF0) | ((A + 0x06) & 0x0F);
+ PS.C = High + (High & 1) > 5;
+ if (PS.C) A += 0x60;
+}
+
+// X = (A AND X) - operand, flags like CMP
+void CPU_65XX::SBX(Byte Operand) {
+ EatCycles(1);
+ Byte Value = A & X;
+ PS.C       = (Value >= Operand);
+ X          = Value - Operand;
+ SetZeroNegativeFlags(X);
+}
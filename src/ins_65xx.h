@@ -1,3 +1,6 @@
+#ifndef _INS_65xx_H_
+#define _INS_65xx_H_
+
 #include "common.h"
 
 enum {
@@ -186,4 +189,216 @@ enum {
  INS_BRK_IMPL = 0x00,  //    1       7
  INS_NOP_IMPL = 0xEA,  //    1       2
  INS_RTI_IMPL = 0x40,  //    1       6
-};
\ No newline at end of file
+};
+
+// Undocumented NMOS opcodes, CPU_NMOS_ILLEGAL only. The stable ones, the rest
+// (JAM and the unstable SHA, SHX, SHY, TAS, ANE, LXA) go to the illegal policy
+enum {
+ INS_NOP_IMPL_1A = 0x1A,  //    1       2
+ INS_NOP_IMPL_3A = 0x3A,  //    1       2
+ INS_NOP_IMPL_5A = 0x5A,  //    1       2
+ INS_NOP_IMPL_7A = 0x7A,  //    1       2
+ INS_NOP_IMPL_DA = 0xDA,  //    1       2
+ INS_NOP_IMPL_FA = 0xFA,  //    1       2
+ INS_NOP_IM_80   = 0x80,  //    2       2
+ INS_NOP_IM_82   = 0x82,  //    2       2
+ INS_NOP_IM_89   = 0x89,  //    2       2
+ INS_NOP_IM_C2   = 0xC2,  //    2       2
+ INS_NOP_IM_E2   = 0xE2,  //    2       2
+ INS_NOP_ZP_04   = 0x04,  //    2       3
+ INS_NOP_ZP_44   = 0x44,  //    2       3
+ INS_NOP_ZP_64   = 0x64,  //    2       3
+ INS_NOP_ZPX_14  = 0x14,  //    2       4
+ INS_NOP_ZPX_34  = 0x34,  //    2       4
+ INS_NOP_ZPX_54  = 0x54,  //    2       4
+ INS_NOP_ZPX_74  = 0x74,  //    2       4
+ INS_NOP_ZPX_D4  = 0xD4,  //    2       4
+ INS_NOP_ZPX_F4  = 0xF4,  //    2       4
+ INS_NOP_AB_0C   = 0x0C,  //    3       4
+ INS_NOP_ABX_1C  = 0x1C,  //    3       4 (+1 if crossing page)
+ INS_NOP_ABX_3C  = 0x3C,  //    3       4 (+1 if crossing page)
+ INS_NOP_ABX_5C  = 0x5C,  //    3       4 (+1 if crossing page)
+ INS_NOP_ABX_7C  = 0x7C,  //    3       4 (+1 if crossing page)
+ INS_NOP_ABX_DC  = 0xDC,  //    3       4 (+1 if crossing page)
+ INS_NOP_ABX_FC  = 0xFC,  //    3       4 (+1 if crossing page)
+
+ INS_SLO_ZP      = 0x07,  //    2       5
+ INS_SLO_ZPX     = 0x17,  //    2       6
+ INS_SLO_AB      = 0x0F,  //    3       6
+ INS_SLO_ABX     = 0x1F,  //    3       7
+ INS_SLO_ABY     = 0x1B,  //    3       7
+ INS_SLO_INX     = 0x03,  //    2       8
+ INS_SLO_INY     = 0x13,  //    2       8
+
+ INS_RLA_ZP      = 0x27,  //    2       5
+ INS_RLA_ZPX     = 0x37,  //    2       6
+ INS_RLA_AB      = 0x2F,  //    3       6
+ INS_RLA_ABX     = 0x3F,  //    3       7
+ INS_RLA_ABY     = 0x3B,  //    3       7
+ INS_RLA_INX     = 0x23,  //    2       8
+ INS_RLA_INY     = 0x33,  //    2       8
+
+ INS_SRE_ZP      = 0x47,  //    2       5
+ INS_SRE_ZPX     = 0x57,  //    2       6
+ INS_SRE_AB      = 0x4F,  //    3       6
+ INS_SRE_ABX     = 0x5F,  //    3       7
+ INS_SRE_ABY     = 0x5B,  //    3       7
+ INS_SRE_INX     = 0x43,  //    2       8
+ INS_SRE_INY     = 0x53,  //    2       8
+
+ INS_RRA_ZP      = 0x67,  //    2       5
+ INS_RRA_ZPX     = 0x77,  //    2       6
+ INS_RRA_AB      = 0x6F,  //    3       6
+ INS_RRA_ABX     = 0x7F,  //    3       7
+ INS_RRA_ABY     = 0x7B,  //    3       7
+ INS_RRA_INX     = 0x63,  //    2       8
+ INS_RRA_INY     = 0x73,  //    2       8
+
+ INS_DCP_ZP      = 0xC7,  //    2       5
+ INS_DCP_ZPX     = 0xD7,  //    2       6
+ INS_DCP_AB      = 0xCF,  //    3       6
+ INS_DCP_ABX     = 0xDF,  //    3       7
+ INS_DCP_ABY     = 0xDB,  //    3       7
+ INS_DCP_INX     = 0xC3,  //    2       8
+ INS_DCP_INY     = 0xD3,  //    2       8
+
+ INS_ISC_ZP      = 0xE7,  //    2       5
+ INS_ISC_ZPX     = 0xF7,  //    2       6
+ INS_ISC_AB      = 0xEF,  //    3       6
+ INS_ISC_ABX     = 0xFF,  //    3       7
+ INS_ISC_ABY     = 0xFB,  //    3       7
+ INS_ISC_INX     = 0xE3,  //    2       8
+ INS_ISC_INY     = 0xF3,  //    2       8
+
+ INS_SAX_ZP      = 0x87,  //    2       3
+ INS_SAX_ZPY     = 0x97,  //    2       4
+ INS_SAX_AB      = 0x8F,  //    3       4
+ INS_SAX_INX     = 0x83,  //    2       6
+
+ INS_LAX_ZP      = 0xA7,  //    2       3
+ INS_LAX_ZPY     = 0xB7,  //    2       4
+ INS_LAX_AB      = 0xAF,  //    3       4
+ INS_LAX_ABY     = 0xBF,  //    3       4 (+1 if crossing page)
+ INS_LAX_INX     = 0xA3,  //    2       6
+ INS_LAX_INY     = 0xB3,  //    2       5 (+1 if crossing page)
+
+ INS_ANC_IM      = 0x0B,  //    2       2
+ INS_ANC_IM_2B   = 0x2B,  //    2       2
+ INS_ALR_IM      = 0x4B,  //    2       2
+ INS_ARR_IM      = 0x6B,  //    2       2
+ INS_SBX_IM      = 0xCB,  //    2       2
+ INS_SBC_IM_EB   = 0xEB,  //    2       2
+ INS_LAS_ABY     = 0xBB,  //    3       4 (+1 if crossing page)
+};
+
+// 65C02 additions, CPU_65C02 and up
+enum {
+ INS_BRA_REL  = 0x80,  //    2       3 (+1 if to a new page)
+ INS_PHX_IMPL = 0xDA,  //    1       3
+ INS_PHY_IMPL = 0x5A,  //    1       3
+ INS_PLX_IMPL = 0xFA,  //    1       4
+ INS_PLY_IMPL = 0x7A,  //    1       4
+ INS_STZ_ZP   = 0x64,  //    2       3
+ INS_STZ_ZPX  = 0x74,  //    2       4
+ INS_STZ_AB   = 0x9C,  //    3       4
+ INS_STZ_ABX  = 0x9E,  //    3       5
+ INS_TSB_ZP   = 0x04,  //    2       5
+ INS_TSB_AB   = 0x0C,  //    3       6
+ INS_TRB_ZP   = 0x14,  //    2       5
+ INS_TRB_AB   = 0x1C,  //    3       6
+ INS_INC_A    = 0x1A,  //    1       2
+ INS_DEC_A    = 0x3A,  //    1       2
+ INS_BIT_IM   = 0x89,  //    2       2
+ INS_BIT_ZPX  = 0x34,  //    2       4
+ INS_BIT_ABX  = 0x3C,  //    3       4
+ INS_ORA_INZ  = 0x12,  //    2       5
+ INS_AND_INZ  = 0x32,  //    2       5
+ INS_EOR_INZ  = 0x52,  //    2       5
+ INS_ADC_INZ  = 0x72,  //    2       5
+ INS_STA_INZ  = 0x92,  //    2       5
+ INS_LDA_INZ  = 0xB2,  //    2       5
+ INS_CMP_INZ  = 0xD2,  //    2       5
+ INS_SBC_INZ  = 0xF2,  //    2       5
+ INS_JMP_INX  = 0x7C,  //    3       6
+};
+
+// Rockwell bit instructions, CPU_R65C02 and up. The bit is the opcode row
+enum {
+ INS_RMB0_ZP  = 0x07,  //    2       5
+ INS_RMB1_ZP  = 0x17,  //    2       5
+ INS_RMB2_ZP  = 0x27,  //    2       5
+ INS_RMB3_ZP  = 0x37,  //    2       5
+ INS_RMB4_ZP  = 0x47,  //    2       5
+ INS_RMB5_ZP  = 0x57,  //    2       5
+ INS_RMB6_ZP  = 0x67,  //    2       5
+ INS_RMB7_ZP  = 0x77,  //    2       5
+
+ INS_SMB0_ZP  = 0x87,  //    2       5
+ INS_SMB1_ZP  = 0x97,  //    2       5
+ INS_SMB2_ZP  = 0xA7,  //    2       5
+ INS_SMB3_ZP  = 0xB7,  //    2       5
+ INS_SMB4_ZP  = 0xC7,  //    2       5
+ INS_SMB5_ZP  = 0xD7,  //    2       5
+ INS_SMB6_ZP  = 0xE7,  //    2       5
+ INS_SMB7_ZP  = 0xF7,  //    2       5
+
+ INS_BBR0_ZPR = 0x0F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBR1_ZPR = 0x1F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBR2_ZPR = 0x2F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBR3_ZPR = 0x3F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBR4_ZPR = 0x4F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBR5_ZPR = 0x5F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBR6_ZPR = 0x6F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBR7_ZPR = 0x7F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+
+ INS_BBS0_ZPR = 0x8F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBS1_ZPR = 0x9F,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBS2_ZPR = 0xAF,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBS3_ZPR = 0xBF,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBS4_ZPR = 0xCF,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBS5_ZPR = 0xDF,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBS6_ZPR = 0xEF,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+ INS_BBS7_ZPR = 0xFF,  //    3       5 (+1 if branch succeeds. +2 if to a new page)
+};
+
+// WDC low power instructions, CPU_W65C02 only
+enum {
+ INS_WAI_IMPL = 0xCB,  //    1       3
+ INS_STP_IMPL = 0xDB,  //    1       3
+};
+
+// ADDRESSING MODES
+enum {
+ MODE_NONE,  // Not an instruction of the variant
+ MODE_IMPL,
+ MODE_ACC,
+ MODE_IM,
+ MODE_ZP,
+ MODE_ZPX,
+ MODE_ZPY,
+ MODE_AB,
+ MODE_ABX,
+ MODE_ABY,
+ MODE_IN,
+ MODE_INX,
+ MODE_INY,
+ MODE_REL,
+ MODE_INZ,   // (zp), CMOS
+ MODE_INAX,  // (abs,X), CMOS JMP
+ MODE_ZPR,   // zp,rel, Rockwell BBR/BBS
+ MODE_COUNT,
+};
+
+struct InstructionInfo {
+ const char* Mnemonic;
+ Byte Mode;
+ Byte Cycles;  // Base cycles, without page cross and branch penalties
+};
+
+// Metadata of every opcode as Variant (a CPU_* value) executes it, opcodes
+// that variant has no instruction for have Mode == MODE_NONE
+const InstructionInfo& GetInstruction(Byte Opcode, int Variant = 0);
+Byte InstructionLength(Byte Mode);
+const char* ModeName(Byte Mode);
+
+#endif
@@ -0,0 +1,377 @@
+#include "ins_65xx.h"
+
+#include "common.h"
+#include "cpu_6502.h"
+
+namespace {
+
+struct TableEntry {
+ Byte Opcode;
+ InstructionInfo Info;
+};
+
+const TableEntry Documented[] = {
+ {INS_LDA_IM, {"LDA", MODE_IM, 2}},
+ {INS_LDA_ZP, {"LDA", MODE_ZP, 3}},
+ {INS_LDA_ZPX, {"LDA", MODE_ZPX, 4}},
+ {INS_LDA_AB, {"LDA", MODE_AB, 4}},
+ {INS_LDA_ABX, {"LDA", MODE_ABX, 4}},
+ {INS_LDA_ABY, {"LDA", MODE_ABY, 4}},
+ {INS_LDA_INX, {"LDA", MODE_INX, 6}},
+ {INS_LDA_INY, {"LDA", MODE_INY, 5}},
+ {INS_LDX_IM, {"LDX", MODE_IM, 2}},
+ {INS_LDX_ZP, {"LDX", MODE_ZP, 3}},
+ {INS_LDX_ZPY, {"LDX", MODE_ZPY, 4}},
+ {INS_LDX_AB, {"LDX", MODE_AB, 4}},
+ {INS_LDX_ABY, {"LDX", MODE_ABY, 4}},
+ {INS_LDY_IM, {"LDY", MODE_IM, 2}},
+ {INS_LDY_ZP, {"LDY", MODE_ZP, 3}},
+ {INS_LDY_ZPX, {"LDY", MODE_ZPX, 4}},
+ {INS_LDY_AB, {"LDY", MODE_AB, 4}},
+ {INS_LDY_ABX, {"LDY", MODE_ABX, 4}},
+ {INS_STA_ZP, {"STA", MODE_ZP, 3}},
+ {INS_STA_ZPX, {"STA", MODE_ZPX, 4}},
+ {INS_STA_AB, {"STA", MODE_AB, 4}},
+ {INS_STA_ABX, {"STA", MODE_ABX, 5}},
+ {INS_STA_ABY, {"STA", MODE_ABY, 5}},
+ {INS_STA_INX, {"STA", MODE_INX, 6}},
+ {INS_STA_INY, {"STA", MODE_INY, 6}},
+ {INS_STX_ZP, {"STX", MODE_ZP, 3}},
+ {INS_STX_ZPY, {"STX", MODE_ZPY, 4}},
+ {INS_STX_AB, {"STX", MODE_AB, 4}},
+ {INS_STY_ZP, {"STY", MODE_ZP, 3}},
+ {INS_STY_ZPX, {"STY", MODE_ZPX, 4}},
+ {INS_STY_AB, {"STY", MODE_AB, 4}},
+ {INS_TAX_IMPL, {"TAX", MODE_IMPL, 2}},
+ {INS_TXA_IMPL, {"TXA", MODE_IMPL, 2}},
+ {INS_TAY_IMPL, {"TAY", MODE_IMPL, 2}},
+ {INS_TYA_IMPL, {"TYA", MODE_IMPL, 2}},
+ {INS_TSX_IMPL, {"TSX", MODE_IMPL, 2}},
+ {INS_TXS_IMPL, {"TXS", MODE_IMPL, 2}},
+ {INS_PHA_IMPL, {"PHA", MODE_IMPL, 3}},
+ {INS_PHP_IMPL, {"PHP", MODE_IMPL, 3}},
+ {INS_PLA_IMPL, {"PLA", MODE_IMPL, 4}},
+ {INS_PLP_IMPL, {"PLP", MODE_IMPL, 4}},
+ {INS_AND_IM, {"AND", MODE_IM, 2}},
+ {INS_AND_ZP, {"AND", MODE_ZP, 3}},
+ {INS_AND_ZPX, {"AND", MODE_ZPX, 4}},
+ {INS_AND_AB, {"AND", MODE_AB, 4}},
+ {INS_AND_ABX, {"AND", MODE_ABX, 4}},
+ {INS_AND_ABY, {"AND", MODE_ABY, 4}},
+ {INS_AND_INX, {"AND", MODE_INX, 6}},
+ {INS_AND_INY, {"AND", MODE_INY, 5}},
+ {INS_EOR_IM, {"EOR", MODE_IM, 2}},
+ {INS_EOR_ZP, {"EOR", MODE_ZP, 3}},
+ {INS_EOR_ZPX, {"EOR", MODE_ZPX, 4}},
+ {INS_EOR_AB, {"EOR", MODE_AB, 4}},
+ {INS_EOR_ABX, {"EOR", MODE_ABX, 4}},
+ {INS_EOR_ABY, {"EOR", MODE_ABY, 4}},
+ {INS_EOR_INX, {"EOR", MODE_INX, 6}},
+ {INS_EOR_INY, {"EOR", MODE_INY, 5}},
+ {INS_ORA_IM, {"ORA", MODE_IM, 2}},
+ {INS_ORA_ZP, {"ORA", MODE_ZP, 3}},
+ {INS_ORA_ZPX, {"ORA", MODE_ZPX, 4}},
+ {INS_ORA_AB, {"ORA", MODE_AB, 4}},
+ {INS_ORA_ABX, {"ORA", MODE_ABX, 4}},
+ {INS_ORA_ABY, {"ORA", MODE_ABY, 4}},
+ {INS_ORA_INX, {"ORA", MODE_INX, 6}},
+ {INS_ORA_INY, {"ORA", MODE_INY, 5}},
+ {INS_BIT_ZP, {"BIT", MODE_ZP, 3}},
+ {INS_BIT_AB, {"BIT", MODE_AB, 4}},
+ {INS_ADC_IM, {"ADC", MODE_IM, 2}},
+ {INS_ADC_ZP, {"ADC", MODE_ZP, 3}},
+ {INS_ADC_ZPX, {"ADC", MODE_ZPX, 4}},
+ {INS_ADC_AB, {"ADC", MODE_AB, 4}},
+ {INS_ADC_ABX, {"ADC", MODE_ABX, 4}},
+ {INS_ADC_ABY, {"ADC", MODE_ABY, 4}},
+ {INS_ADC_INX, {"ADC", MODE_INX, 6}},
+ {INS_ADC_INY, {"ADC", MODE_INY, 5}},
+ {INS_SBC_IM, {"SBC", MODE_IM, 2}},
+ {INS_SBC_ZP, {"SBC", MODE_ZP, 3}},
+ {INS_SBC_ZPX, {"SBC", MODE_ZPX, 4}},
+ {INS_SBC_AB, {"SBC", MODE_AB, 4}},
+ {INS_SBC_ABX, {"SBC", MODE_ABX, 4}},
+ {INS_SBC_ABY, {"SBC", MODE_ABY, 4}},
+ {INS_SBC_INX, {"SBC", MODE_INX, 6}},
+ {INS_SBC_INY, {"SBC", MODE_INY, 5}},
+ {INS_CMP_IM, {"CMP", MODE_IM, 2}},
+ {INS_CMP_ZP, {"CMP", MODE_ZP, 3}},
+ {INS_CMP_ZPX, {"CMP", MODE_ZPX, 4}},
+ {INS_CMP_AB, {"CMP", MODE_AB, 4}},
+ {INS_CMP_ABX, {"CMP", MODE_ABX, 4}},
+ {INS_CMP_ABY, {"CMP", MODE_ABY, 4}},
+ {INS_CMP_INX, {"CMP", MODE_INX, 6}},
+ {INS_CMP_INY, {"CMP", MODE_INY, 5}},
+ {INS_CPX_IM, {"CPX", MODE_IM, 2}},
+ {INS_CPX_ZP, {"CPX", MODE_ZP, 3}},
+ {INS_CPX_AB, {"CPX", MODE_AB, 4}},
+ {INS_CPY_IM, {"CPY", MODE_IM, 2}},
+ {INS_CPY_ZP, {"CPY", MODE_ZP, 3}},
+ {INS_CPY_AB, {"CPY", MODE_AB, 4}},
+ {INS_INC_ZP, {"INC", MODE_ZP, 5}},
+ {INS_INC_ZPX, {"INC", MODE_ZPX, 6}},
+ {INS_INC_AB, {"INC", MODE_AB, 6}},
+ {INS_INC_ABX, {"INC", MODE_ABX, 7}},
+ {INS_INX_IMPL, {"INX", MODE_IMPL, 2}},
+ {INS_INY_IMPL, {"INY", MODE_IMPL, 2}},
+ {INS_DEC_ZP, {"DEC", MODE_ZP, 5}},
+ {INS_DEC_ZPX, {"DEC", MODE_ZPX, 6}},
+ {INS_DEC_AB, {"DEC", MODE_AB, 6}},
+ {INS_DEC_ABX, {"DEC", MODE_ABX, 7}},
+ {INS_DEX_IMPL, {"DEX", MODE_IMPL, 2}},
+ {INS_DEY_IMPL, {"DEY", MODE_IMPL, 2}},
+ {INS_ASL_A, {"ASL", MODE_ACC, 2}},
+ {INS_ASL_ZP, {"ASL", MODE_ZP, 5}},
+ {INS_ASL_ZPX, {"ASL", MODE_ZPX, 6}},
+ {INS_ASL_AB, {"ASL", MODE_AB, 6}},
+ {INS_ASL_ABX, {"ASL", MODE_ABX, 7}},
+ {INS_LSR_A, {"LSR", MODE_ACC, 2}},
+ {INS_LSR_ZP, {"LSR", MODE_ZP, 5}},
+ {INS_LSR_ZPX, {"LSR", MODE_ZPX, 6}},
+ {INS_LSR_AB, {"LSR", MODE_AB, 6}},
+ {INS_LSR_ABX, {"LSR", MODE_ABX, 7}},
+ {INS_ROL_A, {"ROL", MODE_ACC, 2}},
+ {INS_ROL_ZP, {"ROL", MODE_ZP, 5}},
+ {INS_ROL_ZPX, {"ROL", MODE_ZPX, 6}},
+ {INS_ROL_AB, {"ROL", MODE_AB, 6}},
+ {INS_ROL_ABX, {"ROL", MODE_ABX, 7}},
+ {INS_ROR_A, {"ROR", MODE_ACC, 2}},
+ {INS_ROR_ZP, {"ROR", MODE_ZP, 5}},
+ {INS_ROR_ZPX, {"ROR", MODE_ZPX, 6}},
+ {INS_ROR_AB, {"ROR", MODE_AB, 6}},
+ {INS_ROR_ABX, {"ROR", MODE_ABX, 7}},
+ {INS_JMP_AB, {"JMP", MODE_AB, 3}},
+ {INS_JMP_IN, {"JMP", MODE_IN, 5}},
+ {INS_JSR_AB, {"JSR", MODE_AB, 6}},
+ {INS_RTS_IMPL, {"RTS", MODE_IMPL, 6}},
+ {INS_BCC_REL, {"BCC", MODE_REL, 2}},
+ {INS_BCS_REL, {"BCS", MODE_REL, 2}},
+ {INS_BEQ_REL, {"BEQ", MODE_REL, 2}},
+ {INS_BMI_REL, {"BMI", MODE_REL, 2}},
+ {INS_BNE_REL, {"BNE", MODE_REL, 2}},
+ {INS_BPL_REL, {"BPL", MODE_REL, 2}},
+ {INS_BVC_REL, {"BVC", MODE_REL, 2}},
+ {INS_BVS_REL, {"BVS", MODE_REL, 2}},
+ {INS_CLC_IMPL, {"CLC", MODE_IMPL, 2}},
+ {INS_CLD_IMPL, {"CLD", MODE_IMPL, 2}},
+ {INS_CLI_IMPL, {"CLI", MODE_IMPL, 2}},
+ {INS_CLV_IMPL, {"CLV", MODE_IMPL, 2}},
+ {INS_SEC_IMPL, {"SEC", MODE_IMPL, 2}},
+ {INS_SED_IMPL, {"SED", MODE_IMPL, 2}},
+ {INS_SEI_IMPL, {"SEI", MODE_IMPL, 2}},
+ {INS_BRK_IMPL, {"BRK", MODE_IMPL, 7}},
+ {INS_NOP_IMPL, {"NOP", MODE_IMPL, 2}},
+ {INS_RTI_IMPL, {"RTI", MODE_IMPL, 6}},
+};
+
+// CPU_NMOS_ILLEGAL, the stable undocumented opcodes of ops_6502x.h
+const TableEntry Undocumented[] = {
+ {INS_NOP_IMPL_1A, {"NOP", MODE_IMPL, 2}},
+ {INS_NOP_IMPL_3A, {"NOP", MODE_IMPL, 2}},
+ {INS_NOP_IMPL_5A, {"NOP", MODE_IMPL, 2}},
+ {INS_NOP_IMPL_7A, {"NOP", MODE_IMPL, 2}},
+ {INS_NOP_IMPL_DA, {"NOP", MODE_IMPL, 2}},
+ {INS_NOP_IMPL_FA, {"NOP", MODE_IMPL, 2}},
+ {INS_NOP_IM_80, {"NOP", MODE_IM, 2}},
+ {INS_NOP_IM_82, {"NOP", MODE_IM, 2}},
+ {INS_NOP_IM_89, {"NOP", MODE_IM, 2}},
+ {INS_NOP_IM_C2, {"NOP", MODE_IM, 2}},
+ {INS_NOP_IM_E2, {"NOP", MODE_IM, 2}},
+ {INS_NOP_ZP_04, {"NOP", MODE_ZP, 3}},
+ {INS_NOP_ZP_44, {"NOP", MODE_ZP, 3}},
+ {INS_NOP_ZP_64, {"NOP", MODE_ZP, 3}},
+ {INS_NOP_ZPX_14, {"NOP", MODE_ZPX, 4}},
+ {INS_NOP_ZPX_34, {"NOP", MODE_ZPX, 4}},
+ {INS_NOP_ZPX_54, {"NOP", MODE_ZPX, 4}},
+ {INS_NOP_ZPX_74, {"NOP", MODE_ZPX, 4}},
+ {INS_NOP_ZPX_D4, {"NOP", MODE_ZPX, 4}},
+ {INS_NOP_ZPX_F4, {"NOP", MODE_ZPX, 4}},
+ {INS_NOP_AB_0C, {"NOP", MODE_AB, 4}},
+ {INS_NOP_ABX_1C, {"NOP", MODE_ABX, 4}},
+ {INS_NOP_ABX_3C, {"NOP", MODE_ABX, 4}},
+ {INS_NOP_ABX_5C, {"NOP", MODE_ABX, 4}},
+ {INS_NOP_ABX_7C, {"NOP", MODE_ABX, 4}},
+ {INS_NOP_ABX_DC, {"NOP", MODE_ABX, 4}},
+ {INS_NOP_ABX_FC, {"NOP", MODE_ABX, 4}},
+ {INS_SLO_ZP, {"SLO", MODE_ZP, 5}},
+ {INS_SLO_ZPX, {"SLO", MODE_ZPX, 6}},
+ {INS_SLO_AB, {"SLO", MODE_AB, 6}},
+ {INS_SLO_ABX, {"SLO", MODE_ABX, 7}},
+ {INS_SLO_ABY, {"SLO", MODE_ABY, 7}},
+ {INS_SLO_INX, {"SLO", MODE_INX, 8}},
+ {INS_SLO_INY, {"SLO", MODE_INY, 8}},
+ {INS_RLA_ZP, {"RLA", MODE_ZP, 5}},
+ {INS_RLA_ZPX, {"RLA", MODE_ZPX, 6}},
+ {INS_RLA_AB, {"RLA", MODE_AB, 6}},
+ {INS_RLA_ABX, {"RLA", MODE_ABX, 7}},
+ {INS_RLA_ABY, {"RLA", MODE_ABY, 7}},
+ {INS_RLA_INX, {"RLA", MODE_INX, 8}},
+ {INS_RLA_INY, {"RLA", MODE_INY, 8}},
+ {INS_SRE_ZP, {"SRE", MODE_ZP, 5}},
+ {INS_SRE_ZPX, {"SRE", MODE_ZPX, 6}},
+ {INS_SRE_AB, {"SRE", MODE_AB, 6}},
+ {INS_SRE_ABX, {"SRE", MODE_ABX, 7}},
+ {INS_SRE_ABY, {"SRE", MODE_ABY, 7}},
+ {INS_SRE_INX, {"SRE", MODE_INX, 8}},
+ {INS_SRE_INY, {"SRE", MODE_INY, 8}},
+ {INS_RRA_ZP, {"RRA", MODE_ZP, 5}},
+ {INS_RRA_ZPX, {"RRA", MODE_ZPX, 6}},
+ {INS_RRA_AB, {"RRA", MODE_AB, 6}},
+ {INS_RRA_ABX, {"RRA", MODE_ABX, 7}},
+ {INS_RRA_ABY, {"RRA", MODE_ABY, 7}},
+ {INS_RRA_INX, {"RRA", MODE_INX, 8}},
+ {INS_RRA_INY, {"RRA", MODE_INY, 8}},
+ {INS_DCP_ZP, {"DCP", MODE_ZP, 5}},
+ {INS_DCP_ZPX, {"DCP", MODE_ZPX, 6}},
+ {INS_DCP_AB, {"DCP", MODE_AB, 6}},
+ {INS_DCP_ABX, {"DCP", MODE_ABX, 7}},
+ {INS_DCP_ABY, {"DCP", MODE_ABY, 7}},
+ {INS_DCP_INX, {"DCP", MODE_INX, 8}},
+ {INS_DCP_INY, {"DCP", MODE_INY, 8}},
+ {INS_ISC_ZP, {"ISC", MODE_ZP, 5}},
+ {INS_ISC_ZPX, {"ISC", MODE_ZPX, 6}},
+ {INS_ISC_AB, {"ISC", MODE_AB, 6}},
+ {INS_ISC_ABX, {"ISC", MODE_ABX, 7}},
+ {INS_ISC_ABY, {"ISC", MODE_ABY, 7}},
+ {INS_ISC_INX, {"ISC", MODE_INX, 8}},
+ {INS_ISC_INY, {"ISC", MODE_INY, 8}},
+ {INS_SAX_ZP, {"SAX", MODE_ZP, 3}},
+ {INS_SAX_ZPY, {"SAX", MODE_ZPY, 4}},
+ {INS_SAX_AB, {"SAX", MODE_AB, 4}},
+ {INS_SAX_INX, {"SAX", MODE_INX, 6}},
+ {INS_LAX_ZP, {"LAX", MODE_ZP, 3}},
+ {INS_LAX_ZPY, {"LAX", MODE_ZPY, 4}},
+ {INS_LAX_AB, {"LAX", MODE_AB, 4}},
+ {INS_LAX_ABY, {"LAX", MODE_ABY, 4}},
+ {INS_LAX_INX, {"LAX", MODE_INX, 6}},
+ {INS_LAX_INY, {"LAX", MODE_INY, 5}},
+ {INS_ANC_IM, {"ANC", MODE_IM, 2}},
+ {INS_ANC_IM_2B, {"ANC", MODE_IM, 2}},
+ {INS_ALR_IM, {"ALR", MODE_IM, 2}},
+ {INS_ARR_IM, {"ARR", MODE_IM, 2}},
+ {INS_SBX_IM, {"SBX", MODE_IM, 2}},
+ {INS_SBC_IM_EB, {"SBC", MODE_IM, 2}},
+ {INS_LAS_ABY, {"LAS", MODE_ABY, 4}},
+};
+
+// What the CMOS parts do with the opcodes they leave free, laid down before
+// the instructions like the handler tables do
+const TableEntry Reserved[] = {
+ {0x44, {"NOP", MODE_ZP, 3}},
+ {0x54, {"NOP", MODE_ZPX, 4}},
+ {0xD4, {"NOP", MODE_ZPX, 4}},
+ {0xF4, {"NOP", MODE_ZPX, 4}},
+ {0x5C, {"NOP", MODE_AB, 8}},
+ {0xDC, {"NOP", MODE_AB, 4}},
+ {0xFC, {"NOP", MODE_AB, 4}},
+};
+
+// CPU_65C02 and up, ops_65c02.h
+const TableEntry CMOS[] = {
+ {INS_BRA_REL, {"BRA", MODE_REL, 3}},
+ {INS_PHX_IMPL, {"PHX", MODE_IMPL, 3}},
+ {INS_PHY_IMPL, {"PHY", MODE_IMPL, 3}},
+ {INS_PLX_IMPL, {"PLX", MODE_IMPL, 4}},
+ {INS_PLY_IMPL, {"PLY", MODE_IMPL, 4}},
+ {INS_STZ_ZP, {"STZ", MODE_ZP, 3}},
+ {INS_STZ_ZPX, {"STZ", MODE_ZPX, 4}},
+ {INS_STZ_AB, {"STZ", MODE_AB, 4}},
+ {INS_STZ_ABX, {"STZ", MODE_ABX, 5}},
+ {INS_TSB_ZP, {"TSB", MODE_ZP, 5}},
+ {INS_TSB_AB, {"TSB", MODE_AB, 6}},
+ {INS_TRB_ZP, {"TRB", MODE_ZP, 5}},
+ {INS_TRB_AB, {"TRB", MODE_AB, 6}},
+ {INS_INC_A, {"INC", MODE_ACC, 2}},
+ {INS_DEC_A, {"DEC", MODE_ACC, 2}},
+ {INS_BIT_IM, {"BIT", MODE_IM, 2}},
+ {INS_BIT_ZPX, {"BIT", MODE_ZPX, 4}},
+ {INS_BIT_ABX, {"BIT", MODE_ABX, 4}},
+ {INS_ORA_INZ, {"ORA", MODE_INZ, 5}},
+ {INS_AND_INZ, {"AND", MODE_INZ, 5}},
+ {INS_EOR_INZ, {"EOR", MODE_INZ, 5}},
+ {INS_ADC_INZ, {"ADC", MODE_INZ, 5}},
+ {INS_STA_INZ, {"STA", MODE_INZ, 5}},
+ {INS_LDA_INZ, {"LDA", MODE_INZ, 5}},
+ {INS_CMP_INZ, {"CMP", MODE_INZ, 5}},
+ {INS_SBC_INZ, {"SBC", MODE_INZ, 5}},
+ {INS_JMP_INX, {"JMP", MODE_INAX, 6}},
+ {INS_JMP_IN, {"JMP", MODE_IN, 6}},
+};
+
+const char* const RMB[8] = {"RMB0", "RMB1", "RMB2", "RMB3", "RMB4", "RMB5", "RMB6", "RMB7"};
+const char* const SMB[8] = {"SMB0", "SMB1", "SMB2", "SMB3", "SMB4", "SMB5", "SMB6", "SMB7"};
+const char* const BBR[8] = {"BBR0", "BBR1", "BBR2", "BBR3", "BBR4", "BBR5", "BBR6", "BBR7"};
+const char* const BBS[8] = {"BBS0", "BBS1", "BBS2", "BBS3", "BBS4", "BBS5", "BBS6", "BBS7"};
+
+// CPU_W65C02, ops_w65c02.h
+const TableEntry WDC[] = {
+ {INS_WAI_IMPL, {"WAI", MODE_IMPL, 3}},
+ {INS_STP_IMPL, {"STP", MODE_IMPL, 3}},
+};
+
+// Built the way cpu_6502.cpp builds the handler tables, so every variant
+// names exactly the opcodes it executes
+struct InstructionTable {
+ InstructionInfo Entries[256];
+
+ template <size_t Count>
+ void Add(const TableEntry (&List)[Count]) {
+  for (const TableEntry& Ins : List) Entries[Ins.Opcode] = Ins.Info;
+ }
+
+ InstructionTable(int Chip) {
+  for (InstructionInfo& Entry : Entries)
+   Entry = {"???", MODE_NONE, 2};
+
+  if (IsCMOS(Chip)) {
+   for (int Op = 0x03; Op < 0x100; Op += 0x04) Entries[Op] = {"NOP", MODE_IMPL, 1};
+   for (int Op = 0x02; Op < 0x100; Op += 0x20) Entries[Op] = {"NOP", MODE_IM, 2};
+   Add(Reserved);
+  }
+  Add(Documented);
+  if (Chip == CPU_NMOS_ILLEGAL) Add(Undocumented);
+  if (IsCMOS(Chip)) Add(CMOS);
+  if (Chip == CPU_R65C02 || Chip == CPU_W65C02) {
+   for (int Bit = 0; Bit < 8; Bit++) {
+    Entries[(Bit << 4) | 0x07] = {RMB[Bit], MODE_ZP, 5};
+    Entries[(Bit << 4) | 0x87] = {SMB[Bit], MODE_ZP, 5};
+    Entries[(Bit << 4) | 0x0F] = {BBR[Bit], MODE_ZPR, 5};
+    Entries[(Bit << 4) | 0x8F] = {BBS[Bit], MODE_ZPR, 5};
+   }
+  }
+  if (Chip == CPU_W65C02) Add(WDC);
+ }
+};
+
+const InstructionTable Tables[CPU_VARIANTS] = {CPU_NMOS, CPU_NMOS_ILLEGAL, CPU_65C02, CPU_R65C02, CPU_W65C02};
+
+}  // namespace
+
+const InstructionInfo& GetInstruction(Byte Opcode, int Variant) { return Tables[ChipModel(Variant)].Entries[Opcode]; }
+
+Byte InstructionLength(Byte Mode) {
+ switch (Mode) {
+ case MODE_IM:
+ case MODE_ZP:
+ case MODE_ZPX:
+ case MODE_ZPY:
+ case MODE_INX:
+ case MODE_INY:
+ case MODE_REL:
+ case MODE_INZ:
+  return 2;
+ case MODE_AB:
+ case MODE_ABX:
+ case MODE_ABY:
+ case MODE_IN:
+ case MODE_INAX:
+ case MODE_ZPR:
+  return 3;
+ }
+ return 1;
+}
+
+const char* ModeName(Byte Mode) {
+ static const char* Names[MODE_COUNT] = {"none", "impl", "acc", "im", "zp", "zpx", "zpy", "ab", "abx", "aby", "in", "inx", "iny", "rel", "inz", "inax", "zpr"};
+ return Mode < MODE_COUNT ? Names[Mode] : "none";
+}
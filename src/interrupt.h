@@ -0,0 +1,37 @@
+#ifndef _INTERRUPT_H_
+#define _INTERRUPT_H_
+
+#include <cstdint>
+
+#include "common.h"
+
+constexpr uint32_t INTERRUPT_NMI      = 0x80000000;  // Latched NMI edge
+constexpr uint32_t INTERRUPT_STOP     = 0x40000000;  // Host asks Execute to return at the next boundary
+constexpr uint32_t INTERRUPT_IRQ_MASK = 0x3FFFFFFF;  // One level triggered bit per source
+constexpr Byte INTERRUPT_IRQ_SOURCES  = 30;
+
+constexpr Word NMI_VECTOR   = 0xFFFA;
+constexpr Word RESET_VECTOR = 0xFFFC;
+constexpr Word IRQ_VECTOR   = 0xFFFE;
+
+// IRQ and NMI inputs of the CPU. Devices assert and release their own IRQ
+// bit; all lines share one word (together with the host stop request) so the
+// CPU tests a single flag per instruction boundary
+struct InterruptLines {
+ uint32_t Signal = 0;
+ Byte NextSource = 0;
+
+ // Returns the IRQ source bit a device should use
+ Byte AllocateIRQ() { return NextSource < INTERRUPT_IRQ_SOURCES ? NextSource++ : INTERRUPT_IRQ_SOURCES - 1; }
+
+ void AssertIRQ(Byte Source) { Signal |= 1u << Source; }
+ void ReleaseIRQ(Byte Source) { Signal &= ~(1u << Source); }
+ void SetIRQ(Byte Source, bool Level) { Level ? AssertIRQ(Source) : ReleaseIRQ(Source); }
+
+ void TriggerNMI() { Signal |= INTERRUPT_NMI; }
+
+ void RequestStop() { Signal |= INTERRUPT_STOP; }
+ void ClearStop() { Signal &= ~INTERRUPT_STOP; }
+};
+
+#endif
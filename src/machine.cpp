@@ -0,0 +1,48 @@
+#include "machine.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "common.h"
+
+Machine::Machine() {
+ Sched.Cpu = &Cpu;
+ Mem.Lines = &Cpu.Lines;
+}
+
+void Machine::Reset() { Cpu.Reset(Mem); }
+
+uint64_t Machine::Run(uint64_t Budget) {
+ uint64_t Start = Cpu.TotalCycles;
+ uint64_t End   = Start + Budget;
+ Cpu.StopReason = STOP_NONE;
+
+ while (Cpu.TotalCycles < End && !Mem.Break) {
+  uint64_t Now      = Cpu.TotalCycles;
+  uint64_t Deadline = std::min(Sched.NextDeadline(), End);
+
+  if (Deadline > Now) {
+   int32_t Slice = std::min<uint64_t>(Deadline - Now, INT32_MAX);
+   if (Fast && !Cpu.Trace)
+    Cpu.ExecuteFast(Slice, Mem);
+   else
+    Cpu.Execute(Slice, Mem);
+  }
+  Sched.RunDue(Cpu.TotalCycles);
+
+  if (Cpu.Lines.Signal & INTERRUPT_STOP) break;
+ }
+ Cpu.Lines.ClearStop();
+
+ return Cpu.TotalCycles - Start;
+}
+
+uint64_t Machine::Step(uint64_t Instructions) {
+ uint64_t Start = Cpu.TotalCycles;
+ Mem.Break      = false;
+ for (uint64_t i = 0; i < Instructions; i++) {
+  Run(1);
+  if (Mem.Break || Cpu.StopReason != STOP_NONE) break;
+ }
+ return Cpu.TotalCycles - Start;
+}
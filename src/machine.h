@@ -0,0 +1,31 @@
+#ifndef _MACHINE_H_
+#define _MACHINE_H_
+
+#include <cstdint>
+
+#include "common.h"
+#include "cpu_6502.h"
+#include "memory.h"
+#include "scheduler.h"
+
+// CPU, memory and device event scheduler wired together
+struct Machine {
+ CPU_6502 Cpu;
+ Memory Mem;
+ Scheduler Sched;
+ bool Fast = false;  // ExecuteFast instead of the reference Execute, unless tracing
+
+ Machine();
+
+ void Reset();
+
+ // Executes about Budget cycles, handing control to due device events in
+ // between. Returns the cycles executed, stops early on a watchpoint hit or
+ // when the CPU sets a StopReason
+ uint64_t Run(uint64_t Budget);
+ // Runs Instructions instructions one at a time, starting over after a
+ // watchpoint hit. Ends early on a new hit or StopReason, returns the cycles
+ uint64_t Step(uint64_t Instructions);
+};
+
+#endif
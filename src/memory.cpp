@@ -3,9 +3,10 @@
 #include <cstdlib>
 
 #include "common.h"
+#include "disasm.h"
 
 void Memory::Init() {
- for (Word i; i < MAX_MEM - 1; i++) {
+ for (uint32_t i = 0; i < MAX_MEM; i++) {
   Data[i] = 0;
  }
 }
@@ -33,4 +34,95 @@ bool Memory::ReadProgram(std::ifstream& Binary, Word StartAddress, Word EndAddre
   Data[Address] = buf;
  }
  return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
+
+void Memory::AttachDevice(MemoryDevice* Device) {
+ Devices.push_back(Device);
+ RebuildTraps();
+}
+
+void Memory::AttachHeatMap(HeatMap* Map) {
+ Heat = Map;
+ RebuildTraps();
+}
+
+void Memory::Invalidate(Word Address, uint32_t Length) {
+ if (Disasm) Disasm->Invalidate(Address, Length);
+}
+
+void Memory::AddWatchpoint(const Watchpoint& Watch) {
+ Watchpoints.push_back(Watch);
+ RebuildTraps();
+}
+
+void Memory::ClearWatchpoints() {
+ Watchpoints.clear();
+ RebuildTraps();
+}
+
+void Memory::RebuildTraps() {
+ for (size_t Page = 0; Page < PAGE_COUNT; Page++)
+  PageTraps[Page] = Heat ? TRAP_READ | TRAP_WRITE | TRAP_EXEC : 0;
+
+ for (const Watchpoint& Watch : Watchpoints) {
+  for (size_t Page = Watch.Begin >> 8; Page <= (size_t)(Watch.End >> 8); Page++)
+   PageTraps[Page] |= Watch.Kind;
+ }
+
+ for (const MemoryDevice* Device : Devices) {
+  for (size_t Page = Device->Begin >> 8; Page <= (size_t)(Device->End >> 8); Page++)
+   PageTraps[Page] |= TRAP_READ | TRAP_WRITE | TRAP_EXEC | TRAP_DEVICE;
+ }
+}
+
+MemoryDevice* Memory::FindDevice(Word Address) const {
+ if (!(PageTraps[Address >> 8] & TRAP_DEVICE)) return nullptr;
+
+ for (MemoryDevice* Device : Devices) {
+  if (Address >= Device->Begin && Address <= Device->End) return Device;
+ }
+ return nullptr;
+}
+
+void Memory::CheckWatchpoints(Word Address, Byte Kind, Byte Value) {
+ for (const Watchpoint& Watch : Watchpoints) {
+  if (!(Watch.Kind & Kind) || Address < Watch.Begin || Address > Watch.End) continue;
+  if (Watch.HasValue && Watch.Value != Value) continue;
+
+  LastHit = {Address, Kind, Value};
+  Break   = true;
+  if (Lines) Lines->RequestStop();
+  return;
+ }
+}
+
+Byte Memory::PeekDevice(Word Address) const {
+ MemoryDevice* Device = FindDevice(Address);
+ const Byte* Backing  = Device ? Device->Peek(Address) : nullptr;
+ return Backing ? *Backing : Data[Address];
+}
+
+Byte Memory::TrapRead(Word Address) {
+ MemoryDevice* Device = FindDevice(Address);
+ Byte Value           = Device ? Device->Read(Address) : Data[Address];
+ if (Heat) Heat->Count(Address, WATCH_READ);
+ CheckWatchpoints(Address, WATCH_READ, Value);
+ return Value;
+}
+
+Byte Memory::TrapFetch(Word Address) {
+ MemoryDevice* Device = FindDevice(Address);
+ Byte Value           = Device ? Device->Read(Address) : Data[Address];
+ if (Heat) Heat->Count(Address, WATCH_EXEC);
+ CheckWatchpoints(Address, WATCH_EXEC, Value);
+ return Value;
+}
+
+void Memory::TrapWrite(Word Address, Byte Value) {
+ if (MemoryDevice* Device = FindDevice(Address))
+  Device->Write(Address, Value);
+ else
+  Data[Address] = Value;
+ if (Heat) Heat->Count(Address, WATCH_WRITE);
+ CheckWatchpoints(Address, WATCH_WRITE, Value);
+}
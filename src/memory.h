@@ -2,16 +2,43 @@
 #define _MEMORY_H_
 
 #include <fstream>
+#include <vector>
 
 #include <cstdint>
 #include <cstdio>
 
 #include "common.h"
+#include "device.h"
+#include "heatmap.h"
+#include "interrupt.h"
+#include "watchpoint.h"
 
-constexpr uint32_t MAX_MEM = 1024 * 64;
+struct Disassembler;
+
+constexpr uint32_t MAX_MEM    = 1024 * 64;
+constexpr uint32_t PAGE_SIZE  = 0x100;
+constexpr uint32_t PAGE_COUNT = MAX_MEM / PAGE_SIZE;
+
+// Per-page trap bits, a page with no bits set takes the plain array access
+enum {
+ TRAP_READ   = WATCH_READ,
+ TRAP_WRITE  = WATCH_WRITE,
+ TRAP_EXEC   = WATCH_EXEC,
+ TRAP_DEVICE = 0x08,
+};
 
 struct Memory {
- Byte Data[MAX_MEM];
+ Byte Storage[MAX_MEM];
+ Byte* Data = Storage;  // May be repointed at a shared segment, see shm_export.h
+ Byte PageTraps[PAGE_COUNT] = {};
+
+ std::vector<MemoryDevice*> Devices;
+ std::vector<Watchpoint> Watchpoints;
+ WatchHit LastHit;
+ bool Break = false;  // Set by a watchpoint hit, cleared by the caller
+ InterruptLines* Lines = nullptr;  // Asked to stop the CPU on a watchpoint hit
+ HeatMap* Heat         = nullptr;  // Traps every page while attached
+ Disassembler* Disasm  = nullptr;  // Told about writes from outside the CPU
 
  void Init();
 
@@ -19,9 +46,50 @@ struct Memory {
 
  bool ReadProgram(std::ifstream& Binary, Word StartAddress = 0x0, Word EndAddress = MAX_MEM - 1);
 
+ void AttachDevice(MemoryDevice* Device);
+
+ void AttachHeatMap(HeatMap* Map);
+
+ // Length bytes at Address were written by something other than the CPU:
+ // DMA or the host
+ void Invalidate(Word Address, uint32_t Length);
+
+ void AddWatchpoint(const Watchpoint& Watch);
+ void ClearWatchpoints();
+
+ // Bus interface used by the CPU, checks page trap bits before touching Data
+ Byte Read(Word Address) {
+  if (PageTraps[Address >> 8] & TRAP_READ) return TrapRead(Address);
+  return Data[Address];
+ }
+ Byte Fetch(Word Address) {
+  if (PageTraps[Address >> 8] & TRAP_EXEC) return TrapFetch(Address);
+  return Data[Address];
+ }
+ void Write(Word Address, Byte Value) {
+  if (PageTraps[Address >> 8] & TRAP_WRITE) return TrapWrite(Address, Value);
+  Data[Address] = Value;
+ }
+
+ // What Address holds, without an access anybody sees. For the trace and the
+ // disassembler, which would read stale Data where a device keeps the bytes
+ Byte Peek(Word Address) const {
+  if (PageTraps[Address >> 8] & TRAP_DEVICE) return PeekDevice(Address);
+  return Data[Address];
+ }
+
  // Memory interface
  Byte operator[](Word Address) const { return Data[Address]; }
  Byte& operator[](Word Address) { return Data[Address]; }
+
+ // Slow path for trapped pages
+ Byte TrapRead(Word Address);
+ Byte TrapFetch(Word Address);
+ void TrapWrite(Word Address, Byte Value);
+ Byte PeekDevice(Word Address) const;
+ MemoryDevice* FindDevice(Word Address) const;
+ void CheckWatchpoints(Word Address, Byte Kind, Byte Value);
+ void RebuildTraps();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,119 @@
+#include "monitor.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "emu_thread.h"
+
+static const char* ThreadStateName(int State) {
+ switch (State) {
+ case THREAD_RUNNING:
+  return "running";
+ case THREAD_PAUSED:
+  return "paused";
+ case THREAD_HALTED:
+  return "halted";
+ case THREAD_FINISHED:
+  return "finished";
+ }
+ return "exited";
+}
+
+static void PrintRegisters(EmulationThread& Thread) {
+ MachineSnapshot Snapshot;
+ Thread.Snapshot(Snapshot).wait();
+ printf("PC 0x%04x A 0x%02x X 0x%02x Y 0x%02x SP 0x%02x P 0x%02x, cycle %llu, %s\n", Snapshot.PC, Snapshot.A, Snapshot.X, Snapshot.Y, Snapshot.SP, Snapshot.P, (unsigned long long)Snapshot.Cycles, ThreadStateName(Snapshot.State));
+}
+
+static void WaitWhileRunning(EmulationThread& Thread) {
+ while (Thread.State.load(std::memory_order_acquire) == THREAD_RUNNING) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+bool RunMonitor(Machine& M, uint64_t Budget, const std::string& Path) {
+ FILE* Input = Path == "-" ? stdin : fopen(Path.c_str(), "r");
+ if (!Input) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ EmulationThread Thread(M, Budget);
+ Thread.Start();
+
+ char Line[256];
+ bool Quit = false;
+ while (!Quit && fgets(Line, sizeof(Line), Input)) {
+  char* Arguments = Line + 1;
+  switch (Line[0]) {
+  case 'p':
+   Thread.Pause().wait();
+   break;
+  case 'c':
+   Thread.Resume().wait();
+   break;
+  case 's': {
+   unsigned long Count = strtoul(Arguments, nullptr, 16);
+   Thread.Step(Count ? Count : 1).wait();
+   PrintRegisters(Thread);
+   break;
+  }
+  case 'w': {
+   char* End;
+   Word Address = strtoul(Arguments, &End, 16);
+   std::vector<Byte> Data;
+   for (char* Next = End;; Next = End) {
+    unsigned long Value = strtoul(Next, &End, 16);
+    if (End == Next) break;
+    Data.push_back(Value);
+   }
+   Thread.Poke(Address, Data.data(), Data.size());
+   break;
+  }
+  case 'i':
+   Thread.SetIRQ(strtoul(Arguments, nullptr, 16) != 0);
+   break;
+  case 'n':
+   Thread.NMI();
+   break;
+  case 'r':
+   PrintRegisters(Thread);
+   break;
+  case 'd': {
+   char DumpPath[256];
+   if (sscanf(Arguments, "%255s", DumpPath) != 1) {
+    printf("d needs a file\n");
+    break;
+   }
+   MachineSnapshot Snapshot;
+   Thread.Snapshot(Snapshot).wait();
+   FILE* Dump = fopen(DumpPath, "wb");
+   if (!Dump) {
+    perror(DumpPath);
+    break;
+   }
+   fwrite(Snapshot.Memory.data(), 1, Snapshot.Memory.size(), Dump);
+   fclose(Dump);
+   break;
+  }
+  case 'h':
+   WaitWhileRunning(Thread);
+   break;
+  case 'q':
+   Quit = true;
+   break;
+  case '\n':
+  case '#':
+   break;
+  default:
+   printf("Unknown monitor command: %s", Line);
+  }
+  fflush(stdout);
+ }
+ if (!Quit) WaitWhileRunning(Thread);
+ Thread.Stop();
+
+ if (Input != stdin) fclose(Input);
+ return true;
+}
@@ -0,0 +1,26 @@
+#ifndef _MONITOR_H_
+#define _MONITOR_H_
+
+#include <string>
+
+#include <cstdint>
+
+#include "machine.h"
+
+// Runs M for Budget cycles on an EmulationThread and feeds it commands read
+// line by line from Path ("-" for stdin) while it runs. Numbers are hex:
+//   p               pause
+//   c               continue, also after a watchpoint or illegal opcode
+//   s [n]           step n instructions (1), then print the registers
+//   w <addr> <b..>  write bytes to memory
+//   i <0|1>         IRQ level
+//   n               NMI
+//   r               print the registers and the thread state
+//   d <file>        write a snapshot of the 64K to file
+//   h               wait until the machine stops running
+//   q               quit at once
+// At the end of the input it waits like h. Returns false when Path cannot
+// be opened
+bool RunMonitor(Machine& M, uint64_t Budget, const std::string& Path);
+
+#endif
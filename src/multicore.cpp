@@ -0,0 +1,127 @@
+#include "multicore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+Byte SharedWindow::Read(Word Address) {
+ System.Sync(Core);
+ return System.Shared[Address];
+}
+
+void SharedWindow::Write(Word Address, Byte Value) {
+ System.Sync(Core);
+ System.Shared[Address] = Value;
+}
+
+const Byte* SharedWindow::Peek(Word Address) const { return &System.Shared[Address]; }
+
+MultiMachine::MultiMachine() { memset(Shared, 0, sizeof(Shared)); }
+
+Machine& MultiMachine::AddCore() {
+ Cores.emplace_back(new Machine());
+ for (const std::pair<Word, Word>& Range : SharedRanges) Attach(Cores.size() - 1, Range.first, Range.second);
+ return *Cores.back();
+}
+
+void MultiMachine::Attach(size_t Core, Word Begin, Word End) {
+ Windows.emplace_back(new SharedWindow(*this, Core, Begin, End));
+ Cores[Core]->Mem.AttachDevice(Windows.back().get());
+}
+
+void MultiMachine::Share(Word Begin, Word End) {
+ Begin &= 0xFF00;
+ End |= 0x00FF;
+ if (!Cores.empty()) memcpy(Shared + Begin, Cores[0]->Mem.Data + Begin, End - Begin + 1);
+ for (size_t Page = Begin >> 8; Page <= (size_t)(End >> 8); Page++) SharedPage[Page] = true;
+
+ SharedRanges.emplace_back(Begin, End);
+ for (size_t Core = 0; Core < Cores.size(); Core++) Attach(Core, Begin, End);
+}
+
+bool MultiMachine::Halted(size_t Core) const {
+ const Machine& M = *Cores[Core];
+ return M.Mem.Break || M.Cpu.StopReason != STOP_NONE;
+}
+
+void MultiMachine::Sync(size_t Core) {
+ if (Mode != MULTI_PARALLEL) return;
+
+ // Nothing this core does from here on comes before its current instruction
+ uint64_t Start = Cores[Core]->Cpu.InstructionStart;
+ Clocks[Core].Clock.store(Start, std::memory_order_release);
+
+ for (size_t Other = 0; Other < Cores.size(); Other++) {
+  if (Other == Core) continue;
+  for (;;) {
+   uint64_t Clock = Clocks[Other].Clock.load(std::memory_order_acquire);
+   if (Clock > Start || (Clock == Start && Other > Core)) break;
+   std::this_thread::yield();
+  }
+ }
+}
+
+void MultiMachine::RunCore(size_t Core, uint64_t End) {
+ Machine& M = *Cores[Core];
+ while (M.Cpu.TotalCycles < End && !Halted(Core)) {
+  M.Run(std::min(Quantum, End - M.Cpu.TotalCycles));
+  Clocks[Core].Clock.store(M.Cpu.TotalCycles, std::memory_order_release);
+ }
+ // A halted core never gets in anybody's way again
+ if (Halted(Core)) Clocks[Core].Clock.store(NO_DEADLINE, std::memory_order_release);
+}
+
+void MultiMachine::RunParallel(uint64_t End) {
+ std::vector<std::thread> Workers;
+ for (size_t Core = 1; Core < Cores.size(); Core++) Workers.emplace_back(&MultiMachine::RunCore, this, Core, End);
+ RunCore(0, End);
+ for (std::thread& Worker : Workers) Worker.join();
+}
+
+void MultiMachine::RunSerial(uint64_t End) {
+ for (;;) {
+  Machine* Next = nullptr;
+  for (size_t Core = 0; Core < Cores.size(); Core++) {
+   Machine& M = *Cores[Core];
+   if (Halted(Core) || M.Cpu.TotalCycles >= End) continue;
+   if (!Next || M.Cpu.TotalCycles < Next->Cpu.TotalCycles) Next = &M;
+  }
+  if (!Next) return;
+  Next->Run(1);
+ }
+}
+
+uint64_t MultiMachine::Run(uint64_t Budget) {
+ uint64_t Start = Now;
+ uint64_t End   = Now + Budget;
+
+ // Cores may have been added since the last run
+ if (ClockCount != Cores.size()) {
+  Clocks.reset(new CoreClock[Cores.size()]);
+  ClockCount = Cores.size();
+ }
+ for (size_t Core = 0; Core < Cores.size(); Core++) Clocks[Core].Clock.store(Halted(Core) ? NO_DEADLINE : Cores[Core]->Cpu.TotalCycles, std::memory_order_relaxed);
+
+ while (Now < End) {
+  uint64_t Barrier = std::min(Sched.NextDeadline(), End);
+  if (Barrier > Now) {
+   if (Mode == MULTI_PARALLEL)
+    RunParallel(Barrier);
+   else
+    RunSerial(Barrier);
+   Now = Barrier;
+  }
+  Sched.RunDue(Now);
+
+  bool Running = false;
+  for (size_t Core = 0; Core < Cores.size(); Core++) Running |= !Halted(Core);
+  if (!Running) break;
+ }
+ return Now - Start;
+}
+
+int ParseMultiMode(const std::string& Name) {
+ if (Name == "parallel") return MULTI_PARALLEL;
+ if (Name == "serial") return MULTI_SERIAL;
+ return -1;
+}
@@ -0,0 +1,104 @@
+#ifndef _MULTICORE_H_
+#define _MULTICORE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+#include "device.h"
+#include "machine.h"
+#include "scheduler.h"
+
+constexpr uint64_t MULTI_QUANTUM_CYCLES = 1000;  // Longest a core runs without telling the others where it is
+
+enum {
+ MULTI_PARALLEL = 0,  // A host thread per core, synchronised on shared accesses
+ MULTI_SERIAL   = 1,  // The reference interleaving on one thread
+};
+
+struct MultiMachine;
+
+// The shared pages as one core sees them. Attached to every core's Memory,
+// so its own RAM and devices stay on the plain paths and only shared
+// accesses reach the system, which holds the core until it is its turn
+struct SharedWindow : MemoryDevice {
+ MultiMachine& System;
+ size_t Core;
+
+ SharedWindow(MultiMachine& system, size_t core, Word begin, Word end) : MemoryDevice(begin, end), System(system), Core(core) {}
+
+ Byte Read(Word Address) override;
+ void Write(Word Address, Byte Value) override;
+ // The core's own Data is stale on shared pages. A peek does not wait for
+ // its turn, so it may already show a write another core made ahead of it
+ const Byte* Peek(Word Address) const override;
+};
+
+// Where a core is, on a cache line of its own. The core will not touch a
+// shared page in any instruction that starts before Clock
+struct CoreClock {
+ alignas(64) std::atomic<uint64_t> Clock{0};
+};
+
+// Several cores, each a Machine with its own RAM, devices and scheduler,
+// plus pages all of them share.
+//
+// The result is defined by the serial interleaving: the core that is
+// furthest behind (lowest TotalCycles, then lowest index) executes the next
+// instruction. Only the order of shared accesses can tell interleavings
+// apart, so in parallel mode each core runs freely on its own thread and a
+// shared access waits until every other core has published a Clock past
+// (instruction start, core index). Cores publish at every shared access and
+// at least every Quantum cycles, so a waiting core lags at most that much.
+//
+// Events on the system scheduler (Sched, absolute cycles) are barriers: all
+// cores stop at their first instruction boundary past the deadline, the
+// event runs alone and may touch any core, then they go on. A core's own
+// device events are local and need no synchronisation. Devices must not be
+// mapped over shared pages, and a core only sees another through shared RAM
+// or a system event
+struct MultiMachine {
+ std::vector<std::unique_ptr<Machine>> Cores;
+ std::vector<std::unique_ptr<SharedWindow>> Windows;
+ std::vector<std::pair<Word, Word>> SharedRanges;  // Every Share(), for cores added later
+ std::unique_ptr<CoreClock[]> Clocks;
+ size_t ClockCount = 0;
+
+ Byte Shared[MAX_MEM];  // Backing store, only the shared pages are used
+ bool SharedPage[PAGE_COUNT] = {};
+
+ Scheduler Sched;  // System events
+ uint64_t Now     = 0;
+ uint64_t Quantum = MULTI_QUANTUM_CYCLES;
+ int Mode         = MULTI_PARALLEL;
+
+ MultiMachine();
+
+ Machine& AddCore();
+ // Shares Begin-End, widened to whole pages, between all cores, including
+ // ones added later. The pages start out with what core 0 has there
+ void Share(Word Begin, Word End);
+ void Attach(size_t Core, Word Begin, Word End);
+
+ // Runs every core up to Now + Budget, stops early once all have halted
+ // (watchpoint hit or StopReason). Returns the system cycles run
+ uint64_t Run(uint64_t Budget);
+
+ bool Halted(size_t Core) const;
+ // Called by the windows, waits until Core's current instruction is next
+ void Sync(size_t Core);
+
+ void RunParallel(uint64_t End);
+ void RunSerial(uint64_t End);
+ void RunCore(size_t Core, uint64_t End);
+};
+
+int ParseMultiMode(const std::string& Name);
+
+#endif
@@ -0,0 +1,993 @@
+// Instruction bodies of the 6502, expanded by whoever defines OPCODE(Op, Body):
+// the reference switch in CPU_6502::Execute and the handlers behind the
+// dispatch tables. Bodies run as members of CPU_6502 with the opcode already
+// fetched and the bus in `memory`. Every variant shares these, `Chip` is the
+// CPU_* variant as a constant, so differences are `if constexpr` and cost
+// nothing at run time. Indexed addressing, read-modify-write and branches go
+// through the <Chip> helpers of CPU_6502, which add the dummy bus accesses in
+// the CPU_BUS_EXACT tables. Those count accesses and ignore EatCycles, so a
+// cycle without an access of its own needs both EatCycles and a DummyRead. No
+// include guard, this is meant to be included more than once
+
+// Cycles: 1
+OPCODE(INS_ADC_IM, {
+ Byte Value = FetchByte(memory);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 2
+OPCODE(INS_ADC_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3
+OPCODE(INS_ADC_ZPX, {
+ Word Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3
+OPCODE(INS_ADC_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3 (+1 on crossing page)
+OPCODE(INS_ADC_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_ADC_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 5
+OPCODE(INS_ADC_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 4 (+1 if crossing page)
+OPCODE(INS_ADC_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_AND_IM, {
+ Byte Operand = FetchByte(memory);
+ AND(Operand);
+})
+
+// Cycles: 2
+OPCODE(INS_AND_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 3
+OPCODE(INS_AND_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 3
+OPCODE(INS_AND_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_AND_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_AND_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 5
+OPCODE(INS_AND_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 4 (+1 if crossing page)
+OPCODE(INS_AND_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 1
+OPCODE(INS_ASL_A, {
+ DummyRead<Chip>(memory, PC);
+ A = ASL(A);
+})
+
+// Cycles: 4
+OPCODE(INS_ASL_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ASL(Value); });
+})
+
+// Cycles: 5 (+1 if crossed page)
+OPCODE(INS_ASL_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ASL(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_ASL_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ASL(Value); });
+})
+
+// Cycles: 5 (+1 if crossed page)
+OPCODE(INS_ASL_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ASL(Value); });
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BCC_REL, {
+ Branch<Chip>(memory, PS.C, false);
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BCS_REL, {
+ Branch<Chip>(memory, PS.C, true);
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BEQ_REL, {
+ Branch<Chip>(memory, PS.Z, true);
+})
+
+// Cycles: 2
+OPCODE(INS_BIT_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ BIT(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_BIT_AB, {
+ Word Address = FetchABAddress(memory);
+ BIT(memory, Address);
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BMI_REL, {
+ Branch<Chip>(memory, PS.N, true);
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BNE_REL, {
+ Branch<Chip>(memory, PS.Z, false);
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BPL_REL, {
+ Branch<Chip>(memory, PS.N, false);
+})
+
+// Cycles: 6
+OPCODE(INS_BRK_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ BRK(memory);
+ if constexpr (IsCMOS(Chip)) PS.D = 0;
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BVC_REL, {
+ Branch<Chip>(memory, PS.V, false);
+})
+
+// Cycles: 1 (+1 if succeed, + 2 if crossed page)
+OPCODE(INS_BVS_REL, {
+ Branch<Chip>(memory, PS.V, true);
+})
+
+// Cycles: 1
+OPCODE(INS_CLC_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ CLC();
+})
+
+// Cycles: 1
+OPCODE(INS_CLD_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ CLD();
+})
+
+// Cycles: 1
+OPCODE(INS_CLI_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ CLI();
+})
+
+// Cycles: 1
+OPCODE(INS_CLV_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ CLV();
+})
+
+// Cycles: 1
+OPCODE(INS_CMP_IM, {
+ Byte Value = FetchByte(memory);
+ CMP(Value);
+})
+
+// Cycles: 2
+OPCODE(INS_CMP_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_CMP_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_CMP_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 3 (+1 on crossing page)
+OPCODE(INS_CMP_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 3 (+1 on crossing page)
+OPCODE(INS_CMP_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 5
+OPCODE(INS_CMP_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 4 (+1 on crossing page)
+OPCODE(INS_CMP_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_CPX_IM, {
+ Byte Value = FetchByte(memory);
+ CPX(Value);
+})
+
+// Cycles: 2
+OPCODE(INS_CPX_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CPX(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_CPX_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CPX(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_CPY_IM, {
+ Byte Value = FetchByte(memory);
+ CPY(Value);
+})
+
+// Cycles: 2
+OPCODE(INS_CPY_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CPY(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_CPY_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CPY(Value);
+})
+
+// Cycles: 4
+OPCODE(INS_DEC_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DEC(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_DEC_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DEC(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_DEC_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DEC(Value); });
+})
+
+// Cycles: 6
+OPCODE(INS_DEC_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DEC(Value); });
+})
+
+// Cycles: 1
+OPCODE(INS_DEX_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DEX();
+})
+
+// Cycles: 1
+OPCODE(INS_DEY_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DEY();
+})
+
+// Cycles: 1
+OPCODE(INS_EOR_IM, {
+ Byte Operand = FetchByte(memory);
+ EOR(Operand);
+})
+
+// Cycles: 2
+OPCODE(INS_EOR_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_EOR_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_EOR_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_EOR_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_EOR_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 5
+OPCODE(INS_EOR_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 4 (+1 if crossed page)
+OPCODE(INS_EOR_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 4
+OPCODE(INS_INC_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return INC(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_INC_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return INC(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_INC_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return INC(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_INC_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return INC(Value); });
+})
+
+// Cycles: 1
+OPCODE(INS_INX_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ INX();
+})
+
+// Cycles: 1
+OPCODE(INS_INY_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ INY();
+})
+
+// Cycles: 2
+OPCODE(INS_JMP_AB, {
+ Word Address = FetchABAddress(memory);
+ JMP(Address);
+})
+
+// Cycles: 4 (5 on CMOS). The NMOS does not carry into the high byte of the
+// pointer, JMP ($xxFF) takes the high byte from $xx00. The CMOS fixes that
+// and reads the operand's high byte again before the pointer
+OPCODE(INS_JMP_IN, {
+ Word Address = FetchABAddress(memory);
+ Word EffectiveAddress;
+ if constexpr (IsCMOS(Chip)) {
+  DummyRead<Chip>(memory, PC - 1);
+  EatCycles(1);
+  EffectiveAddress = ReadWord(memory, Address);
+ } else {
+  Byte Low         = ReadByte(memory, Address);
+  Byte High        = ReadByte(memory, (Address & 0xFF00) | (Byte)(Address + 1));
+  EffectiveAddress = (Word)(High << 8) | Low;
+ }
+ JMP(EffectiveAddress);
+})
+
+// Cycles: 5
+OPCODE(INS_JSR_AB, {
+ Byte Low = FetchByte(memory);
+ DummyRead<Chip>(memory, 0x100 + SP);
+ JSR(memory, Low);
+})
+
+// Cycles: 1
+OPCODE(INS_LDA_IM, {
+ Byte Value = FetchByte(memory);
+ LDA(Value);
+})
+
+// Cycles: 2
+OPCODE(INS_LDA_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDA_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDA_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDA_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDA_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 5
+OPCODE(INS_LDA_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 4 (+1 if crossed page)
+OPCODE(INS_LDA_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_LDX_IM, {
+ Byte Value = FetchByte(memory);
+ LDX(Value);
+})
+
+// Cycles: 2
+OPCODE(INS_LDX_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDX(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDX_ZPY, {
+ Byte Address = FetchZPIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ LDX(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDX_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDX(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDX_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ LDX(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_LDY_IM, {
+ Byte Value = FetchByte(memory);
+ LDY(Value);
+})
+
+// Cycles: 2
+OPCODE(INS_LDY_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDY(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDY_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ LDY(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDY_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDY(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LDY_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ LDY(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_LSR_A, {
+ DummyRead<Chip>(memory, PC);
+ A = LSR(A);
+})
+
+// Cycles: 4
+OPCODE(INS_LSR_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return LSR(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_LSR_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return LSR(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_LSR_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return LSR(Value); });
+})
+
+// Cycles: 6
+OPCODE(INS_LSR_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return LSR(Value); });
+})
+
+OPCODE(INS_NOP_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ NOP();
+})
+
+// Cycles: 1
+OPCODE(INS_ORA_IM, {
+ Byte Value = FetchByte(memory);
+ ORA(Value);
+})
+
+// Cycles: 2
+OPCODE(INS_ORA_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_ORA_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_ORA_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_ORA_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_ORA_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 5
+OPCODE(INS_ORA_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 4 (+1 if crossed page)
+OPCODE(INS_ORA_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_PHA_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ PHA(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_PHP_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ PHP(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_PLA_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, 0x100 + SP);
+ PLA(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_PLP_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, 0x100 + SP);
+ PLP(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_ROL_A, {
+ DummyRead<Chip>(memory, PC);
+ A = ROL(A);
+})
+
+// Cycles: 4
+OPCODE(INS_ROL_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROL(Value); });
+})
+// Cycles: 5
+OPCODE(INS_ROL_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROL(Value); });
+})
+// Cycles: 5
+OPCODE(INS_ROL_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROL(Value); });
+})
+
+// Cycles: 6
+OPCODE(INS_ROL_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROL(Value); });
+})
+
+// Cycles: 1
+OPCODE(INS_ROR_A, {
+ DummyRead<Chip>(memory, PC);
+ A = ROR(A);
+})
+
+// Cycles: 4
+OPCODE(INS_ROR_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROR(Value); });
+})
+// Cycles: 5
+OPCODE(INS_ROR_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROR(Value); });
+})
+// Cycles: 5
+OPCODE(INS_ROR_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROR(Value); });
+})
+
+// Cycles: 6
+OPCODE(INS_ROR_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ROR(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_RTI_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, 0x100 + SP);
+ RTI(memory);
+})
+
+// Cycles: 5
+OPCODE(INS_RTS_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, 0x100 + SP);
+ RTS(memory);
+ DummyRead<Chip>(memory, PC - 1);
+})
+
+// Cycles: 1
+OPCODE(INS_SBC_IM, {
+ Byte Value = FetchByte(memory);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 2
+OPCODE(INS_SBC_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3
+OPCODE(INS_SBC_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3
+OPCODE(INS_SBC_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3 (+1 on crossing page)
+OPCODE(INS_SBC_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_SBC_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 5
+OPCODE(INS_SBC_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 4 (+1 if crossing page)
+OPCODE(INS_SBC_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_SED_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ SED();
+})
+
+// Cycles: 1
+OPCODE(INS_SEC_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ SEC();
+})
+
+// Cycles: 1
+OPCODE(INS_SEI_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ SEI();
+})
+
+// Cycles: 2
+OPCODE(INS_STA_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ STA(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STA_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ STA(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STA_AB, {
+ Word Address = FetchABAddress(memory);
+ STA(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossed page)
+OPCODE(INS_STA_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ STA(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossed page)
+OPCODE(INS_STA_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y, true);
+ STA(memory, Address);
+})
+
+// Cycles: 5
+OPCODE(INS_STA_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ WriteByte(memory, Address, A);
+})
+
+// Cycles: 4 (+1 if crossed page)
+OPCODE(INS_STA_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory, true);
+ WriteByte(memory, Address, A);
+})
+
+// Cycles: 2
+OPCODE(INS_STX_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ STX(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STX_ZPY, {
+ Byte Address = FetchZPIndexed<Chip>(memory, Y);
+ STX(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STX_AB, {
+ Word Address = FetchABAddress(memory);
+ STX(memory, Address);
+})
+
+// Cycles: 2
+OPCODE(INS_STY_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ STY(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STY_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ STY(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STY_AB, {
+ Word Address = FetchABAddress(memory);
+ STY(memory, Address);
+})
+
+OPCODE(INS_TYA_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ TYA();
+})
+
+OPCODE(INS_TAY_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ TAY();
+})
+
+OPCODE(INS_TXA_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ TXA();
+})
+
+OPCODE(INS_TAX_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ TAX();
+})
+
+OPCODE(INS_TSX_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ TSX();
+})
+
+OPCODE(INS_TXS_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ TXS();
+})
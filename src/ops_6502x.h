@@ -0,0 +1,521 @@
+// Undocumented NMOS opcodes, the CPU_NMOS_ILLEGAL table adds these to
+// ops_6502.h: the NOPs of all lengths and the stable combined operations.
+// Same OPCODE(Op, Body) convention. No include guard
+
+// Cycles: 1
+OPCODE(INS_NOP_IMPL_1A, {
+ DummyRead<Chip>(memory, PC);
+ NOP();
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IMPL_3A, {
+ DummyRead<Chip>(memory, PC);
+ NOP();
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IMPL_5A, {
+ DummyRead<Chip>(memory, PC);
+ NOP();
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IMPL_7A, {
+ DummyRead<Chip>(memory, PC);
+ NOP();
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IMPL_DA, {
+ DummyRead<Chip>(memory, PC);
+ NOP();
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IMPL_FA, {
+ DummyRead<Chip>(memory, PC);
+ NOP();
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IM_80, {
+ FetchByte(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IM_82, {
+ FetchByte(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IM_89, {
+ FetchByte(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IM_C2, {
+ FetchByte(memory);
+})
+
+// Cycles: 1
+OPCODE(INS_NOP_IM_E2, {
+ FetchByte(memory);
+})
+
+// Cycles: 2
+OPCODE(INS_NOP_ZP_04, {
+ Byte Address = FetchZPAddress(memory);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 2
+OPCODE(INS_NOP_ZP_44, {
+ Byte Address = FetchZPAddress(memory);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 2
+OPCODE(INS_NOP_ZP_64, {
+ Byte Address = FetchZPAddress(memory);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_NOP_ZPX_14, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_NOP_ZPX_34, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_NOP_ZPX_54, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_NOP_ZPX_74, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_NOP_ZPX_D4, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_NOP_ZPX_F4, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_NOP_AB_0C, {
+ Word Address = FetchABAddress(memory);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_NOP_ABX_1C, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_NOP_ABX_3C, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_NOP_ABX_5C, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_NOP_ABX_7C, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_NOP_ABX_DC, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossing page)
+OPCODE(INS_NOP_ABX_FC, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ ReadByte(memory, Address);
+})
+
+// Cycles: 4
+OPCODE(INS_SLO_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SLO(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_SLO_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SLO(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_SLO_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SLO(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_SLO_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SLO(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_SLO_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SLO(Value); });
+})
+
+// Cycles: 7
+OPCODE(INS_SLO_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SLO(Value); });
+})
+
+// Cycles: 7 (+1 if crossed page)
+OPCODE(INS_SLO_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SLO(Value); });
+})
+
+// Cycles: 4
+OPCODE(INS_RLA_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RLA(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_RLA_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RLA(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_RLA_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RLA(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_RLA_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RLA(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_RLA_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RLA(Value); });
+})
+
+// Cycles: 7
+OPCODE(INS_RLA_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RLA(Value); });
+})
+
+// Cycles: 7 (+1 if crossed page)
+OPCODE(INS_RLA_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RLA(Value); });
+})
+
+// Cycles: 4
+OPCODE(INS_SRE_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SRE(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_SRE_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SRE(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_SRE_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SRE(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_SRE_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SRE(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_SRE_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SRE(Value); });
+})
+
+// Cycles: 7
+OPCODE(INS_SRE_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SRE(Value); });
+})
+
+// Cycles: 7 (+1 if crossed page)
+OPCODE(INS_SRE_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return SRE(Value); });
+})
+
+// Cycles: 4
+OPCODE(INS_RRA_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RRA(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_RRA_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RRA(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_RRA_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RRA(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_RRA_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RRA(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_RRA_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RRA(Value); });
+})
+
+// Cycles: 7
+OPCODE(INS_RRA_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RRA(Value); });
+})
+
+// Cycles: 7 (+1 if crossed page)
+OPCODE(INS_RRA_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return RRA(Value); });
+})
+
+// Cycles: 4
+OPCODE(INS_DCP_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DCP(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_DCP_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DCP(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_DCP_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DCP(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_DCP_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DCP(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_DCP_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DCP(Value); });
+})
+
+// Cycles: 7
+OPCODE(INS_DCP_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DCP(Value); });
+})
+
+// Cycles: 7 (+1 if crossed page)
+OPCODE(INS_DCP_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return DCP(Value); });
+})
+
+// Cycles: 4
+OPCODE(INS_ISC_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ISC(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_ISC_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ISC(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_ISC_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ISC(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_ISC_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ISC(Value); });
+})
+
+// Cycles: 6 (+1 if crossed page)
+OPCODE(INS_ISC_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ISC(Value); });
+})
+
+// Cycles: 7
+OPCODE(INS_ISC_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ISC(Value); });
+})
+
+// Cycles: 7 (+1 if crossed page)
+OPCODE(INS_ISC_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory, true);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return ISC(Value); });
+})
+
+// Cycles: 2
+OPCODE(INS_SAX_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ SAX(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_SAX_ZPY, {
+ Byte Address = FetchZPIndexed<Chip>(memory, Y);
+ SAX(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_SAX_AB, {
+ Word Address = FetchABAddress(memory);
+ SAX(memory, Address);
+})
+
+// Cycles: 5
+OPCODE(INS_SAX_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ SAX(memory, Address);
+})
+
+// Cycles: 2
+OPCODE(INS_LAX_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LAX(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LAX_ZPY, {
+ Byte Address = FetchZPIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ LAX(Value);
+})
+
+// Cycles: 3
+OPCODE(INS_LAX_AB, {
+ Word Address = FetchABAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LAX(Value);
+})
+
+// Cycles: 3 (+1 if crossed page)
+OPCODE(INS_LAX_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ LAX(Value);
+})
+
+// Cycles: 5
+OPCODE(INS_LAX_INX, {
+ Word Address = FetchINIndexedX<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LAX(Value);
+})
+
+// Cycles: 4 (+1 if crossed page)
+OPCODE(INS_LAX_INY, {
+ Word Address = FetchINIndexedY<Chip>(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LAX(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_ANC_IM, {
+ Byte Value = FetchByte(memory);
+ ANC(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_ANC_IM_2B, {
+ Byte Value = FetchByte(memory);
+ ANC(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_ALR_IM, {
+ Byte Value = FetchByte(memory);
+ ALR(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_ARR_IM, {
+ Byte Value = FetchByte(memory);
+ ARR(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_SBX_IM, {
+ Byte Value = FetchByte(memory);
+ SBX(Value);
+})
+
+// Cycles: 1
+OPCODE(INS_SBC_IM_EB, {
+ Byte Value = FetchByte(memory);
+ SBC(Value);
+})
+
+// Cycles: 3 (+1 if crossed page)
+OPCODE(INS_LAS_ABY, {
+ Word Address = FetchABIndexed<Chip>(memory, Y);
+ Byte Value   = ReadByte(memory, Address);
+ LAS(Value);
+})
@@ -0,0 +1,183 @@
+// Instructions and addressing modes the 65C02 adds to ops_6502.h, in the
+// tables of CPU_65C02 and up. The opcodes left over are NOPs of fixed length
+// set up by the table itself. Same OPCODE(Op, Body) convention. No include
+// guard
+
+// Cycles: 2 (+1 if crossed page)
+OPCODE(INS_BRA_REL, {
+ Branch<Chip>(memory, true, true);
+})
+
+// Cycles: 2
+OPCODE(INS_PHX_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ PHX(memory);
+})
+
+// Cycles: 2
+OPCODE(INS_PHY_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ PHY(memory);
+})
+
+// Cycles: 3
+OPCODE(INS_PLX_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, 0x100 + SP);
+ PLX(memory);
+})
+
+// Cycles: 3
+OPCODE(INS_PLY_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, 0x100 + SP);
+ PLY(memory);
+})
+
+// Cycles: 2
+OPCODE(INS_STZ_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ STZ(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STZ_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ STZ(memory, Address);
+})
+
+// Cycles: 3
+OPCODE(INS_STZ_AB, {
+ Word Address = FetchABAddress(memory);
+ STZ(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossed page)
+OPCODE(INS_STZ_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X, true);
+ STZ(memory, Address);
+})
+
+// Cycles: 4
+OPCODE(INS_TSB_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return TSB(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_TSB_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return TSB(Value); });
+})
+
+// Cycles: 4
+OPCODE(INS_TRB_ZP, {
+ Byte Address = FetchZPAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return TRB(Value); });
+})
+
+// Cycles: 5
+OPCODE(INS_TRB_AB, {
+ Word Address = FetchABAddress(memory);
+ Modify<Chip>(memory, Address, [this](Byte Value) { return TRB(Value); });
+})
+
+// Cycles: 1
+OPCODE(INS_INC_A, {
+ DummyRead<Chip>(memory, PC);
+ EatCycles(1);
+ A++;
+ SetZeroNegativeFlags(A);
+})
+
+// Cycles: 1
+OPCODE(INS_DEC_A, {
+ DummyRead<Chip>(memory, PC);
+ EatCycles(1);
+ A--;
+ SetZeroNegativeFlags(A);
+})
+
+// Cycles: 1, only Z is changed
+OPCODE(INS_BIT_IM, {
+ Byte Value = FetchByte(memory);
+ PS.Z       = (A & Value) == 0;
+})
+
+// Cycles: 3
+OPCODE(INS_BIT_ZPX, {
+ Byte Address = FetchZPIndexed<Chip>(memory, X);
+ BIT(memory, Address);
+})
+
+// Cycles: 3 (+1 if crossed page)
+OPCODE(INS_BIT_ABX, {
+ Word Address = FetchABIndexed<Chip>(memory, X);
+ BIT(memory, Address);
+})
+
+// Cycles: 4
+OPCODE(INS_ORA_INZ, {
+ Word Address = FetchINAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ORA(Value);
+})
+
+// Cycles: 4
+OPCODE(INS_AND_INZ, {
+ Word Address = FetchINAddress(memory);
+ Byte Operand = ReadByte(memory, Address);
+ AND(Operand);
+})
+
+// Cycles: 4
+OPCODE(INS_EOR_INZ, {
+ Word Address = FetchINAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ EOR(Value);
+})
+
+// Cycles: 4
+OPCODE(INS_ADC_INZ, {
+ Word Address = FetchINAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ ADC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 4
+OPCODE(INS_STA_INZ, {
+ Word Address = FetchINAddress(memory);
+ WriteByte(memory, Address, A);
+})
+
+// Cycles: 4
+OPCODE(INS_LDA_INZ, {
+ Word Address = FetchINAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ LDA(Value);
+})
+
+// Cycles: 4
+OPCODE(INS_CMP_INZ, {
+ Word Address = FetchINAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ CMP(Value);
+})
+
+// Cycles: 4
+OPCODE(INS_SBC_INZ, {
+ Word Address = FetchINAddress(memory);
+ Byte Value   = ReadByte(memory, Address);
+ SBC(Value, IsCMOS(Chip));
+ DecimalCycle<Chip>(memory);
+})
+
+// Cycles: 5
+OPCODE(INS_JMP_INX, {
+ Word Address = FetchWord(memory) + X;
+ DummyRead<Chip>(memory, PC - 1);
+ EatCycles(1);
+ Word EffectiveAddress = ReadWord(memory, Address);
+ JMP(EffectiveAddress);
+})
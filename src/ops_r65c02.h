@@ -0,0 +1,31 @@
+// Rockwell bit instructions, in the tables of CPU_R65C02 and CPU_W65C02.
+// Each comes in eight copies, one per bit, so BIT_OPCODES stamps them out.
+// Same OPCODE(Op, Body) convention. No include guard
+
+// RMB, SMB cycles: 4. BBR, BBS cycles: 4 (+1 if succeed, + 2 if crossed page)
+#define BIT_OPCODES(Bit)                                                         \
+ OPCODE(INS_RMB##Bit##_ZP, {                                                     \
+  Byte Address = FetchZPAddress(memory);                                         \
+  Modify<Chip>(memory, Address, [this](Byte Value) { return RMB(Value, Bit); }); \
+ })                                                                              \
+ OPCODE(INS_SMB##Bit##_ZP, {                                                     \
+  Byte Address = FetchZPAddress(memory);                                         \
+  Modify<Chip>(memory, Address, [this](Byte Value) { return SMB(Value, Bit); }); \
+ })                                                                              \
+ OPCODE(INS_BBR##Bit##_ZPR, {                                                    \
+  Branch<Chip>(memory, TestBit(memory, Bit), false);                             \
+ })                                                                              \
+ OPCODE(INS_BBS##Bit##_ZPR, {                                                    \
+  Branch<Chip>(memory, TestBit(memory, Bit), true);                              \
+ })
+
+BIT_OPCODES(0)
+BIT_OPCODES(1)
+BIT_OPCODES(2)
+BIT_OPCODES(3)
+BIT_OPCODES(4)
+BIT_OPCODES(5)
+BIT_OPCODES(6)
+BIT_OPCODES(7)
+
+#undef BIT_OPCODES
@@ -0,0 +1,16 @@
+// WAI and STP of the WDC 65C02, in the CPU_W65C02 table on top of the
+// Rockwell set. Same OPCODE(Op, Body) convention. No include guard
+
+// Cycles: 2, then asleep until an interrupt
+OPCODE(INS_WAI_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, PC);
+ WAI();
+})
+
+// Cycles: all of them, until reset
+OPCODE(INS_STP_IMPL, {
+ DummyRead<Chip>(memory, PC);
+ DummyRead<Chip>(memory, PC);
+ STP();
+})
@@ -20,6 +20,87 @@ void parseArgs(char** argv) {
   case 'f':
    binPath = Value;
    break;
+  case 'w':
+   watchSpecs.push_back(Value);
+   break;
+  case 'm':
+   shmName = Value;
+   break;
+  case 'o':
+   consoleAddress = std::stoi((std::string)Value, nullptr, 16);
+   break;
+  case 'O':
+   consolePath = Value;
+   break;
+  case 'v':
+   viaAddress = std::stoi((std::string)Value, nullptr, 16);
+   break;
+  case 'F':
+   framebufferAddress = std::stoi((std::string)Value, nullptr, 16);
+   break;
+  case 'd':
+   dumpCycles.push_back(std::stoull((std::string)Value, nullptr, 16));
+   break;
+  case 'b':
+   blockAddress = std::stoi((std::string)Value, nullptr, 16);
+   break;
+  case 'B':
+   blockPath = Value;
+   break;
+  case 'k':
+   blockSectorCycles = std::stoull((std::string)Value, nullptr, 16);
+   break;
+  case 't':
+   tracePath = Value;
+   break;
+  case 'T':
+   tracePolicy = Value;
+   break;
+  case 'P':
+   profilePath = Value;
+   break;
+  case 'S':
+   sampleInterval = std::stoull((std::string)Value, nullptr, 16);
+   break;
+  case 'y':
+   symbolPath = Value;
+   break;
+  case 'g':
+   callGraphPath = Value;
+   break;
+  case 'H':
+   heatMapPath = Value;
+   break;
+  case 'G':
+   heatMapBucket = std::stoi((std::string)Value, nullptr, 16);
+   break;
+  case 'E':
+   engineName = Value;
+   break;
+  case 'D':
+   diffCheckpoint = std::stoull((std::string)Value, nullptr, 16);
+   break;
+  case 'C':
+   cpuVariant = Value;
+   break;
+  case 'I':
+   illegalPolicy = Value;
+   break;
+  case 'A':
+   busAccuracy = Value;
+   break;
+  case 'M':
+   monitorPath = Value;
+   break;
+  case 'K':
+   coreSpecs.push_back(Value);
+   break;
+  case 'X':
+   sharedSpecs.push_back(Value);
+   break;
+  case 'R':
+   multiMode = Value;
+   break;
   }
  }
 }
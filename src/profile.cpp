@@ -0,0 +1,105 @@
+#include "profile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "common.h"
+#include "ins_65xx.h"
+
+struct ModeProfile {
+ uint64_t Count;
+ uint64_t Cycles;
+ uint64_t PageCross;
+};
+
+// Executed opcodes, most cycles first
+static std::vector<int> SortedOpcodes(const Profiler& Profile) {
+ std::vector<int> Order;
+ for (int Opcode = 0; Opcode < 256; Opcode++) {
+  if (Profile.Opcodes[Opcode].Count) Order.push_back(Opcode);
+ }
+ std::sort(Order.begin(), Order.end(), [&](int a, int b) { return Profile.Opcodes[a].Cycles > Profile.Opcodes[b].Cycles; });
+ return Order;
+}
+
+static void SumModes(const Profiler& Profile, int Variant, ModeProfile* Modes, uint64_t& Count, uint64_t& Cycles) {
+ Count = Cycles = 0;
+ for (int Opcode = 0; Opcode < 256; Opcode++) {
+  const OpcodeProfile& Entry = Profile.Opcodes[Opcode];
+  ModeProfile& Mode          = Modes[GetInstruction(Opcode, Variant).Mode];
+  Mode.Count += Entry.Count;
+  Mode.Cycles += Entry.Cycles;
+  Mode.PageCross += Entry.PageCross;
+  Count += Entry.Count;
+  Cycles += Entry.Cycles;
+ }
+}
+
+void Profiler::Clear() { *this = Profiler(); }
+
+bool Profiler::Report(const std::string& Path, int Variant) const {
+ FILE* File = Path == "-" ? stdout : fopen(Path.c_str(), "w");
+ if (!File) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ bool Json = Path.size() > 5 && Path.compare(Path.size() - 5, 5, ".json") == 0;
+ if (Json)
+  ReportJSON(File, Variant);
+ else
+  ReportText(File, Variant);
+
+ if (File != stdout) fclose(File);
+ return true;
+}
+
+void Profiler::ReportText(FILE* File, int Variant) const {
+ ModeProfile Modes[MODE_COUNT] = {};
+ uint64_t Count, Cycles;
+ SumModes(*this, Variant, Modes, Count, Cycles);
+
+ fprintf(File, "Instructions: %llu, cycles: %llu, interrupts: %llu (%llu cycles)\n", (unsigned long long)Count, (unsigned long long)Cycles, (unsigned long long)Interrupts, (unsigned long long)InterruptCycles);
+ fprintf(File, "%-6s %-4s %-5s %12s %12s %8s %8s %12s %12s %10s\n", "Opcode", "Ins", "Mode", "Count", "Cycles", "%", "Avg", "Taken", "Not taken", "Page cross");
+ for (int Opcode : SortedOpcodes(*this)) {
+  const InstructionInfo& Info = GetInstruction(Opcode, Variant);
+  const OpcodeProfile& Entry  = Opcodes[Opcode];
+  fprintf(File, "%02x     %-4s %-5s %12llu %12llu %7.2f%% %8.2f", Opcode, Info.Mnemonic, ModeName(Info.Mode), (unsigned long long)Entry.Count, (unsigned long long)Entry.Cycles, 100.0 * Entry.Cycles / Cycles, (double)Entry.Cycles / Entry.Count);
+  if (Info.Mode == MODE_REL || Info.Mode == MODE_ZPR)
+   fprintf(File, " %12llu %12llu", (unsigned long long)Entry.Taken, (unsigned long long)Entry.NotTaken);
+  else
+   fprintf(File, " %12s %12s", "", "");
+  fprintf(File, " %10llu\n", (unsigned long long)Entry.PageCross);
+ }
+
+ fprintf(File, "\n%-5s %12s %12s %8s %10s\n", "Mode", "Count", "Cycles", "%", "Page cross");
+ for (int Mode = 0; Mode < MODE_COUNT; Mode++) {
+  if (!Modes[Mode].Count) continue;
+  fprintf(File, "%-5s %12llu %12llu %7.2f%% %10llu\n", ModeName(Mode), (unsigned long long)Modes[Mode].Count, (unsigned long long)Modes[Mode].Cycles, 100.0 * Modes[Mode].Cycles / Cycles, (unsigned long long)Modes[Mode].PageCross);
+ }
+}
+
+void Profiler::ReportJSON(FILE* File, int Variant) const {
+ ModeProfile Modes[MODE_COUNT] = {};
+ uint64_t Count, Cycles;
+ SumModes(*this, Variant, Modes, Count, Cycles);
+
+ fprintf(File, "{\n \"instructions\": %llu,\n \"cycles\": %llu,\n \"interrupts\": %llu,\n \"interrupt_cycles\": %llu,\n \"opcodes\": [", (unsigned long long)Count, (unsigned long long)Cycles, (unsigned long long)Interrupts, (unsigned long long)InterruptCycles);
+ const char* Separator = "\n";
+ for (int Opcode : SortedOpcodes(*this)) {
+  const InstructionInfo& Info = GetInstruction(Opcode, Variant);
+  const OpcodeProfile& Entry  = Opcodes[Opcode];
+  fprintf(File, "%s  {\"opcode\": %d, \"mnemonic\": \"%s\", \"mode\": \"%s\", \"count\": %llu, \"cycles\": %llu, \"taken\": %llu, \"not_taken\": %llu, \"page_cross\": %llu}", Separator, Opcode, Info.Mnemonic, ModeName(Info.Mode), (unsigned long long)Entry.Count, (unsigned long long)Entry.Cycles, (unsigned long long)Entry.Taken, (unsigned long long)Entry.NotTaken, (unsigned long long)Entry.PageCross);
+  Separator = ",\n";
+ }
+
+ fprintf(File, "\n ],\n \"modes\": [");
+ Separator = "\n";
+ for (int Mode = 0; Mode < MODE_COUNT; Mode++) {
+  if (!Modes[Mode].Count) continue;
+  fprintf(File, "%s  {\"mode\": \"%s\", \"count\": %llu, \"cycles\": %llu, \"page_cross\": %llu}", Separator, ModeName(Mode), (unsigned long long)Modes[Mode].Count, (unsigned long long)Modes[Mode].Cycles, (unsigned long long)Modes[Mode].PageCross);
+  Separator = ",\n";
+ }
+ fprintf(File, "\n ]\n}\n");
+}
@@ -0,0 +1,46 @@
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include <string>
+
+#include <cstdint>
+
+#include "common.h"
+
+// Instrumentation is only compiled in with EMU_PROFILE (make PROFILE=1),
+// otherwise PROFILE() statements vanish and the CPU carries no counters
+#ifdef EMU_PROFILE
+#define PROFILE(...) __VA_ARGS__
+#else
+#define PROFILE(...)
+#endif
+
+struct OpcodeProfile {
+ uint64_t Count;
+ uint64_t Cycles;
+ uint64_t Taken;      // Branches only
+ uint64_t NotTaken;
+ uint64_t PageCross;  // Extra cycles charged for crossing a page
+};
+
+struct Profiler {
+ OpcodeProfile Opcodes[256] = {};
+ Byte Current               = 0;  // Opcode being executed, for the penalty counters
+ uint64_t Interrupts        = 0;
+ uint64_t InterruptCycles   = 0;
+
+ void Retire(uint64_t Cycles) {
+  Opcodes[Current].Count++;
+  Opcodes[Current].Cycles += Cycles;
+ }
+
+ void Clear();
+
+ // Sorted by cycles, as text or as JSON when Path ends in .json; "-" is stdout.
+ // Opcodes are named as the CPU_* Variant knows them
+ bool Report(const std::string& Path, int Variant = 0) const;
+ void ReportText(FILE* File, int Variant) const;
+ void ReportJSON(FILE* File, int Variant) const;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "sampler.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+PCSampler::PCSampler(Scheduler& sched, CPU_65XX& cpu, uint64_t interval) : Sched(sched), Cpu(cpu), Interval(interval ? interval : 1) {
+ SampleEvent = Sched.Register([this](uint64_t) { Sample(); });
+}
+
+void PCSampler::Start() { Sched.ScheduleIn(SampleEvent, Interval); }
+
+void PCSampler::Sample() {
+ Histogram[Cpu.PC]++;
+ Samples++;
+
+ // xorshift32
+ Random ^= Random << 13;
+ Random ^= Random >> 17;
+ Random ^= Random << 5;
+ Sched.ScheduleIn(SampleEvent, Interval / 2 + 1 + Random % Interval);
+}
+
+void PCSampler::Report(FILE* File, const SymbolTable& Symbols, Disassembler& Disasm, const Memory& Mem, size_t TopAddresses) const {
+ if (!Samples) return;
+
+ std::map<std::string, uint64_t> Routines;
+ std::vector<Word> Addresses;
+ for (uint32_t Address = 0; Address < 0x10000; Address++) {
+  if (!Histogram[Address]) continue;
+  const Symbol* Entry = Symbols.Lookup(Address);
+  char Unknown[8];
+  snprintf(Unknown, sizeof(Unknown), "$%02xxx", Address >> 8);
+  Routines[Entry ? Entry->Name : Unknown] += Histogram[Address];
+  Addresses.push_back(Address);
+ }
+
+ std::vector<std::pair<std::string, uint64_t>> Sorted(Routines.begin(), Routines.end());
+ std::sort(Sorted.begin(), Sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+ fprintf(File, "Samples: %llu, one per ~%llu cycles\n", (unsigned long long)Samples, (unsigned long long)Interval);
+ fprintf(File, "%-32s %10s %8s %14s\n", "Routine", "Samples", "%", "~Cycles");
+ for (const auto& Entry : Sorted)
+  fprintf(File, "%-32s %10llu %7.2f%% %14llu\n", Entry.first.c_str(), (unsigned long long)Entry.second, 100.0 * Entry.second / Samples, (unsigned long long)(Entry.second * Interval));
+
+ std::sort(Addresses.begin(), Addresses.end(), [&](Word a, Word b) { return Histogram[a] > Histogram[b]; });
+ if (Addresses.size() > TopAddresses) Addresses.resize(TopAddresses);
+
+ fprintf(File, "\n%-6s %-32s %10s %8s  %s\n", "PC", "Label", "Samples", "%", "Instruction");
+ for (Word Address : Addresses)
+  fprintf(File, "%04x   %-32s %10u %7.2f%%  %s\n", Address, Symbols.Name(Address).c_str(), Histogram[Address], 100.0 * Histogram[Address] / Samples, Disasm.Lookup(Mem, Address).Text);
+}
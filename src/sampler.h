@@ -0,0 +1,37 @@
+#ifndef _SAMPLER_H_
+#define _SAMPLER_H_
+
+#include <cstdint>
+#include <cstdio>
+
+#include "common.h"
+#include "cpu_65xx.h"
+#include "disasm.h"
+#include "scheduler.h"
+#include "symbols.h"
+
+// Statistical PC profiler. A scheduler event looks at the PC about every
+// Interval cycles, so the cost is one event per sample and nothing in between;
+// a large interval keeps it cheap enough to leave on. The distance to the next
+// sample is jittered by +-Interval/2 so loops with a period that divides the
+// interval are not sampled at the same spot every time
+struct PCSampler {
+ Scheduler& Sched;
+ CPU_65XX& Cpu;
+ uint64_t Interval;
+ uint32_t SampleEvent;
+ uint32_t Random = 0x6502;
+
+ uint32_t Histogram[0x10000] = {};
+ uint64_t Samples            = 0;
+
+ PCSampler(Scheduler& sched, CPU_65XX& cpu, uint64_t interval);
+
+ void Start();
+ void Sample();
+
+ // Time per routine, then the hottest addresses with the instruction there
+ void Report(FILE* File, const SymbolTable& Symbols, Disassembler& Disasm, const Memory& Mem, size_t TopAddresses = 20) const;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "scheduler.h"
+
+#include <algorithm>
+
+#include "common.h"
+
+uint32_t Scheduler::Register(EventCallback Callback) {
+ Events.push_back({Callback, NO_DEADLINE, 0, false});
+ return Events.size() - 1;
+}
+
+void Scheduler::Schedule(uint32_t Id, uint64_t Deadline) {
+ Event& Ev   = Events[Id];
+ Ev.Deadline = Deadline;
+ Ev.Armed    = true;
+ Ev.Generation++;
+
+ Heap.push_back({Deadline, Id, Ev.Generation});
+ std::push_heap(Heap.begin(), Heap.end(), std::greater<Entry>());
+
+ if (!Cpu) return;
+ // Cut the running slice so the event fires at the next instruction boundary past its deadline
+ uint64_t Current = Cpu->TotalCycles;
+ if (Deadline <= Current)
+  Cpu->Cycles = 0;
+ else if (Deadline - Current < (uint64_t)std::max(Cpu->Cycles, 0))
+  Cpu->Cycles = Deadline - Current;
+}
+
+void Scheduler::Cancel(uint32_t Id) {
+ Events[Id].Armed = false;
+ Events[Id].Generation++;
+}
+
+uint64_t Scheduler::NextDeadline() {
+ while (!Heap.empty()) {
+  const Entry& Top = Heap.front();
+  if (Events[Top.Id].Armed && Events[Top.Id].Generation == Top.Generation) return Top.Deadline;
+
+  std::pop_heap(Heap.begin(), Heap.end(), std::greater<Entry>());
+  Heap.pop_back();
+ }
+ return NO_DEADLINE;
+}
+
+void Scheduler::RunDue(uint64_t Now) {
+ while (NextDeadline() <= Now) {
+  uint32_t Id = Heap.front().Id;
+  std::pop_heap(Heap.begin(), Heap.end(), std::greater<Entry>());
+  Heap.pop_back();
+
+  Events[Id].Armed = false;
+  Events[Id].Callback(Now);
+ }
+}
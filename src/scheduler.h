@@ -0,0 +1,56 @@
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include <functional>
+#include <vector>
+
+#include <cstdint>
+
+#include "common.h"
+#include "cpu_65xx.h"
+
+constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+typedef std::function<void(uint64_t Now)> EventCallback;
+
+// Device events keyed by absolute CPU cycle (CPU_65XX::TotalCycles).
+//
+// The run loop executes freely up to NextDeadline() and then calls RunDue(),
+// so devices cost nothing between their events. Each registered event has at
+// most one pending deadline; rescheduling or cancelling bumps its generation
+// and leaves the stale heap entry to be skipped when it surfaces.
+struct Scheduler {
+ struct Entry {
+  uint64_t Deadline;
+  uint32_t Id;
+  uint32_t Generation;
+
+  bool operator>(const Entry& Other) const { return Deadline > Other.Deadline || (Deadline == Other.Deadline && Id > Other.Id); }
+ };
+
+ struct Event {
+  EventCallback Callback;
+  uint64_t Deadline;
+  uint32_t Generation;
+  bool Armed;
+ };
+
+ std::vector<Event> Events;
+ std::vector<Entry> Heap;  // Min-heap on Deadline
+ CPU_65XX* Cpu = nullptr;
+
+ uint32_t Register(EventCallback Callback);
+
+ // Sets the deadline of an event, replacing any pending one. A deadline that
+ // falls inside the running Execute slice shortens the slice
+ void Schedule(uint32_t Id, uint64_t Deadline);
+ void ScheduleIn(uint32_t Id, uint64_t Delay) { Schedule(Id, Now() + Delay); }
+ void Cancel(uint32_t Id);
+ bool Armed(uint32_t Id) const { return Events[Id].Armed; }
+
+ uint64_t Now() const { return Cpu ? Cpu->TotalCycles : 0; }
+ uint64_t NextDeadline();
+ void RunDue(uint64_t Now);
+};
+
+#endif
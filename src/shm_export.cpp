@@ -0,0 +1,82 @@
+#include "shm_export.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common.h"
+
+bool SharedExport::Open(const std::string& SegmentName, Memory& mem) {
+ int Fd = shm_open(SegmentName.c_str(), O_CREAT | O_RDWR, 0644);
+ if (Fd < 0) {
+  perror("shm_open");
+  return false;
+ }
+ if (ftruncate(Fd, sizeof(SharedState)) < 0) {
+  perror("ftruncate");
+  close(Fd);
+  shm_unlink(SegmentName.c_str());
+  return false;
+ }
+
+ void* Mapping = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+ close(Fd);
+ if (Mapping == MAP_FAILED) {
+  perror("mmap");
+  shm_unlink(SegmentName.c_str());
+  return false;
+ }
+
+ Name  = SegmentName;
+ State = (SharedState*)Mapping;
+ State->Magic   = SHARED_STATE_MAGIC;
+ State->Version = SHARED_STATE_VERSION;
+ State->Sequence.store(0, std::memory_order_relaxed);
+
+ memcpy(State->Data, mem.Data, MAX_MEM);
+ mem.Data = State->Data;
+ return true;
+}
+
+void SharedExport::Close(Memory& mem) {
+ if (!State) return;
+ if (Sched) {
+  Publish(*Cpu);
+  Sched->Cancel(PublishEvent);
+ }
+
+ memcpy(mem.Storage, State->Data, MAX_MEM);
+ mem.Data = mem.Storage;
+
+ munmap(State, sizeof(SharedState));
+ shm_unlink(Name.c_str());
+ State = nullptr;
+}
+
+void SharedExport::Publish(CPU_65XX& cpu) {
+ uint32_t Sequence = State->Sequence.load(std::memory_order_relaxed);
+ State->Sequence.store(Sequence + 1, std::memory_order_relaxed);
+ std::atomic_thread_fence(std::memory_order_release);
+
+ State->TotalCycles = cpu.TotalCycles;
+ State->PC          = cpu.PC;
+ State->SP          = cpu.SP;
+ State->A           = cpu.A;
+ State->X           = cpu.X;
+ State->Y           = cpu.Y;
+ State->PS          = cpu.PS.GetPS();
+
+ State->Sequence.store(Sequence + 2, std::memory_order_release);
+}
+
+void SharedExport::StartPublishing(Scheduler& sched, CPU_65XX& cpu) {
+ Sched        = &sched;
+ Cpu          = &cpu;
+ PublishEvent = Sched->Register([this](uint64_t) {
+  Publish(*Cpu);
+  Sched->ScheduleIn(PublishEvent, SHARED_PUBLISH_CYCLES);
+ });
+ Sched->ScheduleIn(PublishEvent, SHARED_PUBLISH_CYCLES);
+}
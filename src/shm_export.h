@@ -0,0 +1,65 @@
+#ifndef _SHM_EXPORT_H_
+#define _SHM_EXPORT_H_
+
+#include <atomic>
+#include <string>
+
+#include <cstdint>
+
+#include "common.h"
+#include "cpu_65xx.h"
+#include "memory.h"
+#include "scheduler.h"
+
+constexpr uint32_t SHARED_STATE_MAGIC   = 0x32353645;  // "E652"
+constexpr uint32_t SHARED_STATE_VERSION = 1;
+// Cycles between register publishes
+constexpr uint64_t SHARED_PUBLISH_CYCLES = 1000;
+
+// Layout of the POSIX shared memory segment.
+//
+// Data is the live emulated RAM: Memory::Data points straight into it, so
+// readers see every write without copies and without pausing the emulator.
+// The register block is guarded by a seqlock. Sequence is odd while the
+// emulator updates it; a reader copies the registers and retries if Sequence
+// was odd or changed meanwhile. Every publish advances Sequence by two, so it
+// also serves as a generation counter for RAM viewers. Registers are
+// republished every SHARED_PUBLISH_CYCLES and at the end of the run.
+struct SharedState {
+ uint32_t Magic;
+ uint32_t Version;
+ std::atomic<uint32_t> Sequence;
+ uint32_t Reserved;
+
+ uint64_t TotalCycles;
+ Word PC;
+ Byte SP;
+ Byte A;
+ Byte X;
+ Byte Y;
+ Byte PS;
+ Byte Pad;
+
+ Byte Data[MAX_MEM];
+};
+
+struct SharedExport {
+ SharedState* State = nullptr;
+ std::string Name;
+
+ Scheduler* Sched = nullptr;
+ CPU_65XX* Cpu    = nullptr;
+ uint32_t PublishEvent;
+
+ // Creates the segment (e.g. "/emu6502"), moves the current RAM into it and
+ // repoints mem.Data at it
+ bool Open(const std::string& SegmentName, Memory& mem);
+ // Copies RAM back into mem.Storage and unlinks the segment
+ void Close(Memory& mem);
+
+ void Publish(CPU_65XX& cpu);
+ // Publishes the registers every SHARED_PUBLISH_CYCLES from a scheduler event
+ void StartPublishing(Scheduler& sched, CPU_65XX& cpu);
+};
+
+#endif
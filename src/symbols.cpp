@@ -0,0 +1,100 @@
+#include "symbols.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "common.h"
+
+bool SymbolTable::Load(const std::string& Path) {
+ FILE* File = fopen(Path.c_str(), "r");
+ if (!File) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ char Line[16] = {};
+ if (!fgets(Line, sizeof(Line), File)) Line[0] = 0;
+ rewind(File);
+
+ bool Ok = strncmp(Line, "version\t", 8) == 0 ? LoadDebugFile(File) : LoadMap(File);
+ fclose(File);
+ if (!Ok) printf("%s: no symbols found\n", Path.c_str());
+ Sort();
+ return Ok;
+}
+
+// "Exports list by name:" holds up to two "name value type" triples per line.
+// Type is [R]{L|E}{A|Z}, equates (E) are constants and left out
+bool SymbolTable::LoadMap(FILE* File) {
+ char Line[512];
+ bool InExports = false;
+ size_t Before  = Symbols.size();
+
+ while (fgets(Line, sizeof(Line), File)) {
+  if (!InExports) {
+   InExports = strncmp(Line, "Exports list by name:", 21) == 0;
+   continue;
+  }
+  if (Line[0] == '-') continue;
+  if (Line[0] == '\n' || Line[0] == '\r') break;
+
+  char Name[2][256];
+  unsigned Value[2];
+  char Type[2][16];
+  int Fields = sscanf(Line, "%255s %x %15s %255s %x %15s", Name[0], &Value[0], Type[0], Name[1], &Value[1], Type[1]);
+  for (int i = 0; i + 3 <= Fields; i += 3) {
+   if (!strchr(Type[i / 3], 'E')) Add(Value[i / 3], Name[i / 3]);
+  }
+ }
+ return Symbols.size() > Before;
+}
+
+// sym lines: sym<TAB>id=..,name="main",...,val=0x800,...,type=lab
+// Only labels count, equates are constants rather than code. Cheap local
+// labels (@loop) are left out so their time goes to the enclosing routine
+bool SymbolTable::LoadDebugFile(FILE* File) {
+ char Line[1024];
+ size_t Before = Symbols.size();
+
+ while (fgets(Line, sizeof(Line), File)) {
+  if (strncmp(Line, "sym\t", 4) != 0 || !strstr(Line, "type=lab")) continue;
+
+  const char* NameField  = strstr(Line, "name=\"");
+  const char* ValueField = strstr(Line, "val=");
+  if (!NameField || !ValueField) continue;
+
+  NameField += 6;
+  const char* NameEnd = strchr(NameField, '"');
+  if (!NameEnd || *NameField == '@') continue;
+
+  Add(strtoul(ValueField + 4, nullptr, 0), std::string(NameField, NameEnd));
+ }
+ return Symbols.size() > Before;
+}
+
+void SymbolTable::Add(Word Address, const std::string& Name) { Symbols.push_back({Address, Name}); }
+
+// Where several labels share an address the first one loaded wins
+void SymbolTable::Sort() {
+ std::stable_sort(Symbols.begin(), Symbols.end(), [](const Symbol& a, const Symbol& b) { return a.Address < b.Address; });
+ Symbols.erase(std::unique(Symbols.begin(), Symbols.end(), [](const Symbol& a, const Symbol& b) { return a.Address == b.Address; }), Symbols.end());
+}
+
+const Symbol* SymbolTable::Lookup(Word Address) const {
+ auto It = std::upper_bound(Symbols.begin(), Symbols.end(), Address, [](Word Value, const Symbol& Entry) { return Value < Entry.Address; });
+ if (It == Symbols.begin()) return nullptr;
+ return &*--It;
+}
+
+std::string SymbolTable::Name(Word Address) const {
+ char Buffer[300];
+ const Symbol* Entry = Lookup(Address);
+ if (!Entry)
+  snprintf(Buffer, sizeof(Buffer), "$%04x", Address);
+ else if (Entry->Address == Address)
+  return Entry->Name;
+ else
+  snprintf(Buffer, sizeof(Buffer), "%s+%u", Entry->Name.c_str(), Address - Entry->Address);
+ return Buffer;
+}
@@ -0,0 +1,33 @@
+#ifndef _SYMBOLS_H_
+#define _SYMBOLS_H_
+
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+#include "common.h"
+
+struct Symbol {
+ Word Address;
+ std::string Name;
+};
+
+// Labels from the cc65 toolchain, either an ld65 map file (-m, exports only)
+// or a debug file (--dbgfile, every label). Addresses are attributed to the
+// closest label at or below them
+struct SymbolTable {
+ std::vector<Symbol> Symbols;  // Sorted by address
+
+ bool Load(const std::string& Path);  // Detects the format from the first line
+ bool LoadMap(FILE* File);
+ bool LoadDebugFile(FILE* File);
+
+ const Symbol* Lookup(Word Address) const;
+ std::string Name(Word Address) const;  // "label+off", or "$addr" without a label
+
+ void Add(Word Address, const std::string& Name);
+ void Sort();
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "common.h"
+
+int ParseTracePolicy(const std::string& Name) {
+ if (Name == "block") return TRACE_POLICY_BLOCK;
+ if (Name == "drop") return TRACE_POLICY_DROP;
+ if (Name == "sample") return TRACE_POLICY_SAMPLE;
+ return -1;
+}
+
+size_t EncodeTraceBlock(const TraceRecord* Records, size_t Count, Byte* Output) {
+ Byte Previous[TRACE_RECORD_BYTES] = {};
+ Byte* Out                         = Output;
+
+ for (size_t i = 0; i < Count; i++) {
+  const Byte* Current = (const Byte*)&Records[i];
+  Byte* Mask          = Out;
+  uint32_t Bits       = 0;
+  Out += 3;
+
+  for (size_t j = 0; j < TRACE_RECORD_BYTES; j++) {
+   Byte Delta = Current[j] ^ Previous[j];
+   if (Delta) {
+    Bits |= 1u << j;
+    *Out++ = Delta;
+   }
+   Previous[j] = Current[j];
+  }
+  Mask[0] = Bits & 0xFF;
+  Mask[1] = (Bits >> 8) & 0xFF;
+  Mask[2] = Bits >> 16;
+ }
+ return Out - Output;
+}
+
+bool DecodeTraceBlock(const Byte* Input, size_t Bytes, TraceRecord* Records, size_t Count) {
+ Byte Previous[TRACE_RECORD_BYTES] = {};
+ const Byte* End                   = Input + Bytes;
+
+ for (size_t i = 0; i < Count; i++) {
+  if (End - Input < 3) return false;
+  uint32_t Bits = Input[0] | (Input[1] << 8) | (Input[2] << 16);
+  Input += 3;
+
+  for (size_t j = 0; j < TRACE_RECORD_BYTES; j++) {
+   if (!(Bits & (1u << j))) continue;
+   if (Input == End) return false;
+   Previous[j] ^= *Input++;
+  }
+  memcpy(&Records[i], Previous, TRACE_RECORD_BYTES);
+  memset(Records[i].Pad, 0, sizeof(Records[i].Pad));
+ }
+ return Input == End;
+}
+
+TraceBuffer::~TraceBuffer() {
+ Close();
+ delete[] Ring;
+}
+
+bool TraceBuffer::Open(const std::string& Path, int policy) {
+ Output = fopen(Path.c_str(), "wb");
+ if (!Output) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ TraceFileHeader Header;
+ memcpy(Header.Magic, TRACE_MAGIC, sizeof(Header.Magic));
+ Header.Version    = TRACE_VERSION;
+ Header.RecordSize = sizeof(TraceRecord);
+ fwrite(&Header, sizeof(Header), 1, Output);
+
+ if (!Ring) Ring = new TraceRecord[TRACE_RING_RECORDS];
+ Policy = policy;
+ Stopping.store(false);
+ Writer = std::thread(&TraceBuffer::WriterLoop, this);
+ return true;
+}
+
+void TraceBuffer::Close() {
+ if (!Output) return;
+ Flush();
+ Stopping.store(true, std::memory_order_release);
+ Writer.join();
+ fclose(Output);
+ Output = nullptr;
+}
+
+void TraceBuffer::Flush() { Published.store(Head, std::memory_order_release); }
+
+TraceRecord& TraceBuffer::Reserve() {
+ Flush();
+ Tail = Consumed.load(std::memory_order_acquire);
+
+ if (Head - Tail == TRACE_RING_RECORDS) {
+  // Limit stays at Head, so every record goes through here until there is room
+  if (Policy != TRACE_POLICY_BLOCK) {
+   Dropped++;
+   return Scratch;
+  }
+  Stalls++;
+  while (Head - (Tail = Consumed.load(std::memory_order_acquire)) == TRACE_RING_RECORDS)
+   std::this_thread::yield();
+ }
+
+ if (Policy == TRACE_POLICY_SAMPLE && Head - Tail > TRACE_RING_RECORDS / 4 * 3) {
+  if (Skipped++ % TRACE_SAMPLE_RATE) {
+   Dropped++;
+   return Scratch;
+  }
+  Limit = Head + 1;
+ } else {
+  Limit = std::min(Tail + TRACE_RING_RECORDS, (Head / TRACE_PUBLISH_RECORDS + 1) * TRACE_PUBLISH_RECORDS);
+ }
+
+ Total++;
+ return Ring[Head++ % TRACE_RING_RECORDS];
+}
+
+// Waits for whole blocks so they compress well, writes what is left on Close()
+void TraceBuffer::WriterLoop() {
+ std::vector<Byte> Encoded(TraceBlockBound(TRACE_BLOCK_RECORDS));
+ uint64_t Read = 0;
+
+ for (;;) {
+  bool Last      = Stopping.load(std::memory_order_acquire);
+  uint64_t Ready = Published.load(std::memory_order_acquire);
+
+  if (Ready == Read && Last) break;
+  if (Ready - Read < TRACE_BLOCK_RECORDS && !Last) {
+   std::this_thread::sleep_for(std::chrono::microseconds(200));
+   continue;
+  }
+
+  // Blocks never straddle the end of the ring
+  size_t Offset = Read % TRACE_RING_RECORDS;
+  size_t Count  = std::min<uint64_t>({Ready - Read, TRACE_BLOCK_RECORDS, TRACE_RING_RECORDS - Offset});
+
+  TraceBlockHeader Header;
+  Header.Records = Count;
+  Header.Bytes   = EncodeTraceBlock(&Ring[Offset], Count, Encoded.data());
+
+  // The records are encoded, the CPU can have the slots back before the write
+  Read += Count;
+  Consumed.store(Read, std::memory_order_release);
+
+  fwrite(&Header, sizeof(Header), 1, Output);
+  fwrite(Encoded.data(), 1, Header.Bytes, Output);
+  BytesWritten += sizeof(Header) + Header.Bytes;
+ }
+}
+
+TraceReader::~TraceReader() {
+ if (File) fclose(File);
+}
+
+bool TraceReader::Open(const std::string& Path) {
+ File = fopen(Path.c_str(), "rb");
+ if (!File) {
+  perror(Path.c_str());
+  return false;
+ }
+
+ TraceFileHeader Header;
+ if (fread(&Header, sizeof(Header), 1, File) != 1 || memcmp(Header.Magic, TRACE_MAGIC, sizeof(Header.Magic)) || Header.RecordSize != sizeof(TraceRecord) || Header.Version < 1 || Header.Version > TRACE_VERSION) {
+  printf("%s: not a trace file\n", Path.c_str());
+  return false;
+ }
+ Version = Header.Version;
+ return true;
+}
+
+size_t TraceReader::Read(std::vector<TraceRecord>& Block) {
+ // Version 1 is raw records
+ if (Version == 1) {
+  Block.resize(TRACE_BLOCK_RECORDS);
+  Block.resize(fread(Block.data(), sizeof(TraceRecord), Block.size(), File));
+  return Block.size();
+ }
+
+ TraceBlockHeader Header;
+ if (fread(&Header, sizeof(Header), 1, File) != 1 || Header.Bytes > TraceBlockBound(Header.Records)) return 0;
+
+ Encoded.resize(Header.Bytes);
+ Block.resize(Header.Records);
+ if (fread(Encoded.data(), 1, Header.Bytes, File) != Header.Bytes || !DecodeTraceBlock(Encoded.data(), Header.Bytes, Block.data(), Header.Records)) {
+  printf("Truncated or corrupt trace block\n");
+  return 0;
+ }
+ return Header.Records;
+}
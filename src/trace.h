@@ -0,0 +1,134 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "common.h"
+
+constexpr char TRACE_MAGIC[8]          = {'6', '5', '0', '2', 'T', 'R', 'C', '\0'};
+constexpr uint32_t TRACE_VERSION       = 2;
+constexpr size_t TRACE_RING_RECORDS    = 1 << 18;  // 6 MiB between the CPU and the writer
+constexpr size_t TRACE_BLOCK_RECORDS   = 1 << 16;  // Records per compressed block
+constexpr size_t TRACE_PUBLISH_RECORDS = 1 << 12;  // The CPU hands records over in batches of this many
+constexpr uint32_t TRACE_SAMPLE_RATE   = 16;       // Keep one record in this many while sampling
+
+enum {
+ TRACE_INSTRUCTION = 0x00,
+ TRACE_IRQ         = 0x01,  // Interrupt entry, PC is the interrupted PC
+ TRACE_NMI         = 0x02,
+};
+
+// What the CPU does when the writer falls behind and the ring is full
+enum {
+ TRACE_POLICY_BLOCK  = 0,  // Wait for the writer, nothing is lost
+ TRACE_POLICY_DROP   = 1,  // Throw records away and count them
+ TRACE_POLICY_SAMPLE = 2,  // Above 3/4 full keep every TRACE_SAMPLE_RATE'th record, drop when full
+};
+
+// One executed instruction, registers as they were before it ran.
+// EffectiveAddress is only meaningful for memory addressing modes
+struct TraceRecord {
+ uint64_t Cycle;
+ Word PC;
+ Word EffectiveAddress;
+ Byte Opcode;
+ Byte Operand[2];
+ Byte A;
+ Byte X;
+ Byte Y;
+ Byte SP;
+ Byte P;
+ Byte Kind;  // TRACE_*
+ Byte Pad[3];
+};
+static_assert(sizeof(TraceRecord) == 24, "trace records are written raw");
+
+// Bytes of a record that carry data, the padding is never written
+constexpr size_t TRACE_RECORD_BYTES = offsetof(TraceRecord, Pad);
+
+struct TraceFileHeader {
+ char Magic[8];
+ uint32_t Version;
+ uint32_t RecordSize;
+};
+
+// Version 2 files are a sequence of blocks, each header followed by Bytes of
+// encoded records. Every block starts from a zero record so it decodes alone
+struct TraceBlockHeader {
+ uint32_t Records;
+ uint32_t Bytes;
+};
+
+int ParseTracePolicy(const std::string& Name);
+
+// Each record is a 3 byte mask of the bytes that differ from the previous
+// record followed by those bytes XORed with it
+constexpr size_t TraceBlockBound(size_t Count) { return Count * (TRACE_RECORD_BYTES + 3); }
+size_t EncodeTraceBlock(const TraceRecord* Records, size_t Count, Byte* Output);
+bool DecodeTraceBlock(const Byte* Input, size_t Bytes, TraceRecord* Records, size_t Count);
+
+// Single producer, single consumer ring between the CPU and a writer thread.
+// The CPU only touches its own Head and a cached copy of the writer's position;
+// the atomics are synchronised once per TRACE_PUBLISH_RECORDS records, so the
+// common case in Next() is a compare and an increment. The writer compresses
+// published records and does all file I/O
+struct TraceBuffer {
+ TraceRecord* Ring = nullptr;  // Allocated by Open(), tracing off costs no memory
+ int Policy = TRACE_POLICY_BLOCK;
+
+ // Producer side, CPU thread only
+ uint64_t Head    = 0;
+ uint64_t Limit   = 0;  // Next() takes the slow path when Head reaches it
+ uint64_t Tail    = 0;  // Last seen value of Consumed
+ uint64_t Skipped = 0;  // Sampling counter
+ TraceRecord Scratch;   // Target for records that are not kept
+
+ uint64_t Total   = 0;  // Records written to the ring
+ uint64_t Dropped = 0;
+ uint64_t Stalls  = 0;  // Times the CPU had to wait for the writer
+
+ std::atomic<uint64_t> Published{0};  // Records before this are complete
+ std::atomic<uint64_t> Consumed{0};   // Records before this are on their way to disk
+ std::atomic<bool> Stopping{false};
+
+ FILE* Output = nullptr;
+ std::thread Writer;
+ uint64_t BytesWritten = 0;
+
+ ~TraceBuffer();
+
+ bool Open(const std::string& Path, int policy = TRACE_POLICY_BLOCK);
+ void Close();
+
+ // The record of the previous call is complete by the time this is called
+ TraceRecord& Next() {
+  if (Head == Limit) return Reserve();
+  Total++;
+  return Ring[Head++ % TRACE_RING_RECORDS];
+ }
+
+ TraceRecord& Reserve();
+ void Flush();
+ void WriterLoop();
+};
+
+// Reads back either trace file version, a block of records at a time
+struct TraceReader {
+ FILE* File       = nullptr;
+ uint32_t Version = 0;
+ std::vector<Byte> Encoded;
+
+ ~TraceReader();
+
+ bool Open(const std::string& Path);
+ size_t Read(std::vector<TraceRecord>& Block);
+};
+
+#endif
@@ -0,0 +1,278 @@
+#include "via_6522.h"
+
+#include "common.h"
+
+VIA_6522::VIA_6522(Word Base, Scheduler& sched, InterruptLines& lines) : MemoryDevice(Base, Base + VIA_SIZE - 1), Sched(sched), Lines(lines) {
+ IRQSource = Lines.AllocateIRQ();
+ T1Event   = Sched.Register([this](uint64_t) { OnT1(); });
+ T2Event   = Sched.Register([this](uint64_t) { OnT2(); });
+ SREvent   = Sched.Register([this](uint64_t Now) { OnShift(Now); });
+}
+
+Byte VIA_6522::Read(Word Address) {
+ uint64_t Now = Sched.Now();
+
+ switch ((Address - Begin) & 0xF) {
+ case VIA_ORB: {
+  ClearFlags(VIA_INT_CB1 | VIA_INT_CB2);
+  Byte Pins = (ACR & VIA_ACR_PB_LATCH) ? LatchB : PortInB;
+  return (PortOutB() & DDRB) | (Pins & ~DDRB);
+ }
+ case VIA_ORA:
+  ClearFlags(VIA_INT_CA1 | VIA_INT_CA2);
+  return (ACR & VIA_ACR_PA_LATCH) ? LatchA : PortOutA();
+ case VIA_ORA_NH:
+  return (ACR & VIA_ACR_PA_LATCH) ? LatchA : PortOutA();
+ case VIA_DDRB:
+  return DDRB;
+ case VIA_DDRA:
+  return DDRA;
+ case VIA_T1CL:
+  ClearFlags(VIA_INT_T1);
+  return ReadT1(Now) & 0xFF;
+ case VIA_T1CH:
+  return ReadT1(Now) >> 8;
+ case VIA_T1LL:
+  return T1Latch & 0xFF;
+ case VIA_T1LH:
+  return T1Latch >> 8;
+ case VIA_T2CL:
+  ClearFlags(VIA_INT_T2);
+  return ReadT2(Now) & 0xFF;
+ case VIA_T2CH:
+  return ReadT2(Now) >> 8;
+ case VIA_SR: {
+  Byte Value = SR;
+  StartShift(Now);
+  return Value;
+ }
+ case VIA_ACR:
+  return ACR;
+ case VIA_PCR:
+  return PCR;
+ case VIA_IFR:
+  return IFR | ((IFR & IER & 0x7F) ? VIA_INT_ANY : 0);
+ case VIA_IER:
+  return IER | 0x80;
+ }
+ return 0;
+}
+
+void VIA_6522::Write(Word Address, Byte Value) {
+ uint64_t Now = Sched.Now();
+
+ switch ((Address - Begin) & 0xF) {
+ case VIA_ORB:
+  ORB = Value;
+  ClearFlags(VIA_INT_CB1 | VIA_INT_CB2);
+  break;
+ case VIA_ORA:
+  ORA = Value;
+  ClearFlags(VIA_INT_CA1 | VIA_INT_CA2);
+  break;
+ case VIA_ORA_NH:
+  ORA = Value;
+  break;
+ case VIA_DDRB:
+  DDRB = Value;
+  break;
+ case VIA_DDRA:
+  DDRA = Value;
+  break;
+ case VIA_T1CL:
+ case VIA_T1LL:
+  T1Latch = (T1Latch & 0xFF00) | Value;
+  break;
+ case VIA_T1CH:
+  T1Latch = (T1Latch & 0x00FF) | (Value << 8);
+  ClearFlags(VIA_INT_T1);
+  StartT1(Now);
+  break;
+ case VIA_T1LH:
+  T1Latch = (T1Latch & 0x00FF) | (Value << 8);
+  ClearFlags(VIA_INT_T1);
+  break;
+ case VIA_T2CL:
+  T2LatchLow = Value;
+  break;
+ case VIA_T2CH:
+  T2Counter = (Value << 8) | T2LatchLow;
+  T2Load    = Now;
+  T2Armed   = true;
+  ClearFlags(VIA_INT_T2);
+  if (ACR & VIA_ACR_T2_PULSES)
+   Sched.Cancel(T2Event);
+  else
+   Sched.Schedule(T2Event, Now + T2Counter + 1);
+  break;
+ case VIA_SR:
+  SR = Value;
+  StartShift(Now);
+  break;
+ case VIA_ACR:
+  ACR = Value;
+  if (!(ACR & VIA_ACR_SR_MASK)) {
+   SRActive = false;
+   Sched.Cancel(SREvent);
+  }
+  break;
+ case VIA_PCR:
+  PCR = Value;
+  break;
+ case VIA_IFR:
+  ClearFlags(Value & 0x7F);
+  break;
+ case VIA_IER:
+  if (Value & 0x80)
+   IER |= Value & 0x7F;
+  else
+   IER &= ~Value;
+  UpdateIRQ();
+  break;
+ }
+}
+
+Byte VIA_6522::PortOutB() const {
+ Byte Value = ORB;
+ if (ACR & VIA_ACR_T1_PB7) Value = (Value & 0x7F) | (PB7 ? 0x80 : 0);
+ return (Value & DDRB) | (PortInB & ~DDRB);
+}
+
+// Counter of T1 at cycle Now. It counts down from the loaded value, passes
+// 0xFFFF one cycle after zero, then either keeps counting (one-shot) or
+// reloads from the latch, giving a period of latch + 2 cycles
+Word VIA_6522::ReadT1(uint64_t Now) const {
+ uint64_t Elapsed = Now - T1Load;
+ if (Elapsed <= T1Counter) return T1Counter - Elapsed;
+ if (!(ACR & VIA_ACR_T1_FREERUN)) return (Word)(T1Counter - Elapsed);
+
+ uint64_t Phase = (Elapsed - T1Counter - 1) % ((uint64_t)T1Latch + 2);
+ return Phase == 0 ? 0xFFFF : (Word)(T1Latch - (Phase - 1));
+}
+
+Word VIA_6522::ReadT2(uint64_t Now) const {
+ if (ACR & VIA_ACR_T2_PULSES) return T2Counter;
+ return (Word)(T2Counter - (Now - T2Load));
+}
+
+void VIA_6522::StartT1(uint64_t Now) {
+ T1Load    = Now;
+ T1Counter = T1Latch;
+ T1Expiry  = Now + T1Latch + 1;
+ T1Armed   = true;
+ if (ACR & VIA_ACR_T1_PB7) PB7 = false;
+ Sched.Schedule(T1Event, T1Expiry);
+}
+
+void VIA_6522::OnT1() {
+ if (ACR & VIA_ACR_T1_FREERUN) {
+  SetFlags(VIA_INT_T1);
+  PB7 = !PB7;
+
+  // Reload happens the cycle after the 0xFFFF state, from the latch as it is now
+  T1Load    = T1Expiry + 1;
+  T1Counter = T1Latch;
+  T1Expiry  = T1Load + T1Latch + 1;
+  Sched.Schedule(T1Event, T1Expiry);
+ } else if (T1Armed) {
+  SetFlags(VIA_INT_T1);
+  PB7     = true;
+  T1Armed = false;
+ }
+}
+
+void VIA_6522::OnT2() {
+ if (!T2Armed) return;
+ SetFlags(VIA_INT_T2);
+ T2Armed = false;
+}
+
+void VIA_6522::PulsePB6() {
+ if (!(ACR & VIA_ACR_T2_PULSES)) return;
+ T2Counter--;
+ if (T2Counter == 0 && T2Armed) {
+  SetFlags(VIA_INT_T2);
+  T2Armed = false;
+ }
+}
+
+// Cycles per shifted bit, 0 when CB1 is clocked externally
+uint64_t VIA_6522::ShiftBitCycles() const {
+ switch ((ACR & VIA_ACR_SR_MASK) >> 2) {
+ case 1:
+ case 4:
+ case 5:
+  return 2 * ((uint64_t)T2LatchLow + 2);
+ case 2:
+ case 6:
+  return 2;
+ }
+ return 0;
+}
+
+void VIA_6522::StartShift(uint64_t Now) {
+ if (!(ACR & VIA_ACR_SR_MASK)) return;
+
+ ClearFlags(VIA_INT_SR);
+ SRActive = true;
+ SRBits   = 0;
+
+ uint64_t BitCycles = ShiftBitCycles();
+ if (BitCycles) Sched.Schedule(SREvent, Now + 8 * BitCycles);
+}
+
+void VIA_6522::OnShift(uint64_t Now) {
+ Byte Mode = (ACR & VIA_ACR_SR_MASK) >> 2;
+ if (!SRActive || !Mode) return;
+
+ if (Mode < 4) SR = CB2In;
+ ShiftOut = SR;
+
+ // Mode 4 recirculates forever without interrupting
+ if (Mode == 4) {
+  Sched.Schedule(SREvent, Now + 8 * ShiftBitCycles());
+  return;
+ }
+ SRActive = false;
+ SetFlags(VIA_INT_SR);
+}
+
+void VIA_6522::SetCA1(bool Level) {
+ bool Positive = PCR & 0x01;
+ if (Level != CA1 && Level == Positive) {
+  LatchA = PortOutA();
+  SetFlags(VIA_INT_CA1);
+ }
+ CA1 = Level;
+}
+
+void VIA_6522::SetCB1(bool Level) {
+ bool Positive = PCR & 0x10;
+ if (Level != CB1 && Level == Positive) {
+  LatchB = PortInB;
+  SetFlags(VIA_INT_CB1);
+ }
+
+ // External shift clock, bits move on the rising edge
+ Byte Mode = (ACR & VIA_ACR_SR_MASK) >> 2;
+ if (SRActive && (Mode == 3 || Mode == 7) && Level && !CB1 && ++SRBits == 8) {
+  SRActive = false;
+  if (Mode == 3) SR = CB2In;
+  ShiftOut = SR;
+  SetFlags(VIA_INT_SR);
+ }
+ CB1 = Level;
+}
+
+void VIA_6522::SetFlags(Byte Bits) {
+ IFR |= Bits;
+ UpdateIRQ();
+}
+
+void VIA_6522::ClearFlags(Byte Bits) {
+ if (!(IFR & Bits)) return;
+ IFR &= ~Bits;
+ UpdateIRQ();
+}
+
+void VIA_6522::UpdateIRQ() { Lines.SetIRQ(IRQSource, IFR & IER & 0x7F); }
@@ -0,0 +1,121 @@
+#ifndef _VIA_6522_H_
+#define _VIA_6522_H_
+
+#include <cstdint>
+
+#include "common.h"
+#include "device.h"
+#include "interrupt.h"
+#include "scheduler.h"
+
+// Register layout relative to the base address
+enum {
+ VIA_ORB    = 0x0,
+ VIA_ORA    = 0x1,
+ VIA_DDRB   = 0x2,
+ VIA_DDRA   = 0x3,
+ VIA_T1CL   = 0x4,
+ VIA_T1CH   = 0x5,
+ VIA_T1LL   = 0x6,
+ VIA_T1LH   = 0x7,
+ VIA_T2CL   = 0x8,
+ VIA_T2CH   = 0x9,
+ VIA_SR     = 0xA,
+ VIA_ACR    = 0xB,
+ VIA_PCR    = 0xC,
+ VIA_IFR    = 0xD,
+ VIA_IER    = 0xE,
+ VIA_ORA_NH = 0xF,
+ VIA_SIZE   = 0x10,
+};
+
+// IFR/IER bits
+enum {
+ VIA_INT_CA2 = 0x01,
+ VIA_INT_CA1 = 0x02,
+ VIA_INT_SR  = 0x04,
+ VIA_INT_CB2 = 0x08,
+ VIA_INT_CB1 = 0x10,
+ VIA_INT_T2  = 0x20,
+ VIA_INT_T1  = 0x40,
+ VIA_INT_ANY = 0x80,
+};
+
+// ACR bits
+enum {
+ VIA_ACR_PA_LATCH   = 0x01,
+ VIA_ACR_PB_LATCH   = 0x02,
+ VIA_ACR_SR_MASK    = 0x1C,
+ VIA_ACR_T2_PULSES  = 0x20,
+ VIA_ACR_T1_FREERUN = 0x40,
+ VIA_ACR_T1_PB7     = 0x80,
+};
+
+// 6522 VIA. Timers never count down per cycle: a load remembers the cycle it
+// happened on, reads derive the counter from the current cycle and expiry is
+// a scheduler event placed at the analytically computed deadline
+struct VIA_6522 : MemoryDevice {
+ Scheduler& Sched;
+ InterruptLines& Lines;
+ Byte IRQSource;
+
+ Byte ORA = 0, ORB = 0, DDRA = 0, DDRB = 0;
+ Byte ACR = 0, PCR = 0, IFR = 0, IER = 0;
+ Byte SR  = 0;
+
+ // Pin levels driven by the host on input bits
+ Byte PortInA = 0xFF, PortInB = 0xFF;
+ Byte LatchA = 0xFF, LatchB = 0xFF;
+ bool CA1 = true, CB1 = true;
+
+ // Timer 1
+ Word T1Latch    = 0xFFFF;
+ Word T1Counter  = 0xFFFF;  // Value loaded at T1Load
+ uint64_t T1Load = 0;
+ uint64_t T1Expiry;         // Cycle of the next (or last) zero crossing
+ bool T1Armed    = false;   // One-shot still due to interrupt
+ bool PB7        = true;
+ uint32_t T1Event;
+
+ // Timer 2
+ Byte T2LatchLow = 0xFF;
+ Word T2Counter  = 0xFFFF;
+ uint64_t T2Load = 0;
+ bool T2Armed    = false;
+ uint32_t T2Event;
+
+ // Shift register, a whole byte completes in one event like the timers
+ bool SRActive = false;
+ Byte SRBits   = 0;     // Bits seen so far when CB1 is clocked externally
+ Byte CB2In    = 0xFF;  // Byte the host presents on CB2 for shift-in modes
+ Byte ShiftOut = 0xFF;  // Last byte shifted out on CB2
+ uint32_t SREvent;
+
+ VIA_6522(Word Base, Scheduler& sched, InterruptLines& lines);
+
+ Byte Read(Word Address) override;
+ void Write(Word Address, Byte Value) override;
+
+ // Host side
+ void SetCA1(bool Level);
+ void SetCB1(bool Level);
+ void PulsePB6();
+ Byte PortOutA() const { return (ORA & DDRA) | (PortInA & ~DDRA); }
+ Byte PortOutB() const;
+
+ Word ReadT1(uint64_t Now) const;
+ Word ReadT2(uint64_t Now) const;
+ uint64_t ShiftBitCycles() const;
+
+ void StartT1(uint64_t Now);
+ void StartShift(uint64_t Now);
+ void OnT1();
+ void OnT2();
+ void OnShift(uint64_t Now);
+
+ void SetFlags(Byte Bits);
+ void ClearFlags(Byte Bits);
+ void UpdateIRQ();
+};
+
+#endif
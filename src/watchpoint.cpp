@@ -0,0 +1,75 @@
+#include "watchpoint.h"
+
+#include <string>
+
+#include <cctype>
+#include <cstdlib>
+
+#include "common.h"
+
+bool ParseHex(const std::string& Text, uint32_t Limit, uint32_t& Value) {
+ if (Text.empty() || Text.size() > 8 || !isxdigit((unsigned char)Text[0])) return false;
+ char* End;
+ unsigned long Number = strtoul(Text.c_str(), &End, 16);
+ if (*End || Number > Limit) return false;
+ Value = Number;
+ return true;
+}
+
+bool ParseWatchpoint(const std::string& Spec, Watchpoint& Watch) {
+ size_t Colon = Spec.find(':');
+ if (Colon == std::string::npos || Colon == 0) return false;
+
+ Watch.Kind = 0;
+ for (size_t i = 0; i < Colon; i++) {
+  switch (Spec[i]) {
+  case 'r':
+   Watch.Kind |= WATCH_READ;
+   break;
+  case 'w':
+   Watch.Kind |= WATCH_WRITE;
+   break;
+  case 'x':
+   Watch.Kind |= WATCH_EXEC;
+   break;
+  default:
+   return false;
+  }
+ }
+
+ std::string Range = Spec.substr(Colon + 1);
+ Watch.HasValue    = false;
+ Watch.Value       = 0;
+
+ uint32_t Number;
+ size_t Equals = Range.find('=');
+ if (Equals != std::string::npos) {
+  if (!ParseHex(Range.substr(Equals + 1), 0xFF, Number)) return false;
+  Watch.HasValue = true;
+  Watch.Value    = Number;
+  Range          = Range.substr(0, Equals);
+ }
+
+ size_t Dash = Range.find('-');
+ if (!ParseHex(Range.substr(0, Dash), 0xFFFF, Number)) return false;
+ Watch.Begin = Number;
+ Watch.End   = Number;
+ if (Dash != std::string::npos) {
+  if (!ParseHex(Range.substr(Dash + 1), 0xFFFF, Number)) return false;
+  Watch.End = Number;
+ }
+
+ return Watch.Begin <= Watch.End;
+}
+
+const char* WatchKindName(Byte Kind) {
+ switch (Kind) {
+ case WATCH_READ:
+  return "read";
+ case WATCH_WRITE:
+  return "write";
+ case WATCH_EXEC:
+  return "exec";
+ }
+ return "access";
+}
@@ -0,0 +1,41 @@
+#ifndef _WATCHPOINT_H_
+#define _WATCHPOINT_H_
+
+#include <string>
+
+#include <cstdint>
+
+#include "common.h"
+
+// Access kinds. The values double as per-page trap bits in Memory::PageTraps
+enum {
+ WATCH_READ  = 0x01,
+ WATCH_WRITE = 0x02,
+ WATCH_EXEC  = 0x04,
+};
+
+struct Watchpoint {
+ Word Begin;
+ Word End;       // Inclusive
+ Byte Kind;      // WATCH_* mask
+ bool HasValue;  // Only hit when the accessed value equals Value
+ Byte Value;
+};
+
+struct WatchHit {
+ Word Address;
+ Byte Kind;
+ Byte Value;
+};
+
+// Spec format: <r|w|x...>:<begin>[-<end>][=<value>], numbers in hex
+// e.g. "w:2000-20ff=15", "rw:00fe", "x:8000"
+bool ParseWatchpoint(const std::string& Spec, Watchpoint& Watch);
+
+// The whole of Text as a hex number no larger than Limit. False on anything
+// else, leaving Value as it was
+bool ParseHex(const std::string& Text, uint32_t Limit, uint32_t& Value);
+
+const char* WatchKindName(Byte Kind);
+
+#endif
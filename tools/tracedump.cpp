@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "cpu_6502.h"
+#include "disasm.h"
+#include "ins_65xx.h"
+#include "symbols.h"
+#include "trace.h"
+#include "watchpoint.h"
+
+struct OpcodeStats {
+ uint64_t Count;
+ uint64_t Cycles;
+};
+
+static void PrintRecord(const TraceRecord& Record, Disassembler& Disasm) {
+ if (Record.Kind != TRACE_INSTRUCTION) {
+  printf("%12llu %04x  %s\n", (unsigned long long)Record.Cycle, Record.PC, Record.Kind == TRACE_NMI ? "<NMI>" : "<IRQ>");
+  return;
+ }
+
+ Byte Bytes[3]                 = {Record.Opcode, Record.Operand[0], Record.Operand[1]};
+ const Disassembler::Entry& Ins = Disasm.Lookup(Record.PC, Bytes);
+
+ printf("%12llu %04x  %02x", (unsigned long long)Record.Cycle, Record.PC, Record.Opcode);
+ for (Byte i = 1; i < 3; i++) {
+  if (i < Ins.Ins.Length)
+   printf(" %02x", Record.Operand[i - 1]);
+  else
+   printf("   ");
+ }
+ printf("  %-24s A:%02x X:%02x Y:%02x SP:%02x P:%02x", Ins.Text, Record.A, Record.X, Record.Y, Record.SP, Record.P);
+ if (Ins.Ins.Length > 1 && Ins.Ins.Mode != MODE_IM) printf("  EA:%04x", Record.EffectiveAddress);
+ printf("\n");
+}
+
+static void PrintStats(const std::vector<OpcodeStats>& Stats, int Variant, uint64_t Records, uint64_t Interrupts, uint64_t FirstCycle, uint64_t LastCycle) {
+ std::vector<int> Order;
+ for (int Opcode = 0; Opcode < 256; Opcode++) {
+  if (Stats[Opcode].Count) Order.push_back(Opcode);
+ }
+ std::sort(Order.begin(), Order.end(), [&](int a, int b) { return Stats[a].Count > Stats[b].Count; });
+
+ printf("Records: %llu, interrupts: %llu, cycles %llu-%llu\n", (unsigned long long)Records, (unsigned long long)Interrupts, (unsigned long long)FirstCycle, (unsigned long long)LastCycle);
+ printf("%-6s %-4s %-5s %12s %8s %12s %8s\n", "Opcode", "Ins", "Mode", "Count", "%", "Cycles", "Avg");
+ for (int Opcode : Order) {
+  const InstructionInfo& Info = GetInstruction(Opcode, Variant);
+  const OpcodeStats& Entry    = Stats[Opcode];
+  printf("%02x     %-4s %-5s %12llu %7.2f%% %12llu %8.2f\n", Opcode, Info.Mnemonic, ModeName(Info.Mode), (unsigned long long)Entry.Count, 100.0 * Entry.Count / Records, (unsigned long long)Entry.Cycles, (double)Entry.Cycles / Entry.Count);
+ }
+}
+
+static int Usage() {
+ printf("Usage: tracedump <trace> [-r <begin>-<end>] [-s] [-y <symbols>] [-C <cpu>]\n");
+ return 1;
+}
+
+int main(int argc, char** argv) {
+ if (argc < 2) return Usage();
+
+ Word Begin = 0x0000, End = 0xFFFF;
+ bool Statistics = false;
+ int Variant     = CPU_NMOS;
+ SymbolTable Symbols;
+ for (int i = 2; i < argc; i++) {
+  std::string Argument = argv[i];
+  if (Argument == "-s") {
+   Statistics = true;
+  } else if (Argument == "-y" && i + 1 < argc) {
+   if (!Symbols.Load(argv[++i])) return 1;
+  } else if (Argument == "-C" && i + 1 < argc) {
+   if ((Variant = ParseCPUVariant(argv[++i])) < 0) {
+    printf("Unknown CPU: %s\n", argv[i]);
+    return 1;
+   }
+  } else if (Argument == "-r" && i + 1 < argc) {
+   // Hex addresses, checked in full like the watchpoint specs
+   std::string Range = argv[++i];
+   size_t Dash       = Range.find('-');
+   uint32_t First, Last;
+   bool Ok = ParseHex(Range.substr(0, Dash), 0xFFFF, First);
+   Last    = First;
+   if (Ok && Dash != std::string::npos) Ok = ParseHex(Range.substr(Dash + 1), 0xFFFF, Last);
+   if (!Ok || First > Last) {
+    printf("Bad range: %s\n", Range.c_str());
+    return Usage();
+   }
+   Begin = First;
+   End   = Last;
+  }
+ }
+
+ TraceReader Reader;
+ if (!Reader.Open(argv[1])) return 1;
+
+ std::vector<TraceRecord> Block;
+ Disassembler Disasm(&Symbols, Variant);
+ std::vector<OpcodeStats> Stats(256, {0, 0});
+ uint64_t Records = 0, Interrupts = 0, FirstCycle = 0, LastCycle = 0;
+ bool HavePrevious = false;
+ TraceRecord Previous = {};
+
+ size_t Count;
+ while ((Count = Reader.Read(Block)) > 0) {
+  for (size_t i = 0; i < Count; i++) {
+   const TraceRecord& Record = Block[i];
+
+   // An instruction's cost is the distance to the next record
+   if (HavePrevious && Previous.Kind == TRACE_INSTRUCTION && Previous.PC >= Begin && Previous.PC <= End)
+    Stats[Previous.Opcode].Cycles += Record.Cycle - Previous.Cycle;
+   Previous     = Record;
+   HavePrevious = true;
+
+   if (Record.PC < Begin || Record.PC > End) continue;
+   if (!Records) FirstCycle = Record.Cycle;
+   LastCycle = Record.Cycle;
+   Records++;
+
+   if (Record.Kind != TRACE_INSTRUCTION)
+    Interrupts++;
+   else
+    Stats[Record.Opcode].Count++;
+
+   if (!Statistics) PrintRecord(Record, Disasm);
+  }
+ }
+
+ if (Statistics) PrintStats(Stats, Variant, Records, Interrupts, FirstCycle, LastCycle);
+}